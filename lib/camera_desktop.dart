@@ -6,4 +6,9 @@
 /// CameraController works on desktop automatically.
 library;
 
+export 'src/adaptive_frame_rate.dart';
 export 'src/camera_desktop_plugin.dart';
+export 'src/camera_mosaic.dart';
+export 'src/camera_reconnect.dart';
+export 'src/camera_stats.dart';
+export 'src/thread_schedule.dart';
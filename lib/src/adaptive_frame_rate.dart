@@ -0,0 +1,41 @@
+/// When a camera may process fewer frames than it captures.
+///
+/// Passed to [CameraDesktopPlugin.setAdaptiveFrameRate]. While enabled, the
+/// camera drops to [idleFps] when the app reports it is hidden
+/// ([CameraDesktopPlugin.setAppVisibility]) or when the scene has not
+/// changed for [staticDelay]. The first frame with motion, or the first after
+/// the app is shown again, restores the full rate. The preview and image
+/// stream follow the reduced rate; recordings always get the full rate.
+class AdaptiveFrameRate {
+  /// Creates a setting. The default is enabled, idling at 5 fps after one
+  /// second of a static scene.
+  const AdaptiveFrameRate({
+    this.enabled = true,
+    this.idleFps = 5,
+    this.staticThreshold = 2,
+    this.staticDelay = const Duration(seconds: 1),
+  });
+
+  /// Always processes every frame.
+  static const AdaptiveFrameRate disabled = AdaptiveFrameRate(enabled: false);
+
+  /// Whether the rate adapts.
+  final bool enabled;
+
+  /// Frames per second processed while idle.
+  final int idleFps;
+
+  /// Mean per-channel difference between frames (0-255, on a sparse sample
+  /// grid) above which a frame counts as motion. Raise it for noisy sensors.
+  final int staticThreshold;
+
+  /// How long the scene must stay unchanged before the rate drops.
+  final Duration staticDelay;
+
+  Map<String, dynamic> toMap() => {
+    'enabled': enabled,
+    'idleFps': idleFps,
+    'staticThreshold': staticThreshold,
+    'staticDelayMs': staticDelay.inMilliseconds,
+  };
+}
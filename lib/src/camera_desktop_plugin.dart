@@ -7,7 +7,12 @@ import 'package:flutter/services.dart';
 import 'package:flutter/widgets.dart';
 import 'package:stream_transform/stream_transform.dart';
 
+import 'adaptive_frame_rate.dart';
+import 'camera_mosaic.dart';
+import 'camera_reconnect.dart';
+import 'camera_stats.dart';
 import 'image_stream_ffi.dart';
+import 'thread_schedule.dart';
 
 /// Desktop implementation of [CameraPlatform].
 ///
@@ -83,6 +88,13 @@ class CameraDesktopPlugin extends CameraPlatform {
   /// Mapping from cameraId to textureId (separate to decouple lifecycles).
   final Map<int, int> _textureIds = {};
 
+  /// Startup breakdown reported by the last initialize of each camera.
+  final Map<int, StartupTimings> _startupTimings = {};
+
+  /// Cameras with a recording in progress, oldest first, for
+  /// [setDescriptionWhileRecording].
+  final List<int> _recordingCameraIds = [];
+
   /// Broadcast stream for all camera events, filtered by cameraId downstream.
   final StreamController<CameraEvent> _eventStreamController =
       StreamController<CameraEvent>.broadcast();
@@ -96,6 +108,21 @@ class CameraDesktopPlugin extends CameraPlatform {
   final Map<int, StreamController<CameraImageData>> _imageStreamControllers =
       {};
 
+  /// Broadcast stream of `(mosaicId, tile, description)` errors pushed by
+  /// native mosaics, filtered by mosaicId in [onMosaicError].
+  final StreamController<(int, int, String)> _mosaicErrorController =
+      StreamController<(int, int, String)>.broadcast();
+
+  /// Broadcast stream of periodic stats pushed by native cameras, filtered
+  /// by cameraId in [onCameraStats].
+  final StreamController<CameraStats> _cameraStatsController =
+      StreamController<CameraStats>.broadcast();
+
+  /// Broadcast stream of reconnect progress pushed by native cameras,
+  /// filtered by cameraId in [onCameraReconnect].
+  final StreamController<CameraReconnectEvent> _reconnectController =
+      StreamController<CameraReconnectEvent>.broadcast();
+
   /// Handles method calls from the native side (events pushed to Dart).
   ///
   /// Dispatches `cameraError`, `cameraClosing`, and `imageStreamFrame`
@@ -110,6 +137,16 @@ class CameraDesktopPlugin extends CameraPlatform {
       case 'cameraClosing':
         final cameraId = args!['cameraId']! as int;
         _eventStreamController.add(CameraClosingEvent(cameraId));
+      case 'mosaicError':
+        _mosaicErrorController.add((
+          args!['mosaicId']! as int,
+          args['tile']! as int,
+          args['description']! as String,
+        ));
+      case 'cameraStats':
+        _cameraStatsController.add(CameraStats.fromMap(args!));
+      case 'cameraReconnect':
+        _reconnectController.add(CameraReconnectEvent.fromMap(args!));
       case 'imageStreamFrame':
         final cameraId = args!['cameraId']! as int;
         final controller = _imageStreamControllers[cameraId];
@@ -180,12 +217,65 @@ class CameraDesktopPlugin extends CameraPlatform {
   /// The `videoBitrate` and `audioBitrate` fields are accessed via dynamic
   /// dispatch with try/catch because older versions of
   /// `camera_platform_interface` may not expose them.
+  ///
+  /// On Linux, `fps` above 60 selects high-frame-rate capture: the device
+  /// is opened at the largest size within the resolution preset that it
+  /// reports for the rate. The call fails with `unsupported_fps` if no mode
+  /// reaches the rate. The preview then updates at 60 fps, while the image
+  /// stream and recordings get every frame.
+  ///
+  /// On Linux, a device another camera already has open is shared. It is
+  /// restarted in a larger or faster mode when this camera needs one. The
+  /// call fails with `format_conflict` if the device has no mode covering
+  /// both cameras.
   @override
   Future<int> createCameraWithSettings(
     CameraDescription cameraDescription,
     MediaSettings mediaSettings,
   ) async {
     _ensureNativeCallHandler();
+    try {
+      final result = await _channel.invokeMapMethod<String, dynamic>(
+        'create',
+        _createArguments(cameraDescription, mediaSettings),
+      );
+      final cameraId = result!['cameraId'] as int;
+      final textureId = result['textureId'] as int;
+      _textureIds[cameraId] = textureId;
+      return cameraId;
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Opens [cameraDescription]'s device and negotiates its capture format in
+  /// the background, ahead of [createCameraWithSettings] and
+  /// [initializeCamera].
+  ///
+  /// Call it as soon as you know which camera will be opened next (e.g. on a
+  /// camera selection screen). A later create with the same [mediaSettings]
+  /// picks the prepared pipeline up, so initialize only has to start it and
+  /// wait for the first frame. The device is released again if no camera
+  /// claims it within 10 seconds. Linux only; check `supportsPrepare` in
+  /// [getPlatformCapabilities].
+  Future<void> prepareCamera(
+    CameraDescription cameraDescription,
+    MediaSettings mediaSettings,
+  ) async {
+    try {
+      await _channel.invokeMethod<void>(
+        'prepare',
+        _createArguments(cameraDescription, mediaSettings),
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  Map<String, Object?> _createArguments(
+    CameraDescription cameraDescription,
+    MediaSettings mediaSettings,
+  ) {
     int? videoBitrate;
     try {
       final dynamic dynamicSettings = mediaSettings;
@@ -206,23 +296,15 @@ class CameraDesktopPlugin extends CameraPlatform {
         audioBitrate = value.toInt();
       }
     } catch (_) {}
-    try {
-      final result = await _channel.invokeMapMethod<String, dynamic>('create', {
-        'cameraName': cameraDescription.name,
-        'resolutionPreset':
-            mediaSettings.resolutionPreset?.index ?? ResolutionPreset.max.index,
-        'enableAudio': mediaSettings.enableAudio,
-        'fps': mediaSettings.fps,
-        'videoBitrate': ?videoBitrate,
-        'audioBitrate': ?audioBitrate,
-      });
-      final cameraId = result!['cameraId'] as int;
-      final textureId = result['textureId'] as int;
-      _textureIds[cameraId] = textureId;
-      return cameraId;
-    } on PlatformException catch (e) {
-      throw CameraException(e.code, e.message);
-    }
+    return {
+      'cameraName': cameraDescription.name,
+      'resolutionPreset':
+          mediaSettings.resolutionPreset?.index ?? ResolutionPreset.max.index,
+      'enableAudio': mediaSettings.enableAudio,
+      'fps': mediaSettings.fps,
+      'videoBitrate': ?videoBitrate,
+      'audioBitrate': ?audioBitrate,
+    };
   }
 
   @override
@@ -235,10 +317,14 @@ class CameraDesktopPlugin extends CameraPlatform {
         'initialize',
         {'cameraId': cameraId},
       );
+      final startup = result!['startup'];
+      if (startup is Map<Object?, Object?>) {
+        _startupTimings[cameraId] = StartupTimings.fromMap(startup);
+      }
       _eventStreamController.add(
         CameraInitializedEvent(
           cameraId,
-          (result!['previewWidth'] as num).toDouble(),
+          (result['previewWidth'] as num).toDouble(),
           (result['previewHeight'] as num).toDouble(),
           ExposureMode.auto,
           false,
@@ -265,6 +351,8 @@ class CameraDesktopPlugin extends CameraPlatform {
     } on PlatformException catch (_) {
     } finally {
       _textureIds.remove(cameraId);
+      _startupTimings.remove(cameraId);
+      _recordingCameraIds.remove(cameraId);
       final imageController = _imageStreamControllers.remove(cameraId);
       if (imageController != null && !imageController.isClosed) {
         imageController.close();
@@ -344,6 +432,94 @@ class CameraDesktopPlugin extends CameraPlatform {
     }
   }
 
+  /// Puts [cameraId] in or out of standby, a lower-power state between
+  /// [pausePreview] and dispose for cameras that are briefly out of view
+  /// (e.g. tiles scrolled offscreen).
+  ///
+  /// In standby the preview keeps showing the last frame and the image
+  /// stream pauses. Once no other camera uses the same device, the device
+  /// stops streaming and frees its capture buffers, releasing CPU and USB
+  /// bandwidth, while the pipeline and negotiated format stay ready. Leaving
+  /// standby only restarts the stream; [CameraStats.lastWakeUs] reports how
+  /// long that took. Pictures and recordings are refused in standby, and a
+  /// recording camera cannot enter it.
+  ///
+  /// Linux only; check `supportsStandby` in [getPlatformCapabilities].
+  Future<void> setStandby(int cameraId, bool standby) async {
+    try {
+      await _channel.invokeMethod<void>('setStandby', {
+        'cameraId': cameraId,
+        'standby': standby,
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Sets how [cameraId] adapts its frame rate to a hidden app or a static
+  /// scene; see [AdaptiveFrameRate]. Check [CameraStats.adaptiveIdle] and
+  /// [CameraStats.framesIdleSkipped] for the effect.
+  ///
+  /// Linux only; check `supportsAdaptiveFrameRate` in
+  /// [getPlatformCapabilities].
+  Future<void> setAdaptiveFrameRate(
+    int cameraId,
+    AdaptiveFrameRate setting,
+  ) async {
+    try {
+      await _channel.invokeMethod<void>('setAdaptiveFrameRate', {
+        'cameraId': cameraId,
+        ...setting.toMap(),
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Turns static-frame skipping on or off for [cameraId].
+  ///
+  /// While on, a frame that differs from the last delivered one by at most
+  /// [threshold] (mean per-channel difference, 0-255, on a sparse sample
+  /// grid) is not copied into the preview texture or the image stream, and
+  /// Flutter is not asked to redraw. The image stream simply delivers no
+  /// frame for it. A slow drift still gets through, since each frame is
+  /// compared with the last one delivered. [CameraStats.framesUnchanged]
+  /// counts the frames saved.
+  ///
+  /// Linux only; check `supportsStaticFrameSkipping` in
+  /// [getPlatformCapabilities].
+  Future<void> setStaticFrameSkipping(
+    int cameraId, {
+    bool enabled = true,
+    int threshold = 2,
+  }) async {
+    try {
+      await _channel.invokeMethod<void>('setStaticFrameSkipping', {
+        'cameraId': cameraId,
+        'enabled': enabled,
+        'threshold': threshold,
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Tells the native side whether the app's window is hidden (minimized or
+  /// fully covered), e.g. from `AppLifecycleState.hidden`. Cameras with an
+  /// [AdaptiveFrameRate] drop to their idle rate while it is.
+  ///
+  /// Linux only; a no-op elsewhere.
+  Future<void> setAppVisibility({required bool hidden}) async {
+    try {
+      await _channel.invokeMethod<void>('setAppVisibility', {
+        'hidden': hidden,
+      });
+    } on MissingPluginException catch (_) {
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
   /// Toggles horizontal mirroring on the live camera feed.
   ///
   /// On macOS, this sets `isVideoMirrored` on the AVCaptureConnection.
@@ -479,6 +655,9 @@ class CameraDesktopPlugin extends CameraPlatform {
         if (maxVideoDuration != null)
           'maxVideoDuration': maxVideoDuration.inMilliseconds,
       });
+      _recordingCameraIds
+        ..remove(cameraId)
+        ..add(cameraId);
     } on PlatformException catch (e) {
       throw CameraException(e.code, e.message);
     }
@@ -486,6 +665,7 @@ class CameraDesktopPlugin extends CameraPlatform {
 
   @override
   Future<XFile> stopVideoRecording(int cameraId) async {
+    _recordingCameraIds.remove(cameraId);
     try {
       final dynamic value = await _channel.invokeMethod<dynamic>(
         'stopVideoRecording',
@@ -630,13 +810,403 @@ class CameraDesktopPlugin extends CameraPlatform {
   @override
   Future<void> unlockCaptureOrientation(int cameraId) async {}
 
+  /// Tunes the native threads that run every camera's capture pipeline.
+  ///
+  /// [warmThreads] finished threads are kept parked so cameras opened
+  /// later reuse them instead of spawning new ones. When [cpus] is set,
+  /// new streaming threads are pinned round-robin to those CPU indices.
+  /// Only threads started after this call are affected.
+  ///
+  /// Linux only; a no-op elsewhere.
+  Future<void> configureStreamingThreads({
+    int warmThreads = 4,
+    List<int>? cpus,
+  }) async {
+    try {
+      await _channel.invokeMethod<void>('configureStreamingThreads', {
+        'warmThreads': warmThreads,
+        'cpus': ?cpus,
+      });
+    } on MissingPluginException catch (_) {
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Keeps disposed cameras warm for a quick re-create.
+  ///
+  /// With [maxEntries] above 0, a disposed camera that was streaming is
+  /// parked instead of torn down: its device stays open with the capture
+  /// pipeline built, and its texture keeps its buffers and last frame. A
+  /// later [createCameraWithSettings] for the same camera, resolution and
+  /// frame rate picks both up again (same texture id) and skips most of the
+  /// startup cost. Parked cameras are released after [idleTimeout], when
+  /// more than [maxEntries] are parked (least recently disposed first), or
+  /// when the same device is created with other settings. While parked,
+  /// the device stays busy for other processes.
+  ///
+  /// A [maxEntries] of 0 (the default) turns pooling off and releases
+  /// everything parked. Linux only; a no-op elsewhere.
+  Future<void> configureCameraPool({
+    int maxEntries = 0,
+    Duration idleTimeout = const Duration(seconds: 30),
+  }) async {
+    try {
+      await _channel.invokeMethod<void>('configureCameraPool', {
+        'maxEntries': maxEntries,
+        'idleTimeoutMs': idleTimeout.inMilliseconds,
+      });
+    } on MissingPluginException catch (_) {
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Sets how long a camera's preview must stay paused (or in standby), or
+  /// its image stream stopped, before the frame buffers it no longer uses
+  /// are returned to the system: the texture's two spare frames (the one on
+  /// screen stays) and the image stream buffer. They are allocated again
+  /// with the next frame that needs them. Applies to every camera.
+  ///
+  /// The default is 30 seconds; null turns the release off. Linux only; a
+  /// no-op elsewhere.
+  Future<void> configureIdleBufferRelease({
+    Duration? idleTimeout = const Duration(seconds: 30),
+  }) async {
+    try {
+      await _channel.invokeMethod<void>('configureIdleBufferRelease', {
+        'idleTimeoutMs': idleTimeout?.inMilliseconds ?? 0,
+      });
+    } on MissingPluginException catch (_) {
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Returns the native performance counters for [cameraId].
+  ///
+  /// Linux only; check `supportsCameraStats` in [getPlatformCapabilities].
+  Future<CameraStats> getCameraStats(int cameraId) async {
+    try {
+      final result = await _channel.invokeMapMethod<Object?, Object?>(
+        'getCameraStats',
+        {'cameraId': cameraId},
+      );
+      return CameraStats.fromMap(result!);
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Returns the bytes [cameraId]'s frames take, by subsystem.
+  ///
+  /// Linux only; check `supportsMemoryBudget` in [getPlatformCapabilities].
+  Future<MemoryUsage> getMemoryUsage(int cameraId) async {
+    try {
+      final result = await _channel.invokeMapMethod<Object?, Object?>(
+        'getMemoryUsage',
+        {'cameraId': cameraId},
+      );
+      return MemoryUsage.fromMap(result!);
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Caps the memory [cameraId]'s frames may take at [budgetBytes]: the
+  /// preview texture, the image stream, recycled buffers and the recording
+  /// queue. Pass null to remove the cap.
+  ///
+  /// Over budget the camera degrades instead of growing, mildest first: the
+  /// recording queue gets shorter (a slow encoder then holds the pipeline
+  /// back sooner), the preview texture drops to double buffering, and
+  /// finally the preview is shown at half its size. Recordings and the image
+  /// stream keep the full resolution throughout. The budget is re-planned
+  /// every second and the degradations lift once they are no longer needed;
+  /// [MemoryUsage.degradations] lists those in effect.
+  ///
+  /// Linux only; check `supportsMemoryBudget` in [getPlatformCapabilities].
+  Future<void> setMemoryBudget(int cameraId, int? budgetBytes) async {
+    try {
+      await _channel.invokeMethod<void>('setMemoryBudget', {
+        'cameraId': cameraId,
+        'budgetBytes': budgetBytes ?? 0,
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Where the time went while [cameraId] started, or null before it has
+  /// been initialized (or on platforms that do not report it).
+  ///
+  /// Linux only.
+  StartupTimings? getStartupTimings(int cameraId) => _startupTimings[cameraId];
+
+  /// Starts pushing stats for [cameraId] to [onCameraStats] every
+  /// [interval] (at least 100 ms). Pass null to stop.
+  Future<void> setCameraStatsInterval(int cameraId, Duration? interval) async {
+    try {
+      await _channel.invokeMethod<void>('setCameraStatsInterval', {
+        'cameraId': cameraId,
+        'intervalMs': interval?.inMilliseconds ?? 0,
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Stats pushed for [cameraId] after [setCameraStatsInterval].
+  Stream<CameraStats> onCameraStats(int cameraId) => _cameraStatsController
+      .stream
+      .where((s) => s.cameraId == cameraId);
+
+  /// Sets how [cameraId]'s device recovers from a disconnect or stream
+  /// error; see [ReconnectPolicy].
+  ///
+  /// The policy belongs to the device, so it applies to every camera opened
+  /// on it; the most recent call wins. Progress is reported on
+  /// [onCameraReconnect], and [CameraStats.reconnects] counts recoveries.
+  /// Linux only; check `supportsAutoReconnect` in [getPlatformCapabilities].
+  Future<void> setReconnectPolicy(
+    int cameraId,
+    ReconnectPolicy policy,
+  ) async {
+    try {
+      await _channel.invokeMethod<void>('setReconnectPolicy', {
+        'cameraId': cameraId,
+        ...policy.toMap(),
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Reconnect progress for [cameraId] under a [ReconnectPolicy].
+  Stream<CameraReconnectEvent> onCameraReconnect(int cameraId) =>
+      _reconnectController.stream.where((e) => e.cameraId == cameraId);
+
+  /// Enables or disables per-element latency tracing for [cameraId].
+  ///
+  /// Tracing adds a small cost per frame for every instrumented element,
+  /// so leave it off in production. The camera must be initialized.
+  Future<void> setLatencyTracing(int cameraId, bool enabled) async {
+    try {
+      await _channel.invokeMethod<void>('setLatencyTracing', {
+        'cameraId': cameraId,
+        'enabled': enabled,
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Per-element latency for [cameraId], in stream order from the device
+  /// source to the preview and recording elements.
+  ///
+  /// Requires [setLatencyTracing] to be enabled first.
+  Future<List<ElementLatency>> getPipelineLatency(int cameraId) async {
+    try {
+      final result = await _channel.invokeListMethod<Object?>(
+        'getPipelineLatency',
+        {'cameraId': cameraId},
+      );
+      return (result ?? const [])
+          .map((e) => ElementLatency.fromMap(e! as Map<Object?, Object?>))
+          .toList();
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Enables or disables frame lifecycle tracing for all cameras.
+  ///
+  /// While enabled, every frame's capture callback, texture copy, preview
+  /// update, FFI stream write and encode are timestamped into a fixed-size
+  /// per-thread ring (the newest events win). Use [dumpTrace] to save it.
+  Future<void> setFrameTracing(bool enabled) async {
+    try {
+      await _channel.invokeMethod<void>('setFrameTracing', {
+        'enabled': enabled,
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Writes the frame trace to [path] as Chrome trace JSON, viewable in
+  /// Perfetto (ui.perfetto.dev) or chrome://tracing. Returns the number of
+  /// events written.
+  Future<int> dumpTrace(String path) async {
+    try {
+      final events = await _channel.invokeMethod<int>('dumpTrace', {
+        'path': path,
+      });
+      return events ?? 0;
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Sets the scheduling policy and CPU affinity of a camera's threads.
+  ///
+  /// [capture] applies to the device's source thread (shared by every
+  /// camera on the device; the latest non-default setting wins), [convert]
+  /// to the thread that scales, mirrors and copies frames for this camera,
+  /// and [encode] to the recording encoder thread. Running threads change
+  /// immediately and threads started later inherit the setting.
+  ///
+  /// Returns what took effect per role, e.g. `{'capture': 'fifo:50',
+  /// 'convert': 'nice:-10 (fifo denied)', 'encode': 'pending'}`, plus an
+  /// `'error'` entry if part of the request was refused.
+  ///
+  /// Linux only; returns an empty map elsewhere.
+  Future<Map<String, String>> setThreadScheduling(
+    int cameraId, {
+    ThreadSchedule capture = const ThreadSchedule(),
+    ThreadSchedule convert = const ThreadSchedule(),
+    ThreadSchedule encode = const ThreadSchedule(),
+  }) async {
+    try {
+      final result = await _channel.invokeMapMethod<String, String>(
+        'setThreadScheduling',
+        {
+          'cameraId': cameraId,
+          'capture': capture.toMap(),
+          'convert': convert.toMap(),
+          'encode': encode.toMap(),
+        },
+      );
+      return result ?? const {};
+    } on MissingPluginException catch (_) {
+      return const {};
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Composes [cameras] into a single texture laid out as a grid.
+  ///
+  /// Each camera is scaled down to [tileWidth] x [tileHeight] natively
+  /// before it is copied, and the composed frame is uploaded once per
+  /// refresh at [fps], so a wall of many cameras costs one texture instead
+  /// of one per camera. Cameras that are already open by a controller are
+  /// shared, not reopened. A controller opened on a tile's camera later
+  /// still gets its own size and frame rate, since the shared capture grows
+  /// to it. [columns] defaults to a square-ish grid.
+  ///
+  /// Linux only; check `supportsMosaic` in [getPlatformCapabilities].
+  Future<CameraMosaic> createMosaic(
+    List<CameraDescription> cameras, {
+    int? columns,
+    int tileWidth = 320,
+    int tileHeight = 240,
+    int fps = 15,
+    ResolutionPreset resolutionPreset = ResolutionPreset.medium,
+    int? videoBitrate,
+  }) async {
+    _ensureNativeCallHandler();
+    try {
+      final result = await _channel
+          .invokeMapMethod<String, dynamic>('createMosaic', {
+            'cameraNames': cameras.map((c) => c.name).toList(),
+            'columns': ?columns,
+            'tileWidth': tileWidth,
+            'tileHeight': tileHeight,
+            'fps': fps,
+            'resolutionPreset': resolutionPreset.index,
+            'videoBitrate': ?videoBitrate,
+          });
+      return CameraMosaic(
+        mosaicId: result!['mosaicId'] as int,
+        textureId: result['textureId'] as int,
+        width: result['width'] as int,
+        height: result['height'] as int,
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Starts recording the composed frame of [mosaicId] to a video file.
+  Future<void> startMosaicRecording(int mosaicId) async {
+    try {
+      await _channel.invokeMethod<void>('startMosaicRecording', {
+        'mosaicId': mosaicId,
+      });
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Stops the mosaic recording and returns the finalized file.
+  ///
+  /// Throws a [CameraException] with code `recording_failed` if the file
+  /// cannot be finalized: the recording failed, took longer than 10 seconds
+  /// to finish, or the mosaic was disposed first.
+  Future<XFile> stopMosaicRecording(int mosaicId) async {
+    try {
+      final map = await _channel.invokeMapMethod<String, dynamic>(
+        'stopMosaicRecording',
+        {'mosaicId': mosaicId},
+      );
+      return XFile(map!['path'] as String);
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
+  }
+
+  /// Releases the mosaic texture and closes any camera only it was using.
+  Future<void> disposeMosaic(int mosaicId) async {
+    try {
+      await _channel.invokeMethod<void>('disposeMosaic', {
+        'mosaicId': mosaicId,
+      });
+    } on PlatformException catch (_) {}
+  }
+
+  /// Errors from individual mosaic tiles as `(tile, description)` pairs.
+  ///
+  /// A failing tile freezes its cell; the other tiles keep running. Errors
+  /// of the mosaic recording come with tile -1: the recording ends, and a
+  /// pending [stopMosaicRecording] fails with `recording_failed`.
+  Stream<(int, String)> onMosaicError(int mosaicId) => _mosaicErrorController
+      .stream
+      .where((e) => e.$1 == mosaicId)
+      .map((e) => (e.$2, e.$3));
+
+  /// Switches the recording camera to [description] without stopping the
+  /// recording: the preview and the file continue from the new device.
+  ///
+  /// Applies to the camera that started recording most recently. The new
+  /// device is captured at that camera's resolution preset and frame rate and
+  /// converted to its format, so the file keeps one size throughout; passing
+  /// the camera's own description switches back. The original device stays
+  /// open until the camera is disposed. Linux only; check
+  /// `supportsSetDescriptionWhileRecording` in [getPlatformCapabilities].
   @override
   Future<void> setDescriptionWhileRecording(
     CameraDescription description,
   ) async {
-    throw CameraException(
-      'setDescriptionWhileRecording',
-      'Switching camera during recording is not supported on desktop.',
-    );
+    if (_recordingCameraIds.isEmpty) {
+      throw CameraException(
+        'setDescriptionWhileRecording',
+        'No recording in progress.',
+      );
+    }
+    try {
+      await _channel.invokeMethod<void>('setDescriptionWhileRecording', {
+        'cameraId': _recordingCameraIds.last,
+        'cameraName': description.name,
+      });
+    } on MissingPluginException {
+      throw CameraException(
+        'setDescriptionWhileRecording',
+        'Switching camera during recording is not supported on this '
+            'platform.',
+      );
+    } on PlatformException catch (e) {
+      throw CameraException(e.code, e.message);
+    }
   }
 }
@@ -0,0 +1,26 @@
+/// A native mosaic that composes several cameras into a single texture.
+///
+/// Created by [CameraDesktopPlugin.createMosaic]. Render it with a
+/// `Texture(textureId: mosaic.textureId)` widget sized to [width] x [height]
+/// (or any size with the same aspect ratio).
+class CameraMosaic {
+  /// Creates a mosaic handle. Obtained from [CameraDesktopPlugin.createMosaic].
+  const CameraMosaic({
+    required this.mosaicId,
+    required this.textureId,
+    required this.width,
+    required this.height,
+  });
+
+  /// Identifier used for the recording and dispose calls.
+  final int mosaicId;
+
+  /// Flutter texture id of the composed frame.
+  final int textureId;
+
+  /// Width of the composed frame in pixels (columns x tile width).
+  final int width;
+
+  /// Height of the composed frame in pixels (rows x tile height).
+  final int height;
+}
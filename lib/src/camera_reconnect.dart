@@ -0,0 +1,88 @@
+/// How a camera recovers when its device disconnects or its stream fails.
+///
+/// Passed to [CameraDesktopPlugin.setReconnectPolicy]. While enabled, a
+/// failure no longer ends the camera: the native side restarts only the
+/// capture source, waits for the device to reappear (by USB port, so a
+/// replugged camera is found under a new `/dev` node), and resumes into the
+/// same texture, image stream and recording. Attempts back off
+/// exponentially from [initialDelay] up to [maxDelay].
+class ReconnectPolicy {
+  /// Creates a policy. The default is enabled with 100 ms initial delay,
+  /// 5 s maximum delay and 10 attempts.
+  const ReconnectPolicy({
+    this.enabled = true,
+    this.initialDelay = const Duration(milliseconds: 100),
+    this.maxDelay = const Duration(seconds: 5),
+    this.maxAttempts = 10,
+  });
+
+  /// Turns recovery off; failures surface as camera errors right away.
+  static const ReconnectPolicy disabled = ReconnectPolicy(enabled: false);
+
+  /// Whether failures are retried.
+  final bool enabled;
+
+  /// Wait before the first attempt; doubled after each failed one.
+  final Duration initialDelay;
+
+  /// Upper bound for the wait between attempts.
+  final Duration maxDelay;
+
+  /// Attempts before giving up and reporting the original error, or 0 to
+  /// retry until the camera is disposed.
+  final int maxAttempts;
+
+  Map<String, dynamic> toMap() => {
+    'enabled': enabled,
+    'initialDelayMs': initialDelay.inMilliseconds,
+    'maxDelayMs': maxDelay.inMilliseconds,
+    'maxAttempts': maxAttempts,
+  };
+}
+
+/// Stage of a reconnect reported by [CameraReconnectEvent].
+enum CameraReconnectState {
+  /// The source failed or ended; attempts are starting.
+  lost,
+
+  /// Frames are flowing again.
+  recovered,
+
+  /// Attempts ran out. A camera error with the original cause follows.
+  failed,
+}
+
+/// Progress of a reconnect, from [CameraDesktopPlugin.onCameraReconnect].
+class CameraReconnectEvent {
+  /// Creates an event.
+  const CameraReconnectEvent({
+    required this.cameraId,
+    required this.state,
+    required this.attempts,
+    this.downtime,
+  });
+
+  /// Parses the map sent over the method channel.
+  factory CameraReconnectEvent.fromMap(Map<Object?, Object?> map) {
+    final downtimeUs = map['downtimeUs'] as int?;
+    return CameraReconnectEvent(
+      cameraId: map['cameraId'] as int,
+      state: CameraReconnectState.values.byName(map['state'] as String),
+      attempts: map['attempts'] as int? ?? 0,
+      downtime: downtimeUs == null ? null : Duration(microseconds: downtimeUs),
+    );
+  }
+
+  /// Camera whose device was lost.
+  final int cameraId;
+
+  /// Stage of the reconnect.
+  final CameraReconnectState state;
+
+  /// Attempts made so far.
+  final int attempts;
+
+  /// From losing the source to the first frame after recovery (time to
+  /// recover), or to giving up. Null for [CameraReconnectState.lost].
+  final Duration? downtime;
+}
@@ -0,0 +1,411 @@
+/// A latency distribution reported by the native backend.
+///
+/// Samples are bucketed by powers of two in microseconds, so percentiles are
+/// upper bounds accurate to within a factor of two.
+class LatencyHistogram {
+  /// Creates a histogram snapshot.
+  const LatencyHistogram({
+    required this.count,
+    required this.meanUs,
+    required this.p50Us,
+    required this.p99Us,
+    required this.maxUs,
+    required this.log2Buckets,
+  });
+
+  /// Parses the map sent over the method channel.
+  factory LatencyHistogram.fromMap(Map<Object?, Object?>? map) {
+    if (map == null) return empty;
+    return LatencyHistogram(
+      count: map['count'] as int? ?? 0,
+      meanUs: (map['meanUs'] as num?)?.toDouble() ?? 0,
+      p50Us: map['p50Us'] as int? ?? 0,
+      p99Us: map['p99Us'] as int? ?? 0,
+      maxUs: map['maxUs'] as int? ?? 0,
+      log2Buckets: (map['log2Buckets'] as List<Object?>? ?? const [])
+          .cast<int>(),
+    );
+  }
+
+  /// A histogram with no samples.
+  static const empty = LatencyHistogram(
+    count: 0,
+    meanUs: 0,
+    p50Us: 0,
+    p99Us: 0,
+    maxUs: 0,
+    log2Buckets: [],
+  );
+
+  /// Number of samples since the camera started.
+  final int count;
+
+  /// Mean sample in microseconds.
+  final double meanUs;
+
+  /// Median, as the upper bound of its bucket.
+  final int p50Us;
+
+  /// 99th percentile, as the upper bound of its bucket.
+  final int p99Us;
+
+  /// Largest sample seen.
+  final int maxUs;
+
+  /// Bucket `i` counts samples in `[2^i, 2^(i+1))` microseconds.
+  final List<int> log2Buckets;
+}
+
+/// Performance counters for one camera, from
+/// [CameraDesktopPlugin.getCameraStats] or [CameraDesktopPlugin.onCameraStats].
+///
+/// Counts are cumulative since the camera was created. Frame rates cover the
+/// time since the previous report.
+class CameraStats {
+  /// Creates a stats snapshot.
+  const CameraStats({
+    required this.cameraId,
+    required this.framesCaptured,
+    required this.framesPreviewUpdated,
+    required this.framesAppsinkDropped,
+    required this.framesStreamed,
+    required this.framesStreamSkipped,
+    required this.captureFps,
+    required this.previewFps,
+    required this.copyTime,
+    required this.captureToTextureLatency,
+    this.encoderQueueDepth,
+    this.encoderQueueMs,
+    this.reconnects = 0,
+    this.lastRecoveryUs,
+    this.standby = false,
+    this.lastWakeUs,
+    this.framesUnchanged = 0,
+    this.adaptiveIdle = false,
+    this.framesIdleSkipped = 0,
+    this.frameMemoryBytes = 0,
+    this.frameMemoryHugePageBytes = 0,
+    this.frameBufferAllocations = 0,
+    this.frameBufferReuses = 0,
+    this.idleBufferReleases = 0,
+    this.framesPreviewDecimated = 0,
+  });
+
+  /// Parses the map sent over the method channel.
+  factory CameraStats.fromMap(Map<Object?, Object?> map) {
+    return CameraStats(
+      cameraId: map['cameraId'] as int,
+      framesCaptured: map['framesCaptured'] as int? ?? 0,
+      framesPreviewUpdated: map['framesPreviewUpdated'] as int? ?? 0,
+      framesAppsinkDropped: map['framesAppsinkDropped'] as int? ?? 0,
+      framesStreamed: map['framesStreamed'] as int? ?? 0,
+      framesStreamSkipped: map['framesStreamSkipped'] as int? ?? 0,
+      captureFps: (map['captureFps'] as num?)?.toDouble() ?? 0,
+      previewFps: (map['previewFps'] as num?)?.toDouble() ?? 0,
+      copyTime: LatencyHistogram.fromMap(
+        map['copyTime'] as Map<Object?, Object?>?,
+      ),
+      captureToTextureLatency: LatencyHistogram.fromMap(
+        map['captureToTextureLatency'] as Map<Object?, Object?>?,
+      ),
+      encoderQueueDepth: map['encoderQueueDepth'] as int?,
+      encoderQueueMs: map['encoderQueueMs'] as int?,
+      reconnects: map['reconnects'] as int? ?? 0,
+      lastRecoveryUs: map['lastRecoveryUs'] as int?,
+      standby: map['standby'] as bool? ?? false,
+      lastWakeUs: map['lastWakeUs'] as int?,
+      framesUnchanged: map['framesUnchanged'] as int? ?? 0,
+      adaptiveIdle: map['adaptiveIdle'] as bool? ?? false,
+      framesIdleSkipped: map['framesIdleSkipped'] as int? ?? 0,
+      frameMemoryBytes: map['frameMemoryBytes'] as int? ?? 0,
+      frameMemoryHugePageBytes: map['frameMemoryHugePageBytes'] as int? ?? 0,
+      frameBufferAllocations: map['frameBufferAllocations'] as int? ?? 0,
+      frameBufferReuses: map['frameBufferReuses'] as int? ?? 0,
+      idleBufferReleases: map['idleBufferReleases'] as int? ?? 0,
+      framesPreviewDecimated: map['framesPreviewDecimated'] as int? ?? 0,
+    );
+  }
+
+  /// Camera these stats belong to.
+  final int cameraId;
+
+  /// Frames delivered to the camera by the capture pipeline.
+  final int framesCaptured;
+
+  /// Frames written to the preview texture (excludes paused preview).
+  final int framesPreviewUpdated;
+
+  /// Frames discarded because the previous one was still being processed.
+  final int framesAppsinkDropped;
+
+  /// Frames published to the image stream.
+  final int framesStreamed;
+
+  /// Image-stream frames replaced before Dart read them.
+  final int framesStreamSkipped;
+
+  /// Frames captured per second over the last report window.
+  final double captureFps;
+
+  /// Preview texture updates per second over the last report window.
+  final double previewFps;
+
+  /// Time spent copying each frame into the preview texture.
+  final LatencyHistogram copyTime;
+
+  /// Time from capture to the frame being handed to the texture.
+  final LatencyHistogram captureToTextureLatency;
+
+  /// Frames waiting for the video encoder, or null when not recording.
+  final int? encoderQueueDepth;
+
+  /// Duration of video waiting for the encoder, or null when not recording.
+  final int? encoderQueueMs;
+
+  /// Times the device recovered under a reconnect policy.
+  final int reconnects;
+
+  /// Time to recover of the last reconnect, from losing the source to the
+  /// first frame back, or null if it never reconnected.
+  final int? lastRecoveryUs;
+
+  /// Whether the camera is in standby ([CameraDesktopPlugin.setStandby]).
+  final bool standby;
+
+  /// From the last request to leave standby to the first frame after it,
+  /// or null if the camera never left standby.
+  final int? lastWakeUs;
+
+  /// Frames not delivered because they matched the previous one
+  /// ([CameraDesktopPlugin.setStaticFrameSkipping]).
+  final int framesUnchanged;
+
+  /// Whether the camera is currently at its idle rate under an
+  /// [AdaptiveFrameRate].
+  final bool adaptiveIdle;
+
+  /// Frames dropped at the idle rate.
+  final int framesIdleSkipped;
+
+  /// Bytes of frame buffers the camera holds: texture frames, the image
+  /// stream buffer, and recycled temporaries.
+  final int frameMemoryBytes;
+
+  /// Of [frameMemoryBytes], bytes in buffers advised to use huge pages.
+  final int frameMemoryHugePageBytes;
+
+  /// Frame buffers taken from the system.
+  final int frameBufferAllocations;
+
+  /// Frame buffer requests served by recycling a released buffer.
+  final int frameBufferReuses;
+
+  /// Times idle buffers were returned to the system
+  /// ([CameraDesktopPlugin.configureIdleBufferRelease]).
+  final int idleBufferReleases;
+
+  /// Frames left out of the preview because the camera captures faster than
+  /// the display refreshes (above 60 fps). The image stream and recordings
+  /// still get them.
+  final int framesPreviewDecimated;
+}
+
+/// Bytes a camera's frames take, by subsystem, from
+/// [CameraDesktopPlugin.getMemoryUsage].
+class MemoryUsage {
+  /// Creates a memory usage report.
+  const MemoryUsage({
+    required this.cameraId,
+    required this.textureBytes,
+    required this.imageStreamBytes,
+    required this.inFlightBytes,
+    required this.recycledBytes,
+    required this.recordingQueueBytes,
+    required this.recordingQueueLimitBytes,
+    required this.totalBytes,
+    this.budgetBytes,
+    this.degradations = const [],
+  });
+
+  /// Parses the map sent over the method channel.
+  factory MemoryUsage.fromMap(Map<Object?, Object?> map) {
+    final budget = map['budget'] as int? ?? 0;
+    return MemoryUsage(
+      cameraId: map['cameraId'] as int,
+      textureBytes: map['texture'] as int? ?? 0,
+      imageStreamBytes: map['imageStream'] as int? ?? 0,
+      inFlightBytes: map['inFlight'] as int? ?? 0,
+      recycledBytes: map['recycled'] as int? ?? 0,
+      recordingQueueBytes: map['recordingQueue'] as int? ?? 0,
+      recordingQueueLimitBytes: map['recordingQueueLimit'] as int? ?? 0,
+      totalBytes: map['total'] as int? ?? 0,
+      budgetBytes: budget > 0 ? budget : null,
+      degradations: (map['degradations'] as List<Object?>? ?? const [])
+          .cast<String>(),
+    );
+  }
+
+  /// Camera this report belongs to.
+  final int cameraId;
+
+  /// Preview texture frames (three, or two when double-buffered).
+  final int textureBytes;
+
+  /// The image stream's shared buffer.
+  final int imageStreamBytes;
+
+  /// Frame copies on their way to Dart over the method channel, and other
+  /// temporaries in use.
+  final int inFlightBytes;
+
+  /// Released frame buffers kept for reuse.
+  final int recycledBytes;
+
+  /// Video waiting for the encoder.
+  final int recordingQueueBytes;
+
+  /// How far the recording queue may grow.
+  final int recordingQueueLimitBytes;
+
+  /// All of the above.
+  final int totalBytes;
+
+  /// Budget set with [CameraDesktopPlugin.setMemoryBudget], or null.
+  final int? budgetBytes;
+
+  /// Degradations the budget currently imposes, mildest first:
+  /// `recordingQueue` (a lower [recordingQueueLimitBytes]), `doubleBuffer`
+  /// (one texture frame fewer) and `reducedPreview` (a half-size preview).
+  final List<String> degradations;
+}
+
+/// Latency contributed by one pipeline element, from
+/// [CameraDesktopPlugin.getPipelineLatency].
+class ElementLatency {
+  /// Creates an element latency entry.
+  const ElementLatency({
+    required this.element,
+    required this.factory,
+    required this.kind,
+    required this.stage,
+    required this.latency,
+  });
+
+  /// Parses the map sent over the method channel.
+  factory ElementLatency.fromMap(Map<Object?, Object?> map) {
+    return ElementLatency(
+      element: map['element'] as String,
+      factory: map['factory'] as String,
+      kind: map['kind'] as String,
+      stage: map['stage'] as String,
+      latency: LatencyHistogram.fromMap(
+        map['latency'] as Map<Object?, Object?>?,
+      ),
+    );
+  }
+
+  /// Element instance name, e.g. `branch_queue` or `rec_encoder`.
+  final String element;
+
+  /// GStreamer factory, e.g. `videoconvert` or `x264enc`.
+  final String factory;
+
+  /// `source`: capture timestamp to push. `queue`: time spent queued.
+  /// `transform`: processing time.
+  final String kind;
+
+  /// `capture` (shared device source), `branch` (this camera's preview
+  /// path) or `record` (recording encoder path).
+  final String stage;
+
+  /// Per-buffer latency distribution since tracing was enabled.
+  final LatencyHistogram latency;
+}
+
+/// Where the time went while a camera started, from
+/// [CameraDesktopPlugin.getStartupTimings].
+///
+/// All values are microseconds. A phase is null when the camera did not go
+/// through it, e.g. the pipeline phases when the device was already
+/// streaming for another camera ([sessionReused]).
+class StartupTimings {
+  /// Creates a startup breakdown.
+  const StartupTimings({
+    this.gstInitUs,
+    this.enumerateUs,
+    this.branchBuildUs,
+    this.parseUs,
+    this.stateChangeUs,
+    this.firstFrameUs,
+    this.textureUploadUs,
+    this.respondUs,
+    this.initializeTotalUs,
+    this.createToFirstFrameUs,
+    this.sessionReused = false,
+    this.sessionPrepared = false,
+    this.pooled = false,
+  });
+
+  /// Parses the `startup` map of the initialize response.
+  factory StartupTimings.fromMap(Map<Object?, Object?> map) {
+    return StartupTimings(
+      gstInitUs: map['gstInitUs'] as int?,
+      enumerateUs: map['enumerateUs'] as int?,
+      branchBuildUs: map['branchBuildUs'] as int?,
+      parseUs: map['parseUs'] as int?,
+      stateChangeUs: map['stateChangeUs'] as int?,
+      firstFrameUs: map['firstFrameUs'] as int?,
+      textureUploadUs: map['textureUploadUs'] as int?,
+      respondUs: map['respondUs'] as int?,
+      initializeTotalUs: map['initializeTotalUs'] as int?,
+      createToFirstFrameUs: map['createToFirstFrameUs'] as int?,
+      sessionReused: map['sessionReused'] as bool? ?? false,
+      sessionPrepared: map['sessionPrepared'] as bool? ?? false,
+      pooled: map['pooled'] as bool? ?? false,
+    );
+  }
+
+  /// `gst_init`, on the background thread started at plugin registration
+  /// (process-wide, so it does not delay the app itself).
+  final int? gstInitUs;
+
+  /// Device and resolution lookup in `create`.
+  final int? enumerateUs;
+
+  /// Building this camera's preview branch.
+  final int? branchBuildUs;
+
+  /// Parsing the capture pipeline.
+  final int? parseUs;
+
+  /// From asking the pipeline to play until it reached PLAYING.
+  final int? stateChangeUs;
+
+  /// From the start of initialize to the first frame at the camera.
+  final int? firstFrameUs;
+
+  /// Copying the first frame into the texture.
+  final int? textureUploadUs;
+
+  /// From the first texture update to the initialize response.
+  final int? respondUs;
+
+  /// The whole initialize call on the native side.
+  final int? initializeTotalUs;
+
+  /// From the start of `create` to the first frame in the texture.
+  final int? createToFirstFrameUs;
+
+  /// Whether the camera joined a capture session that was already running.
+  final bool sessionReused;
+
+  /// Whether the pipeline was brought up by
+  /// [CameraDesktopPlugin.prepareCamera] before initialize, in which case
+  /// [parseUs] is left out.
+  final bool sessionPrepared;
+
+  /// Whether the camera came back from the pool
+  /// ([CameraDesktopPlugin.configureCameraPool]) with its pipeline and
+  /// texture.
+  final bool pooled;
+}
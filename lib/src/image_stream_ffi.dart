@@ -13,8 +13,9 @@ import 'package:camera_platform_interface/camera_platform_interface.dart';
 ///   int32_t height        (offset 12)
 ///   int32_t bytes_per_row (offset 16)
 ///   int32_t format        (offset 20)  -- 0=BGRA, 1=RGBA
-///   int32_t ready         (offset 24)  -- 1=Dart may read, 0=native writing
-///   int32_t _pad          (offset 28)
+///   int32_t ready         (offset 24)  -- 1=Dart may read, 0=native writing,
+///                                       2=unchanged (Linux)
+///   int32_t consumed      (offset 28)  -- written by Dart, see [consumed]
 ///   uint8_t pixels[]      (offset 32)
 final class ImageStreamBuffer extends Struct {
   /// Frame sequence number, incremented by native code for each new frame.
@@ -37,14 +38,17 @@ final class ImageStreamBuffer extends Struct {
   @Int32()
   external int format;
 
-  /// Ready flag: 1 = Dart may read, 0 = native is writing.
+  /// Ready flag: 1 = Dart may read, 0 = native is writing, 2 = the frame
+  /// at [sequence] matches the previous one and the pixels were left as
+  /// they were (Linux static-frame skipping).
   @Int32()
   external int ready;
 
-  /// Padding for 8-byte alignment.
+  /// Low 32 bits of the last [sequence] Dart read, written back by Dart so
+  /// the native side can count frames overwritten before they were read.
+  /// Backends that do not track this treat it as padding.
   @Int32()
-  // ignore: unused_field
-  external int _pad;
+  external int consumed;
 }
 
 /// Native function signature for retrieving the shared image buffer pointer.
@@ -219,10 +223,15 @@ class ImageStreamFfi {
     if (bufPtr == nullptr) return;
 
     final buf = bufPtr.cast<ImageStreamBuffer>().ref;
-    if (buf.ready != 1) return;
+    if (buf.ready == 0) return;
 
     if (buf.sequence <= _lastSequence) return;
     _lastSequence = buf.sequence;
+    if (buf.ready == 2) {
+      // Nothing new to deliver; acknowledge so native can keep skipping.
+      buf.consumed = _lastSequence.toSigned(32);
+      return;
+    }
 
     final width = buf.width;
     final height = buf.height;
@@ -234,6 +243,7 @@ class ImageStreamFfi {
     final nativeView = pixelsPtr.asTypedList(dataSize);
 
     final bytes = Uint8List.fromList(nativeView);
+    buf.consumed = _lastSequence.toSigned(32);
 
     final rawFormat = format == 0 ? 'BGRA' : 'RGBA';
 
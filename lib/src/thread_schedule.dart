@@ -0,0 +1,43 @@
+/// Scheduling class for a native streaming thread.
+enum ThreadPolicy {
+  /// Leave the thread at the system default (normal priority, nice 0).
+  normal,
+
+  /// Normal scheduling with [ThreadSchedule.priority] as the nice value
+  /// (-20 highest to 19 lowest). Negative values need `CAP_SYS_NICE` or an
+  /// `RLIMIT_NICE` grant.
+  nice,
+
+  /// Real-time `SCHED_FIFO` with [ThreadSchedule.priority] in 1..99. Needs
+  /// `CAP_SYS_NICE` or an `RLIMIT_RTPRIO` grant; when refused the thread
+  /// falls back to nice -10.
+  fifo,
+}
+
+/// Scheduling policy and CPU affinity for one class of camera thread.
+///
+/// Passed to [CameraDesktopPlugin.setThreadScheduling].
+class ThreadSchedule {
+  /// Creates a schedule. The default leaves the thread untouched.
+  const ThreadSchedule({
+    this.policy = ThreadPolicy.normal,
+    this.priority = 0,
+    this.cpus,
+  });
+
+  /// Scheduling class.
+  final ThreadPolicy policy;
+
+  /// Nice value for [ThreadPolicy.nice], real-time priority for
+  /// [ThreadPolicy.fifo]; ignored for [ThreadPolicy.normal].
+  final int priority;
+
+  /// CPU indices the thread may run on, or null to leave affinity alone.
+  final List<int>? cpus;
+
+  Map<String, dynamic> toMap() => {
+    'policy': policy == ThreadPolicy.normal ? 'default' : policy.name,
+    'priority': priority,
+    'cpus': ?cpus,
+  };
+}
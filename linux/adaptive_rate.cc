@@ -0,0 +1,46 @@
+#include "adaptive_rate.h"
+
+#include "camera_stats.h"
+
+void AdaptiveFrameRate::Configure(const AdaptiveRateConfig& config) {
+  int idle_fps = config.idle_fps < 1 ? 1 : config.idle_fps;
+  idle_interval_us_.store(1000000 / idle_fps);
+  static_threshold_.store(config.static_threshold);
+  static_delay_us_.store(static_cast<int64_t>(config.static_delay_ms) * 1000);
+  enabled_.store(config.enabled);
+}
+
+bool AdaptiveFrameRate::ShouldPass(const uint8_t* data, int width, int height,
+                                   size_t stride, int64_t now_us) {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    if (idle_.load(std::memory_order_relaxed)) {
+      idle_.store(false, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  bool idle;
+  if (hidden_.load(std::memory_order_relaxed)) {
+    // Nothing is looking; skip the metric too. The first frame once shown
+    // again compares against nothing and counts as motion.
+    detector_.Reset();
+    idle = true;
+  } else {
+    if (!data || detector_.Update(data, width, height, stride) >
+                     static_threshold_.load(std::memory_order_relaxed)) {
+      last_change_us_ = now_us;
+    }
+    idle = now_us - last_change_us_ >=
+           static_delay_us_.load(std::memory_order_relaxed);
+  }
+  if (hold_.load(std::memory_order_relaxed)) idle = false;
+  idle_.store(idle, std::memory_order_relaxed);
+
+  if (!idle || now_us - last_pass_us_ >=
+                   idle_interval_us_.load(std::memory_order_relaxed)) {
+    last_pass_us_ = now_us;
+    return true;
+  }
+  StatsBump(frames_skipped_);
+  return false;
+}
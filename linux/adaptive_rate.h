@@ -0,0 +1,79 @@
+#ifndef ADAPTIVE_RATE_H_
+#define ADAPTIVE_RATE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "frame_change.h"
+
+// Settings of a camera's adaptive frame rate.
+struct AdaptiveRateConfig {
+  bool enabled = false;
+  int idle_fps = 5;  // Rate the camera processes at while idle.
+  // Mean per-channel difference (0-255, see FrameChangeDetector) a frame
+  // must exceed to count as motion.
+  int static_threshold = 2;
+  // How long the scene must stay unchanged before the rate drops.
+  int static_delay_ms = 1000;
+};
+
+// Decides which frames a camera processes. The device keeps capturing at
+// its full rate (it may be shared, and changing its format would cost a
+// renegotiation); while the camera is idle, frames are dropped at the
+// entrance of its branch down to the idle rate, which saves the scaling,
+// mirroring, texture copy and upload, and image stream copy of every frame
+// dropped. A camera is idle while the app reports it is hidden, or once the
+// scene has been static for the configured delay. The change metric runs on
+// every frame, dropped or not, so the first frame with motion (or the first
+// after the app is shown again) is passed and brings back the full rate.
+//
+// Configure, SetHidden and SetHoldFullRate run on the main thread;
+// ShouldPass on the streaming thread feeding the camera's branch.
+class AdaptiveFrameRate {
+ public:
+  AdaptiveFrameRate() = default;
+
+  AdaptiveFrameRate(const AdaptiveFrameRate&) = delete;
+  AdaptiveFrameRate& operator=(const AdaptiveFrameRate&) = delete;
+
+  void Configure(const AdaptiveRateConfig& config);
+  void SetHidden(bool hidden) { hidden_.store(hidden); }
+  // Keeps the full rate regardless, e.g. while recording.
+  void SetHoldFullRate(bool hold) { hold_.store(hold); }
+
+  // Returns whether the RGBA frame in |data| should be processed. |now_us|
+  // is g_get_monotonic_time().
+  bool ShouldPass(const uint8_t* data, int width, int height, size_t stride,
+                  int64_t now_us);
+  // True when ShouldPass needs the frame's pixels; otherwise it may be
+  // called with null |data|.
+  bool needs_pixels() const {
+    return enabled_.load(std::memory_order_relaxed) &&
+           !hidden_.load(std::memory_order_relaxed);
+  }
+
+  bool idle() const { return idle_.load(std::memory_order_relaxed); }
+  // Frames dropped while idle.
+  uint64_t frames_skipped() const {
+    return frames_skipped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Written on the main thread.
+  std::atomic<bool> enabled_{false};
+  std::atomic<int64_t> idle_interval_us_{200000};
+  std::atomic<int> static_threshold_{2};
+  std::atomic<int64_t> static_delay_us_{1000000};
+  std::atomic<bool> hidden_{false};
+  std::atomic<bool> hold_{false};
+
+  // Streaming thread only (idle_ and frames_skipped_ are read anywhere).
+  FrameChangeDetector detector_;
+  int64_t last_change_us_ = 0;
+  int64_t last_pass_us_ = 0;
+  std::atomic<bool> idle_{false};
+  std::atomic<uint64_t> frames_skipped_{0};
+};
+
+#endif  // ADAPTIVE_RATE_H_
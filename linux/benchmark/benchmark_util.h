@@ -0,0 +1,44 @@
+#ifndef BENCHMARK_UTIL_H_
+#define BENCHMARK_UTIL_H_
+
+// Measurement helpers shared by the benchmark executables.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace benchmark_util {
+
+// Nearest-rank percentile of |values| (p in 0..1); 0 when empty.
+inline double Percentile(std::vector<double> values, double p) {
+  if (values.empty()) return 0.0;
+  std::sort(values.begin(), values.end());
+  size_t idx = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+  return values[std::min(idx, values.size() - 1)];
+}
+
+// User plus system CPU time of the whole process, in seconds.
+inline double ProcessCpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+inline int ProcessThreadCount() {
+  FILE* f = fopen("/proc/self/status", "r");
+  if (!f) return -1;
+  char line[256];
+  int threads = -1;
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, "Threads: %d", &threads) == 1) break;
+  }
+  fclose(f);
+  return threads;
+}
+
+}  // namespace benchmark_util
+
+#endif  // BENCHMARK_UTIL_H_
@@ -0,0 +1,642 @@
+// Camera backend benchmark.
+//
+// Drives the plugin's real Camera and CaptureSession code headlessly. The
+// Flutter embedder is replaced by the stubs in embedder_stubs.h: a texture
+// registrar whose "raster thread" pulls every frame through copy_pixels and
+// reads it once, the way the engine's GL upload does, and a binary messenger
+// that feeds method calls to the camera and decodes its responses. The
+// device is replaced by a virtual source (videotestsrc or a looping media
+// file, see virtual_source.h), so neither a webcam nor a running Flutter app
+// is needed.
+//
+// Scenarios, each on a fresh camera:
+//   preview - texture updates only.
+//   stream  - preview plus the FFI image stream, read on a consumer thread
+//             the way Dart does (--legacy-stream: the method-channel path).
+//   photo   - preview plus back-to-back takePicture calls.
+//   record  - preview plus H.264 recording to a temporary file.
+//   hidden  - preview with the adaptive frame rate on and the app reported
+//             hidden (not run by default).
+//   static  - preview with the adaptive frame rate on, from a still pattern
+//             (not run by default).
+//   highfps - preview plus the FFI image stream at 640x480 and 240 fps,
+//             regardless of --width/--height/--fps: the preview is
+//             decimated to display rate while the stream gets every frame;
+//             reports appsink drops, which should be 0 (not run by
+//             default).
+// Compare the cpu_% of hidden and static with preview for the adaptive
+// frame rate's savings.
+//
+// Usage:
+//   camera_desktop_camera_benchmark [--scenarios=preview,stream,photo,record]
+//       [--width=1280] [--height=720] [--fps=30] [--seconds=5]
+//       [--source=test://pattern?pattern=ball | --file=/path/to/clip.mkv]
+//       [--photos=20] [--legacy-stream]
+
+#include <flutter_linux/flutter_linux.h>
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "camera.h"
+#include "capture_session.h"
+#include "embedder_stubs.h"
+#include "virtual_source.h"
+
+using benchmark_util::Percentile;
+using benchmark_util::ProcessCpuSeconds;
+
+namespace {
+
+const char kChannelName[] = "plugins.flutter.io/camera_desktop";
+
+enum class Scenario {
+  kPreview,
+  kStream,
+  kPhoto,
+  kRecord,
+  kHidden,
+  kStatic,
+  kHighFps
+};
+
+// Source of the static scenario: a still test pattern.
+const char kStaticSource[] = "test://pattern?pattern=smpte";
+
+// Capture mode of the highfps scenario.
+const int kHighFpsWidth = 640;
+const int kHighFpsHeight = 480;
+const int kHighFpsRate = 240;
+
+const char* ScenarioName(Scenario scenario) {
+  switch (scenario) {
+    case Scenario::kPreview:
+      return "preview";
+    case Scenario::kStream:
+      return "stream";
+    case Scenario::kPhoto:
+      return "photo";
+    case Scenario::kRecord:
+      return "record";
+    case Scenario::kHidden:
+      return "hidden";
+    case Scenario::kStatic:
+      return "static";
+    case Scenario::kHighFps:
+      return "highfps";
+  }
+  return "?";
+}
+
+struct Options {
+  std::vector<Scenario> scenarios = {Scenario::kPreview, Scenario::kStream,
+                                     Scenario::kPhoto, Scenario::kRecord};
+  int width = 1280;
+  int height = 720;
+  int fps = 30;
+  int seconds = 5;
+  int photos = 20;
+  std::string source = "test://pattern?pattern=ball";  // Virtual source URI.
+  bool legacy_stream = false;
+};
+
+// Reads FFI image stream frames on its own thread, as the Dart isolate does
+// after the native callback posts to its port.
+struct StreamConsumer {
+  Camera* camera = nullptr;
+  GThread* thread = nullptr;
+  GMutex mutex;
+  GCond cond;
+  bool stop = false;
+  bool notified = false;
+  gint64 notify_us = 0;
+
+  std::vector<uint8_t> copy;  // Consumer thread only.
+  std::mutex stats_mutex;
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  std::vector<double> latency_ms;  // Publish to copy complete.
+
+  StreamConsumer() {
+    g_mutex_init(&mutex);
+    g_cond_init(&cond);
+  }
+  ~StreamConsumer() {
+    g_cond_clear(&cond);
+    g_mutex_clear(&mutex);
+  }
+
+  void Notify() {
+    g_mutex_lock(&mutex);
+    if (!notified) notify_us = g_get_monotonic_time();
+    notified = true;
+    g_cond_signal(&cond);
+    g_mutex_unlock(&mutex);
+  }
+
+  static gpointer Run(gpointer data) {
+    auto* self = static_cast<StreamConsumer*>(data);
+    while (true) {
+      g_mutex_lock(&self->mutex);
+      while (!self->notified && !self->stop) {
+        g_cond_wait(&self->cond, &self->mutex);
+      }
+      bool stop = self->stop;
+      gint64 notify_us = self->notify_us;
+      self->notified = false;
+      g_mutex_unlock(&self->mutex);
+      if (stop) return nullptr;
+
+      auto* buf = static_cast<ImageStreamBuffer*>(
+          self->camera->GetImageStreamBuffer());
+      if (!buf || __atomic_load_n(&buf->ready, __ATOMIC_ACQUIRE) != 1) {
+        continue;
+      }
+      size_t size = (size_t)buf->bytes_per_row * buf->height;
+      self->copy.resize(size);
+      memcpy(self->copy.data(), buf->pixels, size);
+      buf->consumed = (int32_t)buf->sequence;
+
+      double ms = (g_get_monotonic_time() - notify_us) / 1e3;
+      std::lock_guard<std::mutex> lk(self->stats_mutex);
+      self->frames++;
+      self->bytes += size;
+      self->latency_ms.push_back(ms);
+    }
+  }
+
+  void Start(Camera* cam) {
+    camera = cam;
+    thread = g_thread_new("bench-stream", Run, this);
+  }
+
+  void Stop() {
+    if (!thread) return;
+    g_mutex_lock(&mutex);
+    stop = true;
+    g_cond_signal(&cond);
+    g_mutex_unlock(&mutex);
+    g_thread_join(thread);
+    thread = nullptr;
+  }
+};
+
+StreamConsumer* g_stream_consumer = nullptr;
+
+void OnStreamFrame(int32_t camera_id) {
+  if (g_stream_consumer) g_stream_consumer->Notify();
+}
+
+double HistogramValue(FlValue* stats, const char* histogram, const char* key) {
+  FlValue* h = fl_value_lookup_string(stats, histogram);
+  return h ? LookupFloat(h, key) : 0.0;
+}
+
+struct ScenarioResult {
+  double init_ms = 0;
+  double capture_fps = 0;
+  double preview_fps = 0;
+  double cpu_percent = 0;
+  double cpu_us_per_frame = 0;
+  double copy_mb_s = 0;      // Camera-side copy into the texture.
+  double raster_mb_s = 0;    // copy_pixels + upload read on the raster stub.
+  double p50_ms = 0;
+  double p99_ms = 0;
+  std::string metric;        // What p50/p99 measure.
+  std::string extra;
+};
+
+std::string Format(const char* fmt, ...) G_GNUC_PRINTF(1, 2);
+std::string Format(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  gchar* s = g_strdup_vprintf(fmt, args);
+  va_end(args);
+  std::string result = s;
+  g_free(s);
+  return result;
+}
+
+class Harness {
+ public:
+  explicit Harness(const Options& opt) : opt_(opt) {
+    registrar_ = bench_texture_registrar_new();
+    messenger_ = bench_messenger_new();
+    g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+    channel_ = fl_method_channel_new(FL_BINARY_MESSENGER(messenger_),
+                                     kChannelName, FL_METHOD_CODEC(codec));
+    fl_method_channel_set_method_call_handler(channel_, OnMethodCall, this,
+                                              nullptr);
+  }
+
+  ~Harness() {
+    g_object_unref(channel_);
+    g_object_unref(messenger_);
+    g_object_unref(registrar_);
+  }
+
+  bool Run(Scenario scenario, ScenarioResult* result);
+
+ private:
+  static void OnMethodCall(FlMethodChannel* channel, FlMethodCall* call,
+                           gpointer user_data);
+  bool MakeConfig(const std::string& uri, CameraConfig* config) const;
+
+  const Options& opt_;
+  BenchTextureRegistrar* registrar_;
+  BenchMessenger* messenger_;
+  FlMethodChannel* channel_;
+  Camera* camera_ = nullptr;
+};
+
+void Harness::OnMethodCall(FlMethodChannel* channel, FlMethodCall* call,
+                           gpointer user_data) {
+  auto* self = static_cast<Harness*>(user_data);
+  const gchar* method = fl_method_call_get_name(call);
+  if (!self->camera_) {
+    fl_method_call_respond_not_implemented(call, nullptr);
+  } else if (strcmp(method, "initialize") == 0) {
+    self->camera_->Initialize(call);
+  } else if (strcmp(method, "takePicture") == 0) {
+    self->camera_->TakePicture(call);
+  } else if (strcmp(method, "startVideoRecording") == 0) {
+    self->camera_->StartVideoRecording(call);
+  } else if (strcmp(method, "stopVideoRecording") == 0) {
+    self->camera_->StopVideoRecording(call);
+  } else {
+    fl_method_call_respond_not_implemented(call, nullptr);
+  }
+}
+
+bool Harness::MakeConfig(const std::string& uri, CameraConfig* config) const {
+  // Same mapping as the plugin's create, with the size and rate taken from
+  // the options.
+  VirtualSource source;
+  std::string error;
+  if (!ParseVirtualSourceUri(uri, &source, &error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return false;
+  }
+  config->device_path = uri;
+  config->resolution_preset = 0;
+  config->enable_audio = false;
+  config->target_width = opt_.width;
+  config->target_height = opt_.height;
+  config->target_fps = opt_.fps;
+  config->target_bitrate = 0;
+  config->source = source.description;
+  config->loop_source = source.loop;
+  return true;
+}
+
+bool Harness::Run(Scenario scenario, ScenarioResult* result) {
+  CameraConfig config;
+  if (!MakeConfig(scenario == Scenario::kStatic ? kStaticSource : opt_.source,
+                  &config)) {
+    return false;
+  }
+  if (scenario == Scenario::kHighFps) {
+    config.target_width = kHighFpsWidth;
+    config.target_height = kHighFpsHeight;
+    config.target_fps = kHighFpsRate;
+  }
+  auto session = std::make_shared<CaptureSession>(config);
+  Camera camera(1, FL_TEXTURE_REGISTRAR(registrar_), channel_, config,
+                session);
+  camera_ = &camera;
+  if (camera.RegisterTexture() < 0) {
+    fprintf(stderr, "%s: texture registration failed\n",
+            ScenarioName(scenario));
+    camera_ = nullptr;
+    return false;
+  }
+
+  std::string error;
+  result->init_ms = CallAndWait(messenger_, kChannelName, "initialize",
+                                nullptr, 10000, &error);
+  if (result->init_ms < 0) {
+    fprintf(stderr, "%s: initialize failed: %s\n", ScenarioName(scenario),
+            error.c_str());
+    camera.Dispose();
+    camera_ = nullptr;
+    return false;
+  }
+
+  if (scenario == Scenario::kHidden || scenario == Scenario::kStatic) {
+    AdaptiveRateConfig adaptive;
+    adaptive.enabled = true;
+    camera.SetAdaptiveFrameRate(adaptive);
+    camera.SetAppHidden(scenario == Scenario::kHidden);
+  }
+
+  // Let the pipeline settle (and the static scene go idle), then start the
+  // measurement window.
+  RunFor(1000 + (scenario == Scenario::kStatic ? 1000 : 0));
+  fl_value_unref(camera.GetStats());
+  bench_texture_registrar_take_stats(registrar_);
+  bench_messenger_reset_outgoing(messenger_);
+
+  StreamConsumer consumer;
+  std::vector<double> round_trips;
+  double record_start_ms = 0;
+  double record_stop_ms = 0;
+  double max_queue_ms = 0;
+  std::string record_path;
+
+  double cpu_start = ProcessCpuSeconds();
+  gint64 wall_start = g_get_monotonic_time();
+  int window_ms = opt_.seconds * 1000;
+
+  switch (scenario) {
+    case Scenario::kPreview:
+    case Scenario::kHidden:
+    case Scenario::kStatic:
+      RunFor(window_ms);
+      break;
+
+    case Scenario::kStream:
+    case Scenario::kHighFps:
+      if (!opt_.legacy_stream) {
+        g_stream_consumer = &consumer;
+        consumer.Start(&camera);
+        camera.RegisterImageStreamCallback(OnStreamFrame);
+      }
+      camera.StartImageStream();
+      RunFor(window_ms);
+      camera.StopImageStream();
+      camera.UnregisterImageStreamCallback();
+      break;
+
+    case Scenario::kPhoto:
+      for (int i = 0; i < opt_.photos &&
+                      g_get_monotonic_time() - wall_start < window_ms * 1000;
+           i++) {
+        FlValue* path = nullptr;
+        double ms = CallAndWait(messenger_, kChannelName, "takePicture",
+                                nullptr, 10000, &error, &path);
+        if (ms < 0) {
+          fprintf(stderr, "photo: %s\n", error.c_str());
+          break;
+        }
+        round_trips.push_back(ms);
+        if (path) {
+          if (fl_value_get_type(path) == FL_VALUE_TYPE_STRING) {
+            g_unlink(fl_value_get_string(path));
+          }
+          fl_value_unref(path);
+        }
+      }
+      break;
+
+    case Scenario::kRecord: {
+      record_start_ms =
+          CallAndWait(messenger_, kChannelName, "startVideoRecording",
+                      nullptr, 10000, &error);
+      if (record_start_ms < 0) {
+        fprintf(stderr, "record: start failed: %s\n", error.c_str());
+        break;
+      }
+      // Sample the encoder backlog while recording.
+      gint64 end_us = g_get_monotonic_time() + (gint64)window_ms * 1000;
+      while (g_get_monotonic_time() < end_us) {
+        RunFor(250);
+        g_autoptr(FlValue) stats = camera.GetStats();
+        max_queue_ms = std::max(max_queue_ms,
+                                LookupFloat(stats, "encoderQueueMs"));
+      }
+      FlValue* path = nullptr;
+      record_stop_ms =
+          CallAndWait(messenger_, kChannelName, "stopVideoRecording",
+                      nullptr, 10000, &error, &path);
+      if (record_stop_ms < 0) {
+        fprintf(stderr, "record: stop failed: %s\n", error.c_str());
+      }
+      if (path) {
+        if (fl_value_get_type(path) == FL_VALUE_TYPE_STRING) {
+          record_path = fl_value_get_string(path);
+        }
+        fl_value_unref(path);
+      }
+      break;
+    }
+  }
+
+  double wall = (g_get_monotonic_time() - wall_start) / 1e6;
+  double cpu_used = ProcessCpuSeconds() - cpu_start;
+  g_autoptr(FlValue) stats = camera.GetStats();
+  consumer.Stop();
+  g_stream_consumer = nullptr;
+
+  result->capture_fps = LookupFloat(stats, "captureFps");
+  result->preview_fps = LookupFloat(stats, "previewFps");
+  result->cpu_percent = 100.0 * cpu_used / wall;
+  double frames_in_window = result->capture_fps * wall;
+  result->cpu_us_per_frame =
+      frames_in_window > 0 ? cpu_used * 1e6 / frames_in_window : 0.0;
+
+  double frame_bytes =
+      (double)config.target_width * config.target_height * 4;
+  double copy_mean_us = HistogramValue(stats, "copyTime", "meanUs");
+  result->copy_mb_s = copy_mean_us > 0 ? frame_bytes / copy_mean_us : 0.0;
+  RasterStats raster = bench_texture_registrar_take_stats(registrar_);
+  double raster_ms = 0;
+  for (double ms : raster.copy_ms) raster_ms += ms;
+  result->raster_mb_s = raster_ms > 0 ? raster.bytes / (raster_ms * 1e3) : 0.0;
+
+  switch (scenario) {
+    case Scenario::kHidden:
+    case Scenario::kStatic:
+      result->extra =
+          Format("idle %s, %" G_GINT64_FORMAT " frames skipped",
+                 fl_value_get_bool(fl_value_lookup_string(stats,
+                                                          "adaptiveIdle"))
+                     ? "yes"
+                     : "no",
+                 (gint64)LookupFloat(stats, "framesIdleSkipped"));
+      // Fall through: same latency metric as preview.
+    case Scenario::kPreview:
+      result->metric = "capture->texture";
+      result->p50_ms =
+          HistogramValue(stats, "captureToTextureLatency", "p50Us") / 1e3;
+      result->p99_ms =
+          HistogramValue(stats, "captureToTextureLatency", "p99Us") / 1e3;
+      break;
+
+    case Scenario::kStream:
+      if (opt_.legacy_stream) {
+        // No timestamp travels with a channel message; report the delivery
+        // interval to the (stub) Dart side instead.
+        OutgoingChannelStats out =
+            bench_messenger_take_outgoing(messenger_, "imageStreamFrame");
+        result->metric = "channel interval";
+        result->p50_ms = Percentile(out.interval_ms, 0.5);
+        result->p99_ms = Percentile(out.interval_ms, 0.99);
+        result->extra = Format("delivered %.1f fps, %.1f MB/s",
+                               out.messages / wall, out.bytes / wall / 1e6);
+      } else {
+        std::lock_guard<std::mutex> lk(consumer.stats_mutex);
+        result->metric = "publish->read";
+        result->p50_ms = Percentile(consumer.latency_ms, 0.5);
+        result->p99_ms = Percentile(consumer.latency_ms, 0.99);
+        result->extra =
+            Format("read %.1f fps, %.1f MB/s, skipped %" G_GINT64_FORMAT,
+                   consumer.frames / wall, consumer.bytes / wall / 1e6,
+                   (gint64)LookupFloat(stats, "framesStreamSkipped"));
+      }
+      break;
+
+    case Scenario::kHighFps: {
+      result->metric = "capture->texture";
+      result->p50_ms =
+          HistogramValue(stats, "captureToTextureLatency", "p50Us") / 1e3;
+      result->p99_ms =
+          HistogramValue(stats, "captureToTextureLatency", "p99Us") / 1e3;
+      std::lock_guard<std::mutex> lk(consumer.stats_mutex);
+      result->extra = Format(
+          "appsink dropped %" G_GINT64_FORMAT ", preview decimated %"
+          G_GINT64_FORMAT ", streamed %" G_GINT64_FORMAT
+          ", read %.1f fps, skipped %" G_GINT64_FORMAT,
+          (gint64)LookupFloat(stats, "framesAppsinkDropped"),
+          (gint64)LookupFloat(stats, "framesPreviewDecimated"),
+          (gint64)LookupFloat(stats, "framesStreamed"),
+          consumer.frames / wall,
+          (gint64)LookupFloat(stats, "framesStreamSkipped"));
+      break;
+    }
+
+    case Scenario::kPhoto:
+      result->metric = "takePicture";
+      result->p50_ms = Percentile(round_trips, 0.5);
+      result->p99_ms = Percentile(round_trips, 0.99);
+      result->extra = Format("%zu photos", round_trips.size());
+      break;
+
+    case Scenario::kRecord: {
+      result->metric = "capture->texture";
+      result->p50_ms =
+          HistogramValue(stats, "captureToTextureLatency", "p50Us") / 1e3;
+      result->p99_ms =
+          HistogramValue(stats, "captureToTextureLatency", "p99Us") / 1e3;
+      GStatBuf st;
+      double file_mb = 0;
+      if (!record_path.empty() && g_stat(record_path.c_str(), &st) == 0) {
+        file_mb = st.st_size / 1e6;
+        g_unlink(record_path.c_str());
+      }
+      result->extra = Format(
+          "start %.1f ms, stop %.1f ms, enc queue max %.0f ms, %.2f MB "
+          "(%.2f Mbit/s)",
+          record_start_ms, record_stop_ms, max_queue_ms, file_mb,
+          file_mb * 8 / opt_.seconds);
+      break;
+    }
+  }
+
+  camera.Dispose();
+  camera_ = nullptr;
+  // Let the closing event and any late idle callbacks drain.
+  RunFor(100);
+  return true;
+}
+
+bool ParseOptions(int argc, char** argv, Options* opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (sscanf(arg, "--width=%d", &opt->width) == 1) continue;
+    if (sscanf(arg, "--height=%d", &opt->height) == 1) continue;
+    if (sscanf(arg, "--fps=%d", &opt->fps) == 1) continue;
+    if (sscanf(arg, "--seconds=%d", &opt->seconds) == 1) continue;
+    if (sscanf(arg, "--photos=%d", &opt->photos) == 1) continue;
+    if (strncmp(arg, "--source=", 9) == 0) {
+      opt->source = arg + 9;
+      continue;
+    }
+    if (strncmp(arg, "--file=", 7) == 0) {
+      gchar* path = g_canonicalize_filename(arg + 7, nullptr);
+      gchar* uri = g_filename_to_uri(path, nullptr, nullptr);
+      opt->source = uri ? uri : "";
+      g_free(uri);
+      g_free(path);
+      continue;
+    }
+    if (strcmp(arg, "--legacy-stream") == 0) {
+      opt->legacy_stream = true;
+      continue;
+    }
+    if (strncmp(arg, "--scenarios=", 12) == 0) {
+      opt->scenarios.clear();
+      gchar** parts = g_strsplit(arg + 12, ",", -1);
+      bool ok = true;
+      for (gchar** p = parts; *p; p++) {
+        if (strcmp(*p, "preview") == 0) {
+          opt->scenarios.push_back(Scenario::kPreview);
+        } else if (strcmp(*p, "stream") == 0) {
+          opt->scenarios.push_back(Scenario::kStream);
+        } else if (strcmp(*p, "photo") == 0) {
+          opt->scenarios.push_back(Scenario::kPhoto);
+        } else if (strcmp(*p, "record") == 0) {
+          opt->scenarios.push_back(Scenario::kRecord);
+        } else if (strcmp(*p, "hidden") == 0) {
+          opt->scenarios.push_back(Scenario::kHidden);
+        } else if (strcmp(*p, "static") == 0) {
+          opt->scenarios.push_back(Scenario::kStatic);
+        } else if (strcmp(*p, "highfps") == 0) {
+          opt->scenarios.push_back(Scenario::kHighFps);
+        } else {
+          fprintf(stderr, "Unknown scenario: %s\n", *p);
+          ok = false;
+        }
+      }
+      g_strfreev(parts);
+      if (!ok) return false;
+      continue;
+    }
+    fprintf(stderr, "Unknown option: %s\n", arg);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+
+  Options opt;
+  if (!ParseOptions(argc, argv, &opt)) return 1;
+
+  printf("# %dx%d @ %d fps from %s, %d s per scenario, %ld CPUs\n", opt.width,
+         opt.height, opt.fps, opt.source.c_str(), opt.seconds,
+         sysconf(_SC_NPROCESSORS_ONLN));
+  printf("%-8s %8s %8s %8s %7s %9s %9s %10s %8s %8s  %s\n", "scenario",
+         "init_ms", "cap_fps", "prv_fps", "cpu_%", "cpu_us/f", "copy_MB/s",
+         "raster_MB/s", "p50_ms", "p99_ms", "latency / notes");
+
+  Harness harness(opt);
+  int failures = 0;
+  for (Scenario scenario : opt.scenarios) {
+    ScenarioResult r;
+    if (!harness.Run(scenario, &r)) {
+      failures++;
+      continue;
+    }
+    printf("%-8s %8.1f %8.2f %8.2f %7.1f %9.1f %9.0f %10.0f %8.2f %8.2f"
+           "  %s%s%s\n",
+           ScenarioName(scenario), r.init_ms, r.capture_fps, r.preview_fps,
+           r.cpu_percent, r.cpu_us_per_frame, r.copy_mb_s, r.raster_mb_s,
+           r.p50_ms, r.p99_ms, r.metric.c_str(), r.extra.empty() ? "" : "; ",
+           r.extra.c_str());
+    fflush(stdout);
+  }
+  return failures == 0 ? 0 : 1;
+}
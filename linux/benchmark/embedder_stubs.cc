@@ -0,0 +1,513 @@
+#include "embedder_stubs.h"
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+
+// --- Texture registrar ---
+
+struct RasterState {
+  GThread* thread = nullptr;
+
+  // |pending| and |stop| are guarded by |cond_mutex|.
+  GMutex cond_mutex;
+  GCond cond;
+  FlTexture* pending = nullptr;  // Holds a ref.
+  bool stop = false;
+
+  std::vector<uint8_t> upload;  // Raster thread only.
+
+  // Measurements, guarded by |mutex|.
+  std::mutex mutex;
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  std::vector<double> copy_ms;
+};
+
+struct _BenchTextureRegistrar {
+  GObject parent_instance;
+  RasterState* raster;
+  std::map<int64_t, FlTexture*>* textures;  // Hold refs.
+};
+
+static void bench_texture_registrar_iface_init(
+    FlTextureRegistrarInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(
+    BenchTextureRegistrar, bench_texture_registrar, G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE(fl_texture_registrar_get_type(),
+                          bench_texture_registrar_iface_init))
+
+static gpointer raster_thread_func(gpointer data) {
+  auto* raster = static_cast<RasterState*>(data);
+  while (true) {
+    g_mutex_lock(&raster->cond_mutex);
+    while (!raster->pending && !raster->stop) {
+      g_cond_wait(&raster->cond, &raster->cond_mutex);
+    }
+    FlTexture* texture = raster->pending;
+    raster->pending = nullptr;
+    bool stop = raster->stop;
+    g_mutex_unlock(&raster->cond_mutex);
+    if (stop) {
+      if (texture) g_object_unref(texture);
+      return nullptr;
+    }
+
+    FlPixelBufferTexture* pixel_texture = FL_PIXEL_BUFFER_TEXTURE(texture);
+    const uint8_t* buffer = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    gint64 start_us = g_get_monotonic_time();
+    if (FL_PIXEL_BUFFER_TEXTURE_GET_CLASS(pixel_texture)
+            ->copy_pixels(pixel_texture, &buffer, &width, &height, nullptr)) {
+      size_t size = (size_t)width * height * 4;
+      raster->upload.resize(size);
+      memcpy(raster->upload.data(), buffer, size);
+      double ms = (g_get_monotonic_time() - start_us) / 1e3;
+      std::lock_guard<std::mutex> lk(raster->mutex);
+      raster->frames++;
+      raster->bytes += size;
+      raster->copy_ms.push_back(ms);
+    }
+    g_object_unref(texture);
+  }
+}
+
+static gboolean bench_texture_registrar_register_texture(
+    FlTextureRegistrar* registrar, FlTexture* texture) {
+  auto* self = BENCH_TEXTURE_REGISTRAR(registrar);
+  (*self->textures)[fl_texture_get_id(texture)] =
+      FL_TEXTURE(g_object_ref(texture));
+  return TRUE;
+}
+
+static FlTexture* bench_texture_registrar_lookup_texture(
+    FlTextureRegistrar* registrar, int64_t id) {
+  auto* self = BENCH_TEXTURE_REGISTRAR(registrar);
+  auto it = self->textures->find(id);
+  return it != self->textures->end() ? it->second : nullptr;
+}
+
+static gboolean bench_texture_registrar_mark_texture_frame_available(
+    FlTextureRegistrar* registrar, FlTexture* texture) {
+  RasterState* raster = BENCH_TEXTURE_REGISTRAR(registrar)->raster;
+  g_mutex_lock(&raster->cond_mutex);
+  if (!raster->pending) {
+    raster->pending = FL_TEXTURE(g_object_ref(texture));
+    g_cond_signal(&raster->cond);
+  }
+  g_mutex_unlock(&raster->cond_mutex);
+  return TRUE;
+}
+
+static gboolean bench_texture_registrar_unregister_texture(
+    FlTextureRegistrar* registrar, FlTexture* texture) {
+  auto* self = BENCH_TEXTURE_REGISTRAR(registrar);
+  auto it = self->textures->find(fl_texture_get_id(texture));
+  if (it == self->textures->end()) return FALSE;
+  g_object_unref(it->second);
+  self->textures->erase(it);
+  return TRUE;
+}
+
+static void bench_texture_registrar_shutdown(FlTextureRegistrar* registrar) {}
+
+static void bench_texture_registrar_iface_init(
+    FlTextureRegistrarInterface* iface) {
+  iface->register_texture = bench_texture_registrar_register_texture;
+  iface->lookup_texture = bench_texture_registrar_lookup_texture;
+  iface->mark_texture_frame_available =
+      bench_texture_registrar_mark_texture_frame_available;
+  iface->unregister_texture = bench_texture_registrar_unregister_texture;
+  iface->shutdown = bench_texture_registrar_shutdown;
+}
+
+static void bench_texture_registrar_dispose(GObject* object) {
+  auto* self = BENCH_TEXTURE_REGISTRAR(object);
+  if (self->raster) {
+    g_mutex_lock(&self->raster->cond_mutex);
+    self->raster->stop = true;
+    g_cond_signal(&self->raster->cond);
+    g_mutex_unlock(&self->raster->cond_mutex);
+    g_thread_join(self->raster->thread);
+    if (self->raster->pending) g_object_unref(self->raster->pending);
+    g_cond_clear(&self->raster->cond);
+    g_mutex_clear(&self->raster->cond_mutex);
+    delete self->raster;
+    self->raster = nullptr;
+  }
+  if (self->textures) {
+    for (auto& entry : *self->textures) g_object_unref(entry.second);
+    delete self->textures;
+    self->textures = nullptr;
+  }
+  G_OBJECT_CLASS(bench_texture_registrar_parent_class)->dispose(object);
+}
+
+static void bench_texture_registrar_class_init(
+    BenchTextureRegistrarClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = bench_texture_registrar_dispose;
+}
+
+static void bench_texture_registrar_init(BenchTextureRegistrar* self) {
+  self->textures = new std::map<int64_t, FlTexture*>();
+  self->raster = new RasterState();
+  g_cond_init(&self->raster->cond);
+  g_mutex_init(&self->raster->cond_mutex);
+  self->raster->thread =
+      g_thread_new("bench-raster", raster_thread_func, self->raster);
+}
+
+BenchTextureRegistrar* bench_texture_registrar_new() {
+  return BENCH_TEXTURE_REGISTRAR(
+      g_object_new(bench_texture_registrar_get_type(), nullptr));
+}
+
+RasterStats bench_texture_registrar_take_stats(BenchTextureRegistrar* self) {
+  RasterState* raster = self->raster;
+  std::lock_guard<std::mutex> lk(raster->mutex);
+  RasterStats stats;
+  stats.frames = raster->frames;
+  stats.bytes = raster->bytes;
+  stats.copy_ms.swap(raster->copy_ms);
+  raster->frames = 0;
+  raster->bytes = 0;
+  return stats;
+}
+
+// --- Binary messenger ---
+
+G_DECLARE_FINAL_TYPE(BenchResponseHandle, bench_response_handle, BENCH,
+                     RESPONSE_HANDLE, FlBinaryMessengerResponseHandle)
+
+struct _BenchResponseHandle {
+  FlBinaryMessengerResponseHandle parent_instance;
+};
+
+G_DEFINE_TYPE(BenchResponseHandle, bench_response_handle,
+              fl_binary_messenger_response_handle_get_type())
+
+static void bench_response_handle_class_init(BenchResponseHandleClass* klass) {
+}
+
+static void bench_response_handle_init(BenchResponseHandle* self) {}
+
+struct MessengerState {
+  struct Handler {
+    FlBinaryMessengerMessageHandler handler = nullptr;
+    gpointer user_data = nullptr;
+    GDestroyNotify destroy = nullptr;
+  };
+  std::map<std::string, Handler> handlers;
+  std::map<FlBinaryMessengerResponseHandle*, ResponseCallback> pending;
+  std::map<std::string, OutgoingChannelStats> outgoing;  // By method name.
+  FlStandardMessageCodec* codec = fl_standard_message_codec_new();
+};
+
+struct _BenchMessenger {
+  GObject parent_instance;
+  MessengerState* state;
+};
+
+static void bench_messenger_iface_init(FlBinaryMessengerInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(BenchMessenger, bench_messenger, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(fl_binary_messenger_get_type(),
+                                              bench_messenger_iface_init))
+
+static void bench_messenger_set_message_handler_on_channel(
+    FlBinaryMessenger* messenger, const gchar* channel,
+    FlBinaryMessengerMessageHandler handler, gpointer user_data,
+    GDestroyNotify destroy_notify) {
+  MessengerState* state = BENCH_MESSENGER(messenger)->state;
+  auto it = state->handlers.find(channel);
+  if (it != state->handlers.end()) {
+    if (it->second.destroy) it->second.destroy(it->second.user_data);
+    state->handlers.erase(it);
+  }
+  if (handler) {
+    state->handlers[channel] = {handler, user_data, destroy_notify};
+  }
+}
+
+static gboolean bench_messenger_send_response(
+    FlBinaryMessenger* messenger, FlBinaryMessengerResponseHandle* handle,
+    GBytes* response, GError** error) {
+  MessengerState* state = BENCH_MESSENGER(messenger)->state;
+  auto it = state->pending.find(handle);
+  if (it == state->pending.end()) return TRUE;
+  ResponseCallback callback = std::move(it->second);
+  state->pending.erase(it);
+
+  // Standard method codec envelope: 0 + result, or 1 + code, message,
+  // details.
+  CallResult result;
+  gsize size = 0;
+  const uint8_t* data =
+      static_cast<const uint8_t*>(g_bytes_get_data(response, &size));
+  size_t offset = 1;
+  FlValue* value = nullptr;
+  if (size > 0 &&
+      fl_standard_message_codec_read_value(state->codec, response, &offset,
+                                           &value, nullptr)) {
+    if (data[0] == 0) {
+      result.success = true;
+      result.value = value;
+    } else {
+      if (fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+        result.error = fl_value_get_string(value);
+      }
+      fl_value_unref(value);
+    }
+  }
+  callback(result);
+  if (result.value) fl_value_unref(result.value);
+  g_object_unref(handle);
+  return TRUE;
+}
+
+static void bench_messenger_send_on_channel(FlBinaryMessenger* messenger,
+                                            const gchar* channel,
+                                            GBytes* message,
+                                            GCancellable* cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data) {
+  MessengerState* state = BENCH_MESSENGER(messenger)->state;
+  // A method call is the method name followed by the arguments.
+  size_t offset = 0;
+  FlValue* name = nullptr;
+  std::string method = "?";
+  if (message && fl_standard_message_codec_read_value(
+                     state->codec, message, &offset, &name, nullptr)) {
+    if (fl_value_get_type(name) == FL_VALUE_TYPE_STRING) {
+      method = fl_value_get_string(name);
+    }
+    fl_value_unref(name);
+  }
+  OutgoingChannelStats& stats = state->outgoing[method];
+  gint64 now_us = g_get_monotonic_time();
+  if (stats.last_us > 0) {
+    stats.interval_ms.push_back((now_us - stats.last_us) / 1e3);
+  }
+  stats.last_us = now_us;
+  stats.messages++;
+  stats.bytes += message ? g_bytes_get_size(message) : 0;
+
+  if (callback) {
+    // Dart's handlers return null.
+    static const uint8_t kNullSuccess[] = {0, 0};
+    GTask* task = g_task_new(messenger, cancellable, callback, user_data);
+    g_task_return_pointer(task,
+                          g_bytes_new_static(kNullSuccess,
+                                             sizeof(kNullSuccess)),
+                          reinterpret_cast<GDestroyNotify>(g_bytes_unref));
+    g_object_unref(task);
+  }
+}
+
+static GBytes* bench_messenger_send_on_channel_finish(
+    FlBinaryMessenger* messenger, GAsyncResult* result, GError** error) {
+  return static_cast<GBytes*>(
+      g_task_propagate_pointer(G_TASK(result), error));
+}
+
+static void bench_messenger_resize_channel(FlBinaryMessenger* messenger,
+                                           const gchar* channel,
+                                           int64_t new_size) {}
+
+static void bench_messenger_set_warns_on_channel_overflow(
+    FlBinaryMessenger* messenger, const gchar* channel, bool warns) {}
+
+static void bench_messenger_shutdown(FlBinaryMessenger* messenger) {}
+
+static void bench_messenger_iface_init(FlBinaryMessengerInterface* iface) {
+  iface->set_message_handler_on_channel =
+      bench_messenger_set_message_handler_on_channel;
+  iface->send_response = bench_messenger_send_response;
+  iface->send_on_channel = bench_messenger_send_on_channel;
+  iface->send_on_channel_finish = bench_messenger_send_on_channel_finish;
+  iface->resize_channel = bench_messenger_resize_channel;
+  iface->set_warns_on_channel_overflow =
+      bench_messenger_set_warns_on_channel_overflow;
+  iface->shutdown = bench_messenger_shutdown;
+}
+
+static void bench_messenger_dispose(GObject* object) {
+  auto* self = BENCH_MESSENGER(object);
+  if (self->state) {
+    for (auto& entry : self->state->handlers) {
+      if (entry.second.destroy) entry.second.destroy(entry.second.user_data);
+    }
+    for (auto& entry : self->state->pending) g_object_unref(entry.first);
+    g_object_unref(self->state->codec);
+    delete self->state;
+    self->state = nullptr;
+  }
+  G_OBJECT_CLASS(bench_messenger_parent_class)->dispose(object);
+}
+
+static void bench_messenger_class_init(BenchMessengerClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = bench_messenger_dispose;
+}
+
+static void bench_messenger_init(BenchMessenger* self) {
+  self->state = new MessengerState();
+}
+
+BenchMessenger* bench_messenger_new() {
+  return BENCH_MESSENGER(g_object_new(bench_messenger_get_type(), nullptr));
+}
+
+void bench_messenger_call(BenchMessenger* self, const char* channel,
+                          const char* method, FlValue* args,
+                          ResponseCallback callback) {
+  MessengerState* state = self->state;
+  auto it = state->handlers.find(channel);
+  if (it == state->handlers.end()) {
+    CallResult result;
+    result.error = "no_handler";
+    callback(result);
+    return;
+  }
+
+  GByteArray* buffer = g_byte_array_new();
+  g_autoptr(FlValue) name = fl_value_new_string(method);
+  g_autoptr(FlValue) null_args = fl_value_new_null();
+  fl_standard_message_codec_write_value(state->codec, buffer, name, nullptr);
+  fl_standard_message_codec_write_value(state->codec, buffer,
+                                        args ? args : null_args, nullptr);
+  g_autoptr(GBytes) message = g_byte_array_free_to_bytes(buffer);
+
+  auto* handle = FL_BINARY_MESSENGER_RESPONSE_HANDLE(
+      g_object_new(bench_response_handle_get_type(), nullptr));
+  state->pending[handle] = std::move(callback);
+  it->second.handler(FL_BINARY_MESSENGER(self), channel, message, handle,
+                     it->second.user_data);
+}
+
+OutgoingChannelStats bench_messenger_take_outgoing(BenchMessenger* self,
+                                                   const char* method) {
+  auto it = self->state->outgoing.find(method);
+  if (it == self->state->outgoing.end()) return OutgoingChannelStats();
+  OutgoingChannelStats stats = std::move(it->second);
+  self->state->outgoing.erase(it);
+  return stats;
+}
+
+void bench_messenger_reset_outgoing(BenchMessenger* self) {
+  self->state->outgoing.clear();
+}
+
+// --- Plugin registrar ---
+
+struct _BenchPluginRegistrar {
+  GObject parent_instance;
+  BenchMessenger* messenger;                 // Holds a ref.
+  BenchTextureRegistrar* texture_registrar;  // Holds a ref.
+};
+
+static void bench_plugin_registrar_iface_init(
+    FlPluginRegistrarInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(
+    BenchPluginRegistrar, bench_plugin_registrar, G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE(fl_plugin_registrar_get_type(),
+                          bench_plugin_registrar_iface_init))
+
+static FlBinaryMessenger* bench_plugin_registrar_get_messenger(
+    FlPluginRegistrar* registrar) {
+  return FL_BINARY_MESSENGER(BENCH_PLUGIN_REGISTRAR(registrar)->messenger);
+}
+
+static FlTextureRegistrar* bench_plugin_registrar_get_texture_registrar(
+    FlPluginRegistrar* registrar) {
+  return FL_TEXTURE_REGISTRAR(
+      BENCH_PLUGIN_REGISTRAR(registrar)->texture_registrar);
+}
+
+static FlView* bench_plugin_registrar_get_view(FlPluginRegistrar* registrar) {
+  return nullptr;
+}
+
+static void bench_plugin_registrar_iface_init(
+    FlPluginRegistrarInterface* iface) {
+  iface->get_messenger = bench_plugin_registrar_get_messenger;
+  iface->get_texture_registrar = bench_plugin_registrar_get_texture_registrar;
+  iface->get_view = bench_plugin_registrar_get_view;
+}
+
+static void bench_plugin_registrar_dispose(GObject* object) {
+  auto* self = BENCH_PLUGIN_REGISTRAR(object);
+  g_clear_object(&self->messenger);
+  g_clear_object(&self->texture_registrar);
+  G_OBJECT_CLASS(bench_plugin_registrar_parent_class)->dispose(object);
+}
+
+static void bench_plugin_registrar_class_init(
+    BenchPluginRegistrarClass* klass) {
+  G_OBJECT_CLASS(klass)->dispose = bench_plugin_registrar_dispose;
+}
+
+static void bench_plugin_registrar_init(BenchPluginRegistrar* self) {}
+
+BenchPluginRegistrar* bench_plugin_registrar_new(
+    BenchMessenger* messenger, BenchTextureRegistrar* texture_registrar) {
+  auto* self = BENCH_PLUGIN_REGISTRAR(
+      g_object_new(bench_plugin_registrar_get_type(), nullptr));
+  self->messenger = BENCH_MESSENGER(g_object_ref(messenger));
+  self->texture_registrar =
+      BENCH_TEXTURE_REGISTRAR(g_object_ref(texture_registrar));
+  return self;
+}
+
+// --- Main loop helpers ---
+
+bool RunUntil(const std::function<bool()>& done, int timeout_ms) {
+  gint64 deadline = g_get_monotonic_time() + (gint64)timeout_ms * 1000;
+  // Wakes the blocking iteration so the deadline is honoured.
+  guint tick = g_timeout_add(
+      10, [](gpointer) -> gboolean { return G_SOURCE_CONTINUE; }, nullptr);
+  while (!done() && g_get_monotonic_time() < deadline) {
+    g_main_context_iteration(nullptr, TRUE);
+  }
+  g_source_remove(tick);
+  return done();
+}
+
+void RunFor(int ms) {
+  RunUntil([] { return false; }, ms);
+}
+
+double CallAndWait(BenchMessenger* messenger, const char* channel,
+                   const char* method, FlValue* args, int timeout_ms,
+                   std::string* error, FlValue** result_out) {
+  bool done = false;
+  bool success = false;
+  gint64 start_us = g_get_monotonic_time();
+  gint64 end_us = 0;
+  bench_messenger_call(
+      messenger, channel, method, args, [&](const CallResult& result) {
+        done = true;
+        success = result.success;
+        end_us = g_get_monotonic_time();
+        if (!success && error) *error = result.error;
+        if (success && result_out && result.value) {
+          *result_out = fl_value_ref(result.value);
+        }
+      });
+  if (!RunUntil([&] { return done; }, timeout_ms)) {
+    if (error) *error = "timeout";
+    return -1;
+  }
+  return success ? (end_us - start_us) / 1e3 : -1;
+}
+
+double LookupFloat(FlValue* map, const char* key) {
+  FlValue* v = fl_value_lookup_string(map, key);
+  if (!v) return 0.0;
+  if (fl_value_get_type(v) == FL_VALUE_TYPE_FLOAT) return fl_value_get_float(v);
+  if (fl_value_get_type(v) == FL_VALUE_TYPE_INT) return fl_value_get_int(v);
+  return 0.0;
+}
@@ -0,0 +1,91 @@
+#ifndef EMBEDDER_STUBS_H_
+#define EMBEDDER_STUBS_H_
+
+// Stand-ins for the Flutter embedder objects the plugin talks to, so the
+// real backend can run headlessly in the benchmarks. Written against the
+// GInterface-based registrar and messenger APIs of current Flutter releases.
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Texture registrar with a stand-in raster thread: a frame marked available
+// is pulled through FlPixelBufferTexture::copy_pixels and read once, the way
+// the engine's GL upload does. Frames marked while a copy is in progress
+// coalesce, as they do in the engine.
+G_DECLARE_FINAL_TYPE(BenchTextureRegistrar, bench_texture_registrar, BENCH,
+                     TEXTURE_REGISTRAR, GObject)
+
+BenchTextureRegistrar* bench_texture_registrar_new();
+
+struct RasterStats {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  std::vector<double> copy_ms;  // copy_pixels plus the read, per frame.
+};
+
+// Returns the raster thread's measurements since the previous call.
+RasterStats bench_texture_registrar_take_stats(BenchTextureRegistrar* self);
+
+// Binary messenger that delivers method calls to the registered channel
+// handlers as Dart would and decodes their responses. Messages the plugin
+// sends to Dart are counted per method.
+G_DECLARE_FINAL_TYPE(BenchMessenger, bench_messenger, BENCH, MESSENGER,
+                     GObject)
+
+BenchMessenger* bench_messenger_new();
+
+// A method call response: the decoded result, or the error code.
+struct CallResult {
+  bool success = false;
+  std::string error;
+  FlValue* value = nullptr;  // Owned; null for errors.
+};
+
+using ResponseCallback = std::function<void(const CallResult&)>;
+
+// Outgoing traffic from the plugin (events Dart would receive).
+struct OutgoingChannelStats {
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  gint64 last_us = 0;
+  std::vector<double> interval_ms;
+};
+
+// Delivers |method| to |channel|'s handler, calling |callback| with the
+// decoded response.
+void bench_messenger_call(BenchMessenger* self, const char* channel,
+                          const char* method, FlValue* args,
+                          ResponseCallback callback);
+
+// Returns the traffic for |method| since the previous call (or reset).
+OutgoingChannelStats bench_messenger_take_outgoing(BenchMessenger* self,
+                                                   const char* method);
+void bench_messenger_reset_outgoing(BenchMessenger* self);
+
+// Plugin registrar handing out the stubs above; there is no view.
+G_DECLARE_FINAL_TYPE(BenchPluginRegistrar, bench_plugin_registrar, BENCH,
+                     PLUGIN_REGISTRAR, GObject)
+
+BenchPluginRegistrar* bench_plugin_registrar_new(
+    BenchMessenger* messenger, BenchTextureRegistrar* texture_registrar);
+
+// Runs the default main context until |done| returns true or |timeout_ms|
+// passes. Returns whether |done| was satisfied.
+bool RunUntil(const std::function<bool()>& done, int timeout_ms);
+void RunFor(int ms);
+
+// Calls |method| on |channel| and waits for the response. Returns the round
+// trip in ms, or -1 on error/timeout. |result_out| receives a ref to the
+// result value.
+double CallAndWait(BenchMessenger* messenger, const char* channel,
+                   const char* method, FlValue* args, int timeout_ms,
+                   std::string* error, FlValue** result_out = nullptr);
+
+// Numeric map entry as a double; 0 when missing.
+double LookupFloat(FlValue* map, const char* key);
+
+#endif  // EMBEDDER_STUBS_H_
@@ -0,0 +1,274 @@
+// Microbenchmarks for the per-frame hot paths of Camera::OnNewSample.
+//
+// Every benchmark runs at 320x240, 640x480, 1280x720, 1920x1080 and
+// 3840x2160, with the source either tightly packed (padded=0) or with padded
+// rows (padded=1, as V4L2 drivers with bytesperline alignment deliver them):
+//
+//   BM_StrideRepack      - CopyFrameRows, the repack every path shares.
+//   BM_TextureUpdate     - the preview path: repack into a temporary when
+//                          padded, then camera_texture_update, while another
+//                          thread keeps pulling frames through copy_pixels
+//                          like the raster thread.
+//   BM_FfiPublish        - PublishImageStreamFrame into the shared buffer.
+//   BM_LegacyStreamFrame - the method-channel fallback: a buffer from the
+//                          frame allocator, repack, and the FlValue the main
+//                          thread builds.
+//   BM_FrameChange       - FrameChangeDetector::Difference, the static-frame
+//                          check that can skip all of the above.
+//   BM_CopyUnderLoad     - frame copies at 1080p and 4K, with memcpy
+//                          (streaming=0) or streaming stores (streaming=1),
+//                          while another thread walks a cache-resident
+//                          working set the way an inference thread does;
+//                          victim_hops is that thread's throughput.
+//
+// Copies of kStreamingCopyThreshold bytes or more use streaming stores in
+// every benchmark, as they do in the plugin; StreamingCopyKernel() names the
+// kernel in the benchmark context.
+//
+// Usage:
+//   camera_desktop_hot_path_benchmark [--benchmark_filter=Texture]
+//       [--benchmark_format=json]
+
+#include <benchmark/benchmark.h>
+#include <flutter_linux/flutter_linux.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "camera_texture.h"
+#include "frame_allocator.h"
+#include "frame_change.h"
+#include "frame_copy.h"
+
+namespace {
+
+// Extra bytes per row in the padded case. Not a multiple of 64, so padded
+// rows also start misaligned, as they do behind odd bytesperline values.
+const size_t kRowPadding = 96;
+
+struct Frame {
+  int width;
+  int height;
+  size_t stride;
+  std::vector<uint8_t> data;
+
+  Frame(int w, int h, bool padded)
+      : width(w),
+        height(h),
+        stride((size_t)w * 4 + (padded ? kRowPadding : 0)),
+        data(stride * h) {
+    for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)(i * 31);
+  }
+
+  size_t row_bytes() const { return (size_t)width * 4; }
+  size_t tight_size() const { return row_bytes() * height; }
+};
+
+Frame MakeFrame(const benchmark::State& state) {
+  return Frame((int)state.range(0), (int)state.range(1), state.range(2) != 0);
+}
+
+void FrameSizes(benchmark::internal::Benchmark* b) {
+  static const int kSizes[][2] = {
+      {320, 240}, {640, 480}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+  b->ArgNames({"w", "h", "padded"});
+  for (const auto& size : kSizes) {
+    for (int padded = 0; padded <= 1; padded++) {
+      b->Args({size[0], size[1], padded});
+    }
+  }
+}
+
+void SetFrameCounters(benchmark::State& state, const Frame& frame) {
+  state.SetBytesProcessed((int64_t)state.iterations() * frame.tight_size());
+  state.SetItemsProcessed(state.iterations());  // Frames.
+}
+
+void BM_StrideRepack(benchmark::State& state) {
+  Frame frame = MakeFrame(state);
+  std::vector<uint8_t> dst(frame.tight_size());
+  for (auto _ : state) {
+    CopyFrameRows(dst.data(), frame.data.data(), frame.row_bytes(),
+                  frame.height, frame.stride);
+    benchmark::ClobberMemory();
+  }
+  SetFrameCounters(state, frame);
+}
+BENCHMARK(BM_StrideRepack)->Apply(FrameSizes);
+
+void BM_TextureUpdate(benchmark::State& state) {
+  Frame frame = MakeFrame(state);
+  auto allocator = std::make_shared<FrameAllocator>();
+  CameraTexture* texture = camera_texture_new_with_allocator(allocator);
+  FlPixelBufferTexture* pixel_texture = FL_PIXEL_BUFFER_TEXTURE(texture);
+
+  // Stand-in raster thread: copy_pixels then a read of the returned frame,
+  // the way the engine's texture upload consumes it.
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> reads{0};
+  std::thread raster([&] {
+    std::vector<uint8_t> upload;
+    while (!stop.load(std::memory_order_relaxed)) {
+      const uint8_t* buffer = nullptr;
+      uint32_t width = 0;
+      uint32_t height = 0;
+      if (FL_PIXEL_BUFFER_TEXTURE_GET_CLASS(pixel_texture)
+              ->copy_pixels(pixel_texture, &buffer, &width, &height,
+                            nullptr)) {
+        upload.resize((size_t)width * height * 4);
+        memcpy(upload.data(), buffer, upload.size());
+        reads.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (auto _ : state) {
+    // Mirrors the preview path in Camera::OnNewSample.
+    if (frame.stride == frame.row_bytes()) {
+      camera_texture_update(texture, frame.data.data(), frame.width,
+                            frame.height);
+    } else {
+      uint8_t* tight = allocator->Allocate(frame.tight_size());
+      CopyFrameRows(tight, frame.data.data(), frame.row_bytes(), frame.height,
+                    frame.stride);
+      camera_texture_update(texture, tight, frame.width, frame.height);
+      allocator->Release(tight, frame.tight_size());
+    }
+  }
+
+  stop = true;
+  raster.join();
+  g_object_unref(texture);
+  SetFrameCounters(state, frame);
+  state.counters["raster_reads"] =
+      benchmark::Counter((double)reads.load(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TextureUpdate)->Apply(FrameSizes)->UseRealTime();
+
+void BM_FfiPublish(benchmark::State& state) {
+  Frame frame = MakeFrame(state);
+  size_t total = offsetof(ImageStreamBuffer, pixels) + frame.tight_size();
+  FrameAllocator allocator;
+  auto* buf =
+      reinterpret_cast<ImageStreamBuffer*>(allocator.Allocate(total));
+  int64_t sequence = 0;
+  for (auto _ : state) {
+    PublishImageStreamFrame(buf, frame.data.data(), frame.width, frame.height,
+                            frame.stride, ++sequence);
+    benchmark::ClobberMemory();
+  }
+  allocator.Release(buf, total);
+  SetFrameCounters(state, frame);
+}
+BENCHMARK(BM_FfiPublish)->Apply(FrameSizes);
+
+void BM_LegacyStreamFrame(benchmark::State& state) {
+  Frame frame = MakeFrame(state);
+  FrameAllocator allocator;
+  for (auto _ : state) {
+    // Streaming thread: a copy per frame, into a recycled buffer.
+    uint8_t* frame_copy = allocator.Allocate(frame.tight_size());
+    CopyFrameRows(frame_copy, frame.data.data(), frame.row_bytes(),
+                  frame.height, frame.stride);
+
+    // Main thread: the channel arguments copy the pixels once more.
+    g_autoptr(FlValue) args = fl_value_new_map();
+    fl_value_set_string_take(args, "cameraId", fl_value_new_int(1));
+    fl_value_set_string_take(args, "width", fl_value_new_int(frame.width));
+    fl_value_set_string_take(args, "height", fl_value_new_int(frame.height));
+    fl_value_set_string_take(
+        args, "bytes",
+        fl_value_new_uint8_list(frame_copy, frame.tight_size()));
+    benchmark::DoNotOptimize(args);
+    allocator.Release(frame_copy, frame.tight_size());
+  }
+  SetFrameCounters(state, frame);
+}
+BENCHMARK(BM_LegacyStreamFrame)->Apply(FrameSizes);
+
+void BM_FrameChange(benchmark::State& state) {
+  Frame frame = MakeFrame(state);
+  FrameChangeDetector detector;
+  detector.Update(frame.data.data(), frame.width, frame.height, frame.stride);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(detector.Difference(
+        frame.data.data(), frame.width, frame.height, frame.stride));
+  }
+  // Frames per second is what counts here; the bytes touched are fixed.
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameChange)->Apply(FrameSizes);
+
+// Working set of the concurrent thread in BM_CopyUnderLoad: larger than a
+// typical L2, well inside a typical L3.
+const size_t kVictimBytes = 4 * 1024 * 1024;
+
+void BM_CopyUnderLoad(benchmark::State& state) {
+  int width = (int)state.range(0);
+  int height = (int)state.range(1);
+  bool streaming = state.range(2) != 0;
+  Frame frame(width, height, false);
+  FrameAllocator allocator;
+  uint8_t* dst = allocator.Allocate(frame.tight_size());
+  SetStreamingCopyThreshold(streaming ? 0 : SIZE_MAX);
+
+  // A random cycle through one cache line per node, so every hop is a
+  // dependent load the prefetcher cannot hide: the hop rate tracks how much
+  // of the working set stays in cache.
+  const size_t kLine = 64 / sizeof(uint32_t);
+  std::vector<uint32_t> next(kVictimBytes / sizeof(uint32_t));
+  std::vector<uint32_t> order(next.size() / kLine);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+  for (size_t i = 0; i < order.size(); i++) {
+    next[order[i] * kLine] = order[(i + 1) % order.size()] * kLine;
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> hops{0};
+  std::thread victim([&] {
+    uint32_t node = 0;
+    uint64_t count = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      for (int i = 0; i < 1024; i++) node = next[node];
+      count += 1024;
+    }
+    benchmark::DoNotOptimize(node);
+    hops.store(count);
+  });
+
+  for (auto _ : state) {
+    CopyFrame(dst, frame.data.data(), frame.tight_size());
+    benchmark::ClobberMemory();
+  }
+
+  stop = true;
+  victim.join();
+  SetStreamingCopyThreshold(kStreamingCopyThreshold);
+  allocator.Release(dst, frame.tight_size());
+  SetFrameCounters(state, frame);
+  state.counters["victim_hops"] =
+      benchmark::Counter((double)hops.load(), benchmark::Counter::kIsRate);
+  state.SetLabel(streaming ? StreamingCopyKernel() : "memcpy");
+}
+BENCHMARK(BM_CopyUnderLoad)
+    ->ArgNames({"w", "h", "streaming"})
+    ->Args({1920, 1080, 0})
+    ->Args({1920, 1080, 1})
+    ->Args({3840, 2160, 0})
+    ->Args({3840, 2160, 1})
+    ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,378 @@
+// Multi-camera scaling benchmark.
+//
+// Runs 1..N virtual cameras (videotestsrc) through the same element layout
+// the plugin builds per device (CaptureSession) and per camera (branch), and
+// reports per-step frame-rate stability, process CPU, thread count and
+// capture-to-appsink latency. Compare runs with and without --pool to see the
+// effect of the shared streaming thread pool, and --sched/--load to see the
+// effect of real-time priorities on frame-interval jitter under CPU pressure.
+//
+// Usage:
+//   camera_desktop_multi_camera_benchmark [--max-cameras=16] [--width=640]
+//       [--height=480] [--fps=30] [--seconds=5] [--pool] [--warm-threads=4]
+//       [--cpus=0,1,2,3] [--sched=fifo:50|nice:-10] [--sched-cpus=2,3]
+//       [--load=N]
+
+#include <gst/app/gstappsink.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "streaming_thread_pool.h"
+#include "thread_scheduling.h"
+
+namespace {
+
+using benchmark_util::Percentile;
+using benchmark_util::ProcessCpuSeconds;
+using benchmark_util::ProcessThreadCount;
+
+struct Options {
+  int max_cameras = 16;
+  int width = 640;
+  int height = 480;
+  int fps = 30;
+  int seconds = 5;
+  bool use_pool = false;
+  int warm_threads = 4;
+  std::vector<int> cpus;
+  ThreadSchedule schedule;  // Applied to every streaming thread.
+  int load_threads = 0;     // Busy-looping threads competing for CPU.
+};
+
+// Upper bounds (ms) of the jitter histogram buckets; the last is open.
+const double kJitterBucketsMs[] = {0.5, 1, 2, 5, 10, 20, 50};
+const size_t kJitterBucketCount =
+    sizeof(kJitterBucketsMs) / sizeof(kJitterBucketsMs[0]) + 1;
+
+struct VirtualCamera {
+  GstElement* pipeline = nullptr;
+  std::vector<uint8_t> texture;  // Stands in for CameraTexture's write buffer.
+
+  std::mutex mutex;  // Guards the sample vectors below.
+  bool measuring = false;
+  gint64 last_arrival_us = 0;
+  std::vector<double> intervals_ms;
+  std::vector<double> latencies_ms;
+};
+
+GstFlowReturn OnNewSample(GstAppSink* sink, gpointer user_data) {
+  auto* cam = static_cast<VirtualCamera*>(user_data);
+  GstSample* sample = gst_app_sink_pull_sample(sink);
+  if (!sample) return GST_FLOW_ERROR;
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  GstVideoInfo info;
+  gst_video_info_from_caps(&info, gst_sample_get_caps(sample));
+
+  // Same work as Camera::OnNewSample's preview path: a tight RGBA copy.
+  GstMapInfo map;
+  if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    int width = GST_VIDEO_INFO_WIDTH(&info);
+    int height = GST_VIDEO_INFO_HEIGHT(&info);
+    int stride = GST_VIDEO_INFO_PLANE_STRIDE(&info, 0);
+    size_t row = (size_t)width * 4;
+    cam->texture.resize(row * height);
+    for (int y = 0; y < height; y++) {
+      memcpy(cam->texture.data() + y * row, map.data + (size_t)y * stride,
+             row);
+    }
+    gst_buffer_unmap(buffer, &map);
+  }
+
+  // Latency: pipeline running time now minus the buffer's capture time.
+  double latency_ms = -1;
+  GstElement* element = GST_ELEMENT(sink);
+  GstClock* clock = gst_element_get_clock(element);
+  if (clock && GST_BUFFER_PTS_IS_VALID(buffer)) {
+    GstClockTime now = gst_clock_get_time(clock) -
+                       gst_element_get_base_time(element);
+    if (now > GST_BUFFER_PTS(buffer)) {
+      latency_ms = (now - GST_BUFFER_PTS(buffer)) / 1e6;
+    }
+  }
+  if (clock) gst_object_unref(clock);
+
+  gint64 now_us = g_get_monotonic_time();
+  {
+    std::lock_guard<std::mutex> lk(cam->mutex);
+    if (cam->measuring) {
+      if (cam->last_arrival_us > 0) {
+        cam->intervals_ms.push_back((now_us - cam->last_arrival_us) / 1e3);
+      }
+      if (latency_ms >= 0) cam->latencies_ms.push_back(latency_ms);
+    }
+    cam->last_arrival_us = now_us;
+  }
+
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+GstBusSyncReply OnSyncMessage(GstBus* bus, GstMessage* msg,
+                              gpointer user_data) {
+  const Options* opt = static_cast<const Options*>(user_data);
+  if (GST_MESSAGE_TYPE(msg) != GST_MESSAGE_STREAM_STATUS) return GST_BUS_PASS;
+  if (opt->use_pool) {
+    streaming_thread_pool_handle_message(streaming_thread_pool_get_default(),
+                                         msg);
+  }
+
+  // ENTER is posted from the new streaming thread itself, mirroring how
+  // CaptureSession applies a camera's schedule.
+  GstStreamStatusType type;
+  GstElement* owner = nullptr;
+  gst_message_parse_stream_status(msg, &type, &owner);
+  if (type == GST_STREAM_STATUS_TYPE_ENTER && !opt->schedule.is_default()) {
+    std::string error;
+    ApplyThreadSchedule(CurrentThreadId(), opt->schedule, &error);
+    if (!error.empty()) {
+      static std::atomic<bool> warned{false};
+      if (!warned.exchange(true)) {
+        fprintf(stderr, "scheduling: %s\n", error.c_str());
+      }
+    }
+  }
+  return GST_BUS_PASS;
+}
+
+// Burns CPU until |stop| is set, to reproduce a saturated machine.
+struct LoadThreads {
+  std::atomic<bool> stop{false};
+  std::vector<GThread*> threads;
+
+  static gpointer Spin(gpointer data) {
+    auto* stop = static_cast<std::atomic<bool>*>(data);
+    volatile uint64_t x = 0;
+    while (!stop->load(std::memory_order_relaxed)) x = x * 31 + 7;
+    return nullptr;
+  }
+
+  void Start(int n) {
+    for (int i = 0; i < n; i++) {
+      threads.push_back(g_thread_new("load", Spin, &stop));
+    }
+  }
+
+  ~LoadThreads() {
+    stop = true;
+    for (GThread* t : threads) g_thread_join(t);
+  }
+};
+
+void PrintJitterHistogram(const std::vector<double>& intervals_ms, int fps) {
+  size_t counts[kJitterBucketCount] = {};
+  double expected = 1000.0 / fps;
+  for (double ivl : intervals_ms) {
+    double dev = std::fabs(ivl - expected);
+    size_t b = 0;
+    while (b < kJitterBucketCount - 1 && dev >= kJitterBucketsMs[b]) b++;
+    counts[b]++;
+  }
+  printf("        jitter |ivl-%.1fms|:", expected);
+  for (size_t b = 0; b < kJitterBucketCount; b++) {
+    double pct = intervals_ms.empty()
+                     ? 0.0
+                     : 100.0 * counts[b] / intervals_ms.size();
+    if (b < kJitterBucketCount - 1) {
+      printf(" <%gms %5.1f%%", kJitterBucketsMs[b], pct);
+    } else {
+      printf(" >=%gms %5.1f%%", kJitterBucketsMs[b - 1], pct);
+    }
+  }
+  printf("\n");
+}
+
+std::unique_ptr<VirtualCamera> StartCamera(const Options& opt, int index) {
+  // Mirrors CaptureSession::BuildPipeline + Camera::BuildBranch with the
+  // device swapped for a live test source.
+  gchar* desc = g_strdup_printf(
+      "videotestsrc is-live=true pattern=ball "
+      "! video/x-raw,width=%d,height=%d,framerate=%d/1 "
+      "! videoconvert "
+      "! video/x-raw,format=RGBA "
+      "! tee name=t allow-not-linked=true "
+      "t. ! queue name=branch_queue "
+      "! videoscale "
+      "! videoflip method=horizontal-flip "
+      "! video/x-raw,format=RGBA,width=%d,height=%d "
+      "! tee name=ct "
+      "ct. ! appsink name=sink max-buffers=2 drop=true sync=false",
+      opt.width, opt.height, opt.fps, opt.width, opt.height);
+  GError* error = nullptr;
+  GstElement* pipeline = gst_parse_launch(desc, &error);
+  g_free(desc);
+  if (!pipeline) {
+    fprintf(stderr, "camera %d: %s\n", index,
+            error ? error->message : "parse failed");
+    if (error) g_error_free(error);
+    return nullptr;
+  }
+
+  auto cam = std::make_unique<VirtualCamera>();
+  cam->pipeline = pipeline;
+
+  if (opt.use_pool || !opt.schedule.is_default()) {
+    GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+    gst_bus_set_sync_handler(bus, OnSyncMessage,
+                             const_cast<Options*>(&opt), nullptr);
+    gst_object_unref(bus);
+  }
+
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+  GstAppSinkCallbacks callbacks = {};
+  callbacks.new_sample = OnNewSample;
+  gst_app_sink_set_callbacks(GST_APP_SINK(sink), &callbacks, cam.get(),
+                             nullptr);
+  gst_object_unref(sink);
+
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+  return cam;
+}
+
+void StopCamera(VirtualCamera* cam) {
+  gst_element_set_state(cam->pipeline, GST_STATE_NULL);
+  gst_object_unref(cam->pipeline);
+  cam->pipeline = nullptr;
+}
+
+void RunStep(const Options& opt, int n) {
+  LoadThreads load;
+  load.Start(opt.load_threads);
+
+  std::vector<std::unique_ptr<VirtualCamera>> cams;
+  for (int i = 0; i < n; i++) {
+    auto cam = StartCamera(opt, i);
+    if (cam) cams.push_back(std::move(cam));
+  }
+
+  // Let pipelines negotiate and settle before measuring.
+  g_usleep(G_USEC_PER_SEC);
+  for (auto& cam : cams) {
+    std::lock_guard<std::mutex> lk(cam->mutex);
+    cam->measuring = true;
+  }
+  double cpu_start = ProcessCpuSeconds();
+  gint64 wall_start = g_get_monotonic_time();
+  g_usleep((gulong)opt.seconds * G_USEC_PER_SEC);
+  double cpu_used = ProcessCpuSeconds() - cpu_start;
+  double wall = (g_get_monotonic_time() - wall_start) / 1e6;
+  int threads = ProcessThreadCount();
+
+  std::vector<double> per_cam_fps;
+  std::vector<double> intervals;
+  std::vector<double> latencies;
+  for (auto& cam : cams) {
+    std::lock_guard<std::mutex> lk(cam->mutex);
+    cam->measuring = false;
+    per_cam_fps.push_back((cam->intervals_ms.size() + 1) / wall);
+    intervals.insert(intervals.end(), cam->intervals_ms.begin(),
+                     cam->intervals_ms.end());
+    latencies.insert(latencies.end(), cam->latencies_ms.begin(),
+                     cam->latencies_ms.end());
+  }
+  for (auto& cam : cams) StopCamera(cam.get());
+
+  double mean_fps = 0;
+  for (double f : per_cam_fps) mean_fps += f;
+  mean_fps /= std::max<size_t>(per_cam_fps.size(), 1);
+  double min_fps = per_cam_fps.empty()
+                       ? 0
+                       : *std::min_element(per_cam_fps.begin(),
+                                           per_cam_fps.end());
+  size_t total_frames = intervals.size() + cams.size();
+
+  printf("%7d %9.2f %8.2f %10.2f %10.2f %9.2f %9.2f %8.1f %10.1f %8d\n", n,
+         mean_fps, min_fps, Percentile(intervals, 0.5),
+         Percentile(intervals, 0.99), Percentile(latencies, 0.5),
+         Percentile(latencies, 0.99), 100.0 * cpu_used / wall,
+         total_frames ? cpu_used * 1e6 / total_frames : 0.0, threads);
+  PrintJitterHistogram(intervals, opt.fps);
+  fflush(stdout);
+}
+
+bool ParseOptions(int argc, char** argv, Options* opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (sscanf(arg, "--max-cameras=%d", &opt->max_cameras) == 1) continue;
+    if (sscanf(arg, "--width=%d", &opt->width) == 1) continue;
+    if (sscanf(arg, "--height=%d", &opt->height) == 1) continue;
+    if (sscanf(arg, "--fps=%d", &opt->fps) == 1) continue;
+    if (sscanf(arg, "--seconds=%d", &opt->seconds) == 1) continue;
+    if (sscanf(arg, "--warm-threads=%d", &opt->warm_threads) == 1) continue;
+    if (sscanf(arg, "--load=%d", &opt->load_threads) == 1) continue;
+    if (sscanf(arg, "--sched=fifo:%d", &opt->schedule.priority) == 1) {
+      opt->schedule.policy = ThreadSchedule::Policy::kFifo;
+      continue;
+    }
+    if (sscanf(arg, "--sched=nice:%d", &opt->schedule.priority) == 1) {
+      opt->schedule.policy = ThreadSchedule::Policy::kNice;
+      continue;
+    }
+    if (strncmp(arg, "--sched-cpus=", 13) == 0) {
+      gchar** parts = g_strsplit(arg + 13, ",", -1);
+      for (gchar** p = parts; *p; p++) {
+        opt->schedule.cpus.push_back(atoi(*p));
+      }
+      g_strfreev(parts);
+      continue;
+    }
+    if (strcmp(arg, "--pool") == 0) {
+      opt->use_pool = true;
+      continue;
+    }
+    if (strncmp(arg, "--cpus=", 7) == 0) {
+      gchar** parts = g_strsplit(arg + 7, ",", -1);
+      for (gchar** p = parts; *p; p++) opt->cpus.push_back(atoi(*p));
+      g_strfreev(parts);
+      continue;
+    }
+    fprintf(stderr, "Unknown option: %s\n", arg);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+
+  Options opt;
+  if (!ParseOptions(argc, argv, &opt)) return 1;
+
+  if (opt.use_pool) {
+    streaming_thread_pool_configure(
+        streaming_thread_pool_get_default(), (guint)opt.warm_threads,
+        opt.cpus.data(), (guint)opt.cpus.size());
+  }
+
+  printf("# %dx%d @ %d fps, %d s per step, %s, %d load threads on %ld CPUs\n",
+         opt.width, opt.height, opt.fps, opt.seconds,
+         opt.use_pool ? "shared streaming thread pool"
+                      : "default GStreamer thread pools",
+         opt.load_threads, sysconf(_SC_NPROCESSORS_ONLN));
+  printf("%7s %9s %8s %10s %10s %9s %9s %8s %10s %8s\n", "cameras", "fps_mean",
+         "fps_min", "ivl_p50ms", "ivl_p99ms", "lat_p50", "lat_p99", "cpu_%",
+         "cpu_us/f", "threads");
+
+  for (int n = 1; n <= opt.max_cameras; n *= 2) {
+    RunStep(opt, n);
+    if (n < opt.max_cameras && n * 2 > opt.max_cameras) {
+      RunStep(opt, opt.max_cameras);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,268 @@
+// Cold-start benchmark.
+//
+// Registers the real plugin against the stub embedder (embedder_stubs.h) and
+// times create -> initialize -> first frame -> dispose through the method
+// channel, repeatedly. Registration starts GStreamer initialization and
+// factory warm-up in the background (gst_warmup.h), so the first iteration
+// is a true cold start: its create waits for gst_init if it is still
+// running. --create-delay-ms lets warm-up finish first, as it would behind
+// an app's own startup. Later iterations show the warm cost. Each row is the
+// "startup" breakdown the initialize response carries, plus the round trips
+// seen from the Dart side.
+//
+// Usage:
+//   camera_desktop_startup_benchmark [--iterations=10] [--width=1280]
+//       [--height=720] [--fps=30] [--pattern=smpte] [--create-delay-ms=0]
+//       [--prepare] [--pool=0]
+//
+// --prepare calls prepare with the same settings before each create, then
+// lets it settle for --prepare-ms (default 500), to measure the first frame
+// from a pre-warmed pipeline.
+//
+// --pool=N configures the camera pool with N entries first, so every
+// iteration after the first re-creates the camera parked by the one before.
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "benchmark_util.h"
+#include "embedder_stubs.h"
+#include "include/camera_desktop/camera_desktop_plugin.h"
+
+using benchmark_util::Percentile;
+
+namespace {
+
+const char kChannelName[] = "plugins.flutter.io/camera_desktop";
+
+// Startup phases as printed, in the order they happen.
+const char* const kPhases[] = {"gstInitUs",       "enumerateUs",
+                               "branchBuildUs",   "parseUs",
+                               "stateChangeUs",   "firstFrameUs",
+                               "textureUploadUs", "respondUs",
+                               "initializeTotalUs"};
+
+struct Options {
+  int iterations = 10;
+  int width = 1280;
+  int height = 720;
+  int fps = 30;
+  std::string pattern = "smpte";
+  int create_delay_ms = 0;  // Between registration and the first create.
+  bool prepare = false;
+  int prepare_ms = 500;
+  int pool = 0;  // configureCameraPool maxEntries.
+};
+
+struct Iteration {
+  double register_ms = 0;  // Only the first iteration registers.
+  double create_ms = 0;
+  double initialize_ms = 0;
+  double dispose_ms = 0;
+  std::map<std::string, double> phases_ms;
+  bool session_reused = false;
+  bool session_prepared = false;
+  bool pooled = false;
+};
+
+bool ParseOptions(int argc, char** argv, Options* opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (sscanf(arg, "--iterations=%d", &opt->iterations) == 1) continue;
+    if (sscanf(arg, "--width=%d", &opt->width) == 1) continue;
+    if (sscanf(arg, "--height=%d", &opt->height) == 1) continue;
+    if (sscanf(arg, "--fps=%d", &opt->fps) == 1) continue;
+    if (sscanf(arg, "--create-delay-ms=%d", &opt->create_delay_ms) == 1) {
+      continue;
+    }
+    if (sscanf(arg, "--prepare-ms=%d", &opt->prepare_ms) == 1) continue;
+    if (sscanf(arg, "--pool=%d", &opt->pool) == 1) continue;
+    if (strcmp(arg, "--prepare") == 0) {
+      opt->prepare = true;
+      continue;
+    }
+    if (strncmp(arg, "--pattern=", 10) == 0) {
+      opt->pattern = arg + 10;
+      continue;
+    }
+    fprintf(stderr, "Unknown option: %s\n", arg);
+    return false;
+  }
+  return opt->iterations > 0;
+}
+
+bool RunIteration(BenchMessenger* messenger, const Options& opt,
+                  Iteration* it) {
+  gchar* name = g_strdup_printf(
+      "Bench (test://pattern?w=%d&h=%d&fps=%d&pattern=%s)", opt.width,
+      opt.height, opt.fps, opt.pattern.c_str());
+  g_autoptr(FlValue) create_args = fl_value_new_map();
+  fl_value_set_string_take(create_args, "cameraName",
+                           fl_value_new_string(name));
+  fl_value_set_string_take(create_args, "resolutionPreset",
+                           fl_value_new_int(3));
+  fl_value_set_string_take(create_args, "enableAudio",
+                           fl_value_new_bool(false));
+  fl_value_set_string_take(create_args, "fps", fl_value_new_int(opt.fps));
+  g_free(name);
+
+  std::string error;
+  if (opt.prepare) {
+    if (CallAndWait(messenger, kChannelName, "prepare", create_args, 5000,
+                    &error) < 0) {
+      fprintf(stderr, "prepare failed: %s\n", error.c_str());
+      return false;
+    }
+    RunFor(opt.prepare_ms);
+  }
+
+  FlValue* created = nullptr;
+  it->create_ms = CallAndWait(messenger, kChannelName, "create", create_args,
+                              5000, &error, &created);
+  if (it->create_ms < 0 || !created) {
+    fprintf(stderr, "create failed: %s\n", error.c_str());
+    return false;
+  }
+  int64_t camera_id =
+      fl_value_get_int(fl_value_lookup_string(created, "cameraId"));
+  fl_value_unref(created);
+
+  g_autoptr(FlValue) id_args = fl_value_new_map();
+  fl_value_set_string_take(id_args, "cameraId", fl_value_new_int(camera_id));
+
+  FlValue* initialized = nullptr;
+  it->initialize_ms = CallAndWait(messenger, kChannelName, "initialize",
+                                  id_args, 10000, &error, &initialized);
+  bool ok = it->initialize_ms >= 0 && initialized;
+  if (!ok) {
+    fprintf(stderr, "initialize failed: %s\n", error.c_str());
+  } else {
+    FlValue* startup = fl_value_lookup_string(initialized, "startup");
+    if (startup && fl_value_get_type(startup) == FL_VALUE_TYPE_MAP) {
+      for (const char* phase : kPhases) {
+        if (fl_value_lookup_string(startup, phase)) {
+          it->phases_ms[phase] = LookupFloat(startup, phase) / 1e3;
+        }
+      }
+      FlValue* reused = fl_value_lookup_string(startup, "sessionReused");
+      it->session_reused = reused && fl_value_get_bool(reused);
+      FlValue* prepared = fl_value_lookup_string(startup, "sessionPrepared");
+      it->session_prepared = prepared && fl_value_get_bool(prepared);
+      FlValue* pooled = fl_value_lookup_string(startup, "pooled");
+      it->pooled = pooled && fl_value_get_bool(pooled);
+    }
+  }
+  if (initialized) fl_value_unref(initialized);
+
+  it->dispose_ms = CallAndWait(messenger, kChannelName, "dispose", id_args,
+                               5000, &error);
+  // Let the closing event and any late idle callbacks drain.
+  RunFor(100);
+  return ok;
+}
+
+void PrintRow(const char* label, const Iteration& it) {
+  printf("%-6s %9.1f %9.1f %9.1f %9.1f", label, it.register_ms, it.create_ms,
+         it.initialize_ms, it.dispose_ms);
+  for (const char* phase : kPhases) {
+    auto found = it.phases_ms.find(phase);
+    if (found == it.phases_ms.end()) {
+      printf(" %9s", "-");
+    } else {
+      printf(" %9.2f", found->second);
+    }
+  }
+  printf("%s\n", it.pooled              ? "  (pooled)"
+                 : it.session_reused   ? "  (session reused)"
+                 : it.session_prepared ? "  (prepared)"
+                                       : "");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  if (!ParseOptions(argc, argv, &opt)) return 1;
+
+  BenchMessenger* messenger = bench_messenger_new();
+  BenchTextureRegistrar* textures = bench_texture_registrar_new();
+  BenchPluginRegistrar* registrar =
+      bench_plugin_registrar_new(messenger, textures);
+
+  // Nothing in this process has touched GStreamer before this point.
+  gint64 register_start_us = g_get_monotonic_time();
+  camera_desktop_plugin_register_with_registrar(
+      FL_PLUGIN_REGISTRAR(registrar));
+  double register_ms = (g_get_monotonic_time() - register_start_us) / 1e3;
+  if (opt.create_delay_ms > 0) RunFor(opt.create_delay_ms);
+  if (opt.pool > 0) {
+    g_autoptr(FlValue) pool_args = fl_value_new_map();
+    fl_value_set_string_take(pool_args, "maxEntries",
+                             fl_value_new_int(opt.pool));
+    std::string error;
+    if (CallAndWait(messenger, kChannelName, "configureCameraPool", pool_args,
+                    1000, &error) < 0) {
+      fprintf(stderr, "configureCameraPool failed: %s\n", error.c_str());
+      return 1;
+    }
+  }
+
+  printf("# %dx%d @ %d fps, pattern %s, %d iterations%s%s (times in ms)\n",
+         opt.width, opt.height, opt.fps, opt.pattern.c_str(), opt.iterations,
+         opt.prepare ? ", prepared" : "", opt.pool > 0 ? ", pooled" : "");
+  printf("%-6s %9s %9s %9s %9s", "iter", "register", "create", "init",
+         "dispose");
+  for (const char* phase : kPhases) {
+    std::string column(phase, strlen(phase) - 2);  // Drop the "Us" suffix.
+    printf(" %9.9s", column.c_str());
+  }
+  printf("\n");
+
+  std::vector<Iteration> warm;
+  int failures = 0;
+  for (int i = 0; i < opt.iterations; i++) {
+    Iteration it;
+    if (i == 0) it.register_ms = register_ms;
+    if (!RunIteration(messenger, opt, &it)) {
+      failures++;
+      continue;
+    }
+    PrintRow(i == 0 ? "cold" : std::to_string(i).c_str(), it);
+    if (i > 0) warm.push_back(it);
+    fflush(stdout);
+  }
+
+  if (!warm.empty()) {
+    // gst_init happens once per process, so the warm median leaves it out.
+    Iteration median;
+    std::vector<double> create, init, dispose;
+    for (const Iteration& it : warm) {
+      create.push_back(it.create_ms);
+      init.push_back(it.initialize_ms);
+      dispose.push_back(it.dispose_ms);
+    }
+    median.create_ms = Percentile(create, 0.5);
+    median.initialize_ms = Percentile(init, 0.5);
+    median.dispose_ms = Percentile(dispose, 0.5);
+    for (const char* phase : kPhases) {
+      if (strcmp(phase, "gstInitUs") == 0) continue;
+      std::vector<double> values;
+      for (const Iteration& it : warm) {
+        auto found = it.phases_ms.find(phase);
+        if (found != it.phases_ms.end()) values.push_back(found->second);
+      }
+      if (!values.empty()) median.phases_ms[phase] = Percentile(values, 0.5);
+    }
+    PrintRow("p50", median);
+  }
+
+  g_object_unref(registrar);
+  g_object_unref(textures);
+  g_object_unref(messenger);
+  return failures == 0 ? 0 : 1;
+}
@@ -1,4 +1,5 @@
 #include "camera.h"
+#include "frame_trace.h"
 #include "photo_handler.h"
 
 #include <gio/gio.h>
@@ -7,13 +8,15 @@
 #include <atomic>
 #include <cstdio>
 #include <cstring>
+#include <utility>
 
 static const guint kInitTimeoutMs = 8000;
 
 Camera::Camera(int camera_id,
                FlTextureRegistrar* texture_registrar,
                FlMethodChannel* method_channel,
-               const CameraConfig& config)
+               const CameraConfig& config,
+               std::shared_ptr<CaptureSession> session)
     : camera_id_(camera_id),
       texture_id_(-1),
       state_(CameraState::kCreated),
@@ -21,13 +24,21 @@ Camera::Camera(int camera_id,
       texture_registrar_(texture_registrar),
       method_channel_(method_channel),
       texture_(nullptr),
-      pipeline_(nullptr),
+      allocator_(std::make_shared<FrameAllocator>()),
+      session_(std::move(session)),
+      branch_(nullptr),
       tee_(nullptr),
       appsink_(nullptr),
       videoflip_(nullptr),
-      bus_watch_id_(0),
+      preview_decimator_(config.target_fps, kPreviewMaxFps),
       init_timeout_id_(0),
       record_handler_(std::make_unique<RecordHandler>()),
+      source_switcher_(std::make_unique<SourceSwitcher>(
+          [this] { record_handler_->RequestKeyframe(); },
+          [this](const std::string& error) {
+            SendError("Switched camera failed, back on the original: " +
+                      error);
+          })),
       pending_init_call_(nullptr),
       first_frame_received_(false),
       preview_paused_(false),
@@ -41,7 +52,7 @@ Camera::~Camera() {
 }
 
 int64_t Camera::RegisterTexture() {
-  texture_ = camera_texture_new();
+  texture_ = camera_texture_new_with_allocator(allocator_);
   FlTexture* fl_tex = camera_texture_as_fl_texture(texture_);
   if (!fl_texture_registrar_register_texture(texture_registrar_, fl_tex)) {
     g_object_unref(texture_);
@@ -52,6 +63,14 @@ int64_t Camera::RegisterTexture() {
   return texture_id_;
 }
 
+int64_t Camera::AdoptTexture(CameraTexture* texture) {
+  texture_ = texture;
+  // Its buffers, sized for this camera's frames, are already there.
+  allocator_ = camera_texture_get_allocator(texture_);
+  texture_id_ = fl_texture_get_id(camera_texture_as_fl_texture(texture_));
+  return texture_id_;
+}
+
 void Camera::Initialize(FlMethodCall* method_call) {
   if (state_.load() != CameraState::kCreated) {
     g_autoptr(FlValue) error_details = fl_value_new_null();
@@ -64,101 +83,157 @@ void Camera::Initialize(FlMethodCall* method_call) {
   state_.store(CameraState::kInitializing);
   pending_init_call_ = FL_METHOD_CALL(g_object_ref(method_call));
   first_frame_received_.store(false);
+  init_start_us_ = g_get_monotonic_time();
+  first_sample_us_.store(0);
+  first_texture_us_.store(0);
 
   GError* error = nullptr;
-  if (!BuildPipeline(&error)) {
+  if (!BuildBranch(&error)) {
     RespondToPendingInit(false, error->message);
     g_error_free(error);
     state_.store(CameraState::kCreated);
     return;
   }
-
-  // Set pipeline to PLAYING.
-  GstStateChangeReturn ret =
-      gst_element_set_state(pipeline_, GST_STATE_PLAYING);
-  if (ret == GST_STATE_CHANGE_FAILURE) {
-    RespondToPendingInit(false, "Failed to start GStreamer pipeline");
-    gst_object_unref(pipeline_);
-    pipeline_ = nullptr;
-    appsink_ = nullptr;
+  branch_built_us_ = g_get_monotonic_time();
+
+  // Attach to the shared device pipeline. This starts the device if no other
+  // camera is using it yet.
+  if (!session_->AttachBranch(branch_, Camera::OnSessionMessage, this,
+                              &error)) {
+    RespondToPendingInit(false, error ? error->message
+                                      : "Failed to start GStreamer pipeline");
+    if (error) g_error_free(error);
+    ReleaseBranch();
     state_.store(CameraState::kCreated);
     return;
   }
+  session_->SetBranchSchedule(branch_, thread_schedule_, nullptr);
 
   // Set a timeout for initialization — if no frame arrives in time, fail.
   init_timeout_id_ =
       g_timeout_add(kInitTimeoutMs, Camera::OnInitTimeout, this);
 }
 
-bool Camera::BuildPipeline(GError** error) {
-  // Build pipeline with a tee to support branching for recording:
-  //   v4l2src ! videoconvert ! caps ! tee name=t
-  //     t. ! queue ! appsink (preview)
+bool Camera::BuildBranch(GError** error) {
+  // Build this camera's branch of the shared device pipeline, with a tee to
+  // support branching for recording:
+  //   [session tee] ! queue ! input-selector ! videoscale ! videoflip ! caps
+  //       ! tee name=t
+  //     t. ! appsink (preview)
   //     t. ! [recording branch, added later by RecordHandler]
-  gchar* pipeline_str = g_strdup_printf(
-      "v4l2src device=%s "
-      "! videoconvert "
+  // The queue gives each camera its own streaming thread so one slow
+  // consumer cannot stall the others sharing the device. videoscale is a
+  // passthrough when this camera's size matches the session's. The
+  // input-selector passes the queue through until SourceSwitcher bridges
+  // another device in; sync-streams=false drops the unselected input.
+  // The appsink holds about as much time as two frames at 30 fps, so a
+  // high-frame-rate camera rides out the same stall without dropping.
+  gchar* branch_str = g_strdup_printf(
+      "queue name=branch_queue "
+      "! input-selector name=sel sync-streams=false "
+      "! videoscale "
       "! videoflip name=flip method=horizontal-flip "
-      "! video/x-raw,format=RGBA,width=%d,height=%d,framerate=%d/1 "
+      "! video/x-raw,format=RGBA,width=%d,height=%d "
       "! tee name=t "
-      "t. ! queue name=preview_queue ! "
-      "appsink name=sink emit-signals=true max-buffers=2 drop=true "
+      "t. ! appsink name=sink emit-signals=true max-buffers=%d drop=true "
       "sync=false",
-      config_.device_path.c_str(), config_.target_width,
-      config_.target_height, config_.target_fps);
+      config_.target_width, config_.target_height,
+      MAX(2, config_.target_fps / 15));
 
-  pipeline_ = gst_parse_launch(pipeline_str, error);
-  g_free(pipeline_str);
+  // TRUE ghosts the queue's sink pad as the bin's "sink" pad.
+  branch_ = gst_parse_bin_from_description(branch_str, TRUE, error);
+  g_free(branch_str);
 
-  if (!pipeline_) {
+  if (!branch_) {
     return false;
   }
+  // Keep our own ref: the branch outlives its membership in the pipeline
+  // until ReleaseBranch.
+  gst_object_ref_sink(branch_);
+
+  gchar* branch_name = g_strdup_printf("camera_%d", camera_id_);
+  gst_object_set_name(GST_OBJECT(branch_), branch_name);
+  g_free(branch_name);
 
   // Get the tee element (needed for recording branch attachment).
-  tee_ = gst_bin_get_by_name(GST_BIN(pipeline_), "t");
+  tee_ = gst_bin_get_by_name(GST_BIN(branch_), "t");
   if (!tee_) {
     g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
-                "Failed to find tee in pipeline");
-    gst_object_unref(pipeline_);
-    pipeline_ = nullptr;
+                "Failed to find tee in camera branch");
+    ReleaseBranch();
     return false;
   }
-  // Release our ref (pipeline holds one).
+  // Release our ref (branch holds one).
   gst_object_unref(tee_);
 
   // Get the videoflip element for runtime mirror toggling.
-  videoflip_ = gst_bin_get_by_name(GST_BIN(pipeline_), "flip");
+  videoflip_ = gst_bin_get_by_name(GST_BIN(branch_), "flip");
   if (videoflip_) {
-    gst_object_unref(videoflip_);  // Pipeline holds the ref.
+    gst_object_unref(videoflip_);  // Branch holds the ref.
   }
 
   // Get the appsink element.
-  appsink_ = gst_bin_get_by_name(GST_BIN(pipeline_), "sink");
+  appsink_ = gst_bin_get_by_name(GST_BIN(branch_), "sink");
   if (!appsink_) {
     g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
-                "Failed to find appsink in pipeline");
-    gst_object_unref(pipeline_);
-    pipeline_ = nullptr;
+                "Failed to find appsink in camera branch");
+    ReleaseBranch();
     return false;
   }
 
+  // Count every buffer that reaches the appsink; the ones OnNewSample never
+  // sees were dropped by its drop=true queue.
+  GstPad* sink_pad = gst_element_get_static_pad(appsink_, "sink");
+  if (sink_pad) {
+    gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER,
+                      Camera::OnAppsinkBuffer, this, nullptr);
+    gst_object_unref(sink_pad);
+  }
+
+  // Adaptive frame rate: frames the camera does not need are dropped before
+  // its queue, so its streaming thread never wakes for them.
+  GstPad* input_pad = gst_element_get_static_pad(branch_, "sink");
+  if (input_pad) {
+    input_info_valid_ = false;
+    gst_pad_add_probe(
+        input_pad,
+        static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER |
+                                     GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+        Camera::OnBranchInput, this, nullptr);
+    gst_object_unref(input_pad);
+  }
+
   // Connect the new-sample signal.
   GstAppSinkCallbacks callbacks = {};
   callbacks.new_sample = Camera::OnNewSample;
   gst_app_sink_set_callbacks(GST_APP_SINK(appsink_), &callbacks, this,
                              nullptr);
 
-  // Set up bus watch for error messages.
-  GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
-  bus_watch_id_ = gst_bus_add_watch(bus, Camera::OnBusMessage, this);
-  gst_object_unref(bus);
-
-  // Release our ref on the appsink (pipeline holds one).
+  // Release our ref on the appsink (branch holds one).
   gst_object_unref(appsink_);
 
+  if (!source_switcher_->Bind(branch_, error)) {
+    ReleaseBranch();
+    return false;
+  }
+
   return true;
 }
 
+void Camera::ReleaseBranch() {
+  if (!branch_) return;
+  latency_tracer_.reset();
+  // Closes any bridged device before the branch it feeds goes away.
+  source_switcher_->Reset();
+  // Blocks until the branch's streaming thread has left OnNewSample.
+  session_->DetachBranch(branch_);
+  gst_object_unref(branch_);
+  branch_ = nullptr;
+  tee_ = nullptr;
+  appsink_ = nullptr;
+  videoflip_ = nullptr;
+}
+
 void Camera::RespondToPendingInit(bool success, const char* error_message) {
   if (!pending_init_call_) return;
 
@@ -174,6 +249,7 @@ void Camera::RespondToPendingInit(bool success, const char* error_message) {
                              fl_value_new_float((double)actual_width_.load()));
     fl_value_set_string_take(result, "previewHeight",
                              fl_value_new_float((double)actual_height_.load()));
+    fl_value_set_string_take(result, "startup", StartupBreakdown());
     fl_method_call_respond_success(pending_init_call_, result, nullptr);
   } else {
     g_autoptr(FlValue) details = fl_value_new_null();
@@ -186,11 +262,70 @@ void Camera::RespondToPendingInit(bool success, const char* error_message) {
   pending_init_call_ = nullptr;
 }
 
+FlValue* Camera::StartupBreakdown() const {
+  gint64 responded_us = g_get_monotonic_time();
+  gint64 first_sample_us = first_sample_us_.load();
+  gint64 first_texture_us = first_texture_us_.load();
+  CaptureSession::StartupTimes session = session_->startup_times();
+  // The session phases count only if this Initialize started the pipeline;
+  // otherwise they belong to an earlier camera on the same device. A
+  // prepared pipeline was parsed (and the device opened) before Initialize.
+  bool started_session = session.play_requested_us >= init_start_us_;
+  bool prepared = started_session && session.prepared_us > 0 &&
+                  session.prepared_us < init_start_us_;
+
+  FlValue* map = fl_value_new_map();
+  auto set_phase = [map](const char* key, gint64 start_us, gint64 end_us) {
+    if (start_us > 0 && end_us >= start_us) {
+      fl_value_set_string_take(map, key, fl_value_new_int(end_us - start_us));
+    }
+  };
+  set_phase("gstInitUs", startup_.gst_init_start_us,
+            startup_.gst_init_end_us);
+  set_phase("enumerateUs", startup_.create_start_us, startup_.enumerated_us);
+  set_phase("branchBuildUs", init_start_us_, branch_built_us_);
+  if (started_session && !prepared) {
+    set_phase("parseUs", session.parse_start_us, session.parsed_us);
+  }
+  if (started_session) {
+    set_phase("stateChangeUs", session.play_requested_us,
+              session.playing_us);
+  }
+  set_phase("firstFrameUs", init_start_us_, first_sample_us);
+  set_phase("textureUploadUs", first_sample_us, first_texture_us);
+  set_phase("respondUs", first_texture_us, responded_us);
+  set_phase("initializeTotalUs", init_start_us_, responded_us);
+  set_phase("createToFirstFrameUs", startup_.create_start_us,
+            first_texture_us);
+  fl_value_set_string_take(map, "sessionReused",
+                           fl_value_new_bool(!started_session));
+  fl_value_set_string_take(map, "sessionPrepared",
+                           fl_value_new_bool(prepared));
+  fl_value_set_string_take(map, "pooled", fl_value_new_bool(startup_.pooled));
+  return map;
+}
+
 GstFlowReturn Camera::OnNewSample(GstAppSink* sink, gpointer user_data) {
   Camera* self = static_cast<Camera*>(user_data);
+  frame_trace::Scope trace("OnNewSample", self->camera_id_);
 
   GstSample* sample = gst_app_sink_pull_sample(sink);
   if (!sample) return GST_FLOW_ERROR;
+  StatsBump(self->stats_.frames_captured);
+
+  if (self->trim_requested_.load(std::memory_order_relaxed) != 0) {
+    self->TrimIdleBuffers(self->trim_requested_.exchange(0));
+  }
+
+  // In standby on a device that other cameras keep streaming.
+  if (self->standby_.load(std::memory_order_relaxed)) {
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+  }
+  gint64 wake_us = self->wake_requested_us_.load(std::memory_order_relaxed);
+  if (wake_us != 0 && self->wake_requested_us_.exchange(0) == wake_us) {
+    self->last_wake_us_.store(g_get_monotonic_time() - wake_us);
+  }
 
   GstBuffer* buffer = gst_sample_get_buffer(sample);
   GstCaps* caps = gst_sample_get_caps(sample);
@@ -215,6 +350,7 @@ GstFlowReturn Camera::OnNewSample(GstAppSink* sink, gpointer user_data) {
   // C-2: first_frame_received_ is atomic — safe cross-thread read/write.
   bool is_first_frame = !self->first_frame_received_.load();
   if (is_first_frame) {
+    self->first_sample_us_.store(g_get_monotonic_time());
     self->first_frame_received_.store(true);
     // H-2: actual_width_/height_ are atomic — safe cross-thread write.
     self->actual_width_.store(width);
@@ -222,30 +358,97 @@ GstFlowReturn Camera::OnNewSample(GstAppSink* sink, gpointer user_data) {
     self->state_.store(CameraState::kRunning);
   }
 
+  // Static-frame skipping: a frame matching the last one delivered is not
+  // copied anywhere again. Compared against the last delivered frame, not
+  // the previous one, so a slow drift still gets through. Off while the
+  // preview is paused, since the texture then lags the reference.
+  bool unchanged = false;
+  bool changed = false;  // Compared, and differs from the reference.
+  int skip_threshold =
+      self->static_skip_threshold_.load(std::memory_order_relaxed);
+  if (skip_threshold >= 0 && !self->preview_paused_.load()) {
+    if (self->change_reset_.load(std::memory_order_relaxed) &&
+        self->change_reset_.exchange(false)) {
+      self->change_detector_.Reset();
+      self->stream_in_sync_ = false;
+    }
+    int difference =
+        self->change_detector_.Difference(map.data, width, height, stride);
+    unchanged = !is_first_frame && difference <= skip_threshold;
+    if (unchanged) {
+      StatsBump(self->stats_.frames_unchanged);
+    } else {
+      changed = true;
+    }
+  }
+
   // Update the texture only if preview is not paused (or if this is the first
   // frame, which we need for initialization).
   // C-3: preview_paused_ is atomic — safe cross-thread read.
-  if (!self->preview_paused_.load() || is_first_frame) {
-    if (stride == width * 4) {
+  bool update_preview =
+      (!self->preview_paused_.load() || is_first_frame) && !unchanged;
+
+  // High-frame-rate mode: the texture follows at about kPreviewMaxFps.
+  if (update_preview && self->preview_decimator_.active() &&
+      GST_BUFFER_PTS_IS_VALID(buffer) &&
+      !self->preview_decimator_.ShouldUpdate(GST_BUFFER_PTS(buffer)) &&
+      !is_first_frame) {
+    update_preview = false;
+    StatsBump(self->stats_.preview_decimated);
+  }
+
+  // Only a frame that reaches the texture becomes the reference. A
+  // decimated one would otherwise pass for delivered, and the identical
+  // frames after it would never reach the preview.
+  if (changed && update_preview) self->change_detector_.Commit();
+
+  if (update_preview) {
+    gint64 copy_start_us = g_get_monotonic_time();
+    if (self->preview_reduced_.load(std::memory_order_relaxed) &&
+        width >= 2 && height >= 2) {
+      // Over the memory budget: a quarter of the pixels; the preview widget
+      // scales it back up.
+      size_t half_size = (size_t)(width / 2) * (height / 2) * 4;
+      uint8_t* half = self->allocator_->Allocate(half_size);
+      DownscaleFrameHalf(half, map.data, width, height, stride);
+      camera_texture_update(self->texture_, half, width / 2, height / 2);
+      self->allocator_->Release(half, half_size);
+    } else if (stride == width * 4) {
       // No padding — direct copy.
       camera_texture_update(self->texture_, map.data, width, height);
     } else {
       // Stride has padding — copy row-by-row into a tight buffer.
-      // M-1 note: this intermediate allocation is unavoidable here since
-      // camera_texture_update requires a tightly-packed buffer.
+      // M-1 note: this intermediate buffer is unavoidable here since
+      // camera_texture_update requires a tightly-packed buffer. It comes
+      // back from the allocator's free list, so it costs no allocation.
       size_t tight_size = (size_t)width * height * 4;
-      uint8_t* tight = (uint8_t*)g_malloc(tight_size);
-      for (int row = 0; row < height; row++) {
-        memcpy(tight + row * width * 4, map.data + row * stride, width * 4);
-      }
+      uint8_t* tight = self->allocator_->Allocate(tight_size);
+      CopyFrameRows(tight, map.data, (size_t)width * 4, height, stride);
       camera_texture_update(self->texture_, tight, width, height);
-      g_free(tight);
+      self->allocator_->Release(tight, tight_size);
     }
 
+    self->stats_.copy_time.Record(g_get_monotonic_time() - copy_start_us);
+
     // Notify Flutter that a new frame is available.
     fl_texture_registrar_mark_texture_frame_available(
         self->texture_registrar_,
         camera_texture_as_fl_texture(self->texture_));
+    StatsBump(self->stats_.preview_updated);
+    if (is_first_frame) self->first_texture_us_.store(g_get_monotonic_time());
+
+    // Capture-to-texture latency: the buffer's PTS is the running time at
+    // which the source captured it.
+    GstClock* clock = gst_element_get_clock(GST_ELEMENT(sink));
+    if (clock && GST_BUFFER_PTS_IS_VALID(buffer)) {
+      GstClockTime now = gst_clock_get_time(clock) -
+                         gst_element_get_base_time(GST_ELEMENT(sink));
+      if (now >= GST_BUFFER_PTS(buffer)) {
+        self->stats_.capture_to_texture.Record(
+            GST_TIME_AS_USECONDS(now - GST_BUFFER_PTS(buffer)));
+      }
+    }
+    if (clock) gst_object_unref(clock);
   }
 
   // Send frame to Dart image stream if streaming is active.
@@ -255,55 +458,56 @@ GstFlowReturn Camera::OnNewSample(GstAppSink* sink, gpointer user_data) {
     // check and the call.
     ImageStreamCallback cb = self->image_stream_callback_.load();
     if (cb) {
+      frame_trace::Scope ffi_trace("ffi_stream_write", self->camera_id_);
       // FFI path: write to shared buffer, notify Dart directly.
       size_t frame_size = (size_t)width * height * 4;
-      size_t total_size = offsetof(Camera::ImageStreamBuffer, pixels) + frame_size;
+      size_t total_size = offsetof(ImageStreamBuffer, pixels) + frame_size;
 
       if (self->image_stream_buffer_size_ < total_size) {
-        g_free(self->image_stream_buffer_);
-        self->image_stream_buffer_ =
-            (Camera::ImageStreamBuffer*)g_malloc(total_size);
+        self->allocator_->Release(self->image_stream_buffer_,
+                                  self->image_stream_buffer_size_);
+        self->image_stream_buffer_ = reinterpret_cast<ImageStreamBuffer*>(
+            self->allocator_->Allocate(total_size));
         self->image_stream_buffer_size_ = total_size;
+        // A fresh buffer has no record of what Dart read; don't count the
+        // previous frame as skipped.
+        self->image_stream_buffer_->consumed =
+            (int32_t)self->image_stream_sequence_;
       }
 
       auto* buf = self->image_stream_buffer_;
-      buf->ready = 0;
-
-      if (stride == width * 4) {
-        memcpy(buf->pixels, map.data, frame_size);
+      if (unchanged && self->stream_in_sync_) {
+        // The buffer already holds this picture. Only once Dart has read
+        // it, tell Dart nothing changed; until then it is still news.
+        if (buf->consumed == (int32_t)self->image_stream_sequence_) {
+          MarkImageStreamUnchanged(buf, ++self->image_stream_sequence_);
+          cb(self->camera_id_);
+        }
       } else {
-        for (int row = 0; row < height; row++) {
-          memcpy(buf->pixels + row * width * 4, map.data + row * stride,
-                 width * 4);
+        // Dart stores the sequence it last read in |consumed|. If that is
+        // not the frame we are about to overwrite, Dart never saw it.
+        if (self->image_stream_sequence_ > 0 &&
+            buf->consumed != (int32_t)self->image_stream_sequence_) {
+          StatsBump(self->stats_.stream_skipped);
         }
+        PublishImageStreamFrame(buf, map.data, width, height, stride,
+                                ++self->image_stream_sequence_);
+        StatsBump(self->stats_.stream_published);
+        // Unless the frame was decimated from the preview, and so not
+        // committed, the buffer now matches the reference.
+        self->stream_in_sync_ = !changed || update_preview;
+
+        cb(self->camera_id_);
       }
-
-      buf->width = width;
-      buf->height = height;
-      buf->bytes_per_row = width * 4;
-      buf->format = 1;  // RGBA (Linux GStreamer pipeline)
-      buf->sequence = ++self->image_stream_sequence_;
-
-      // C-5: release fence — guarantees all pixel and metadata writes above
-      // are visible to any thread that subsequently observes ready == 1.
-      std::atomic_thread_fence(std::memory_order_release);
-      buf->ready = 1;
-
-      cb(self->camera_id_);
-    } else {
+    } else if (!unchanged) {
       // Legacy MethodChannel fallback path.
       size_t frame_size = (size_t)width * height * 4;
-      uint8_t* frame_copy = (uint8_t*)g_malloc(frame_size);
-      if (stride == width * 4) {
-        memcpy(frame_copy, map.data, frame_size);
-      } else {
-        for (int row = 0; row < height; row++) {
-          memcpy(frame_copy + row * width * 4, map.data + row * stride,
-                 width * 4);
-        }
-      }
+      uint8_t* frame_copy = self->allocator_->Allocate(frame_size);
+      CopyFrameRows(frame_copy, map.data, (size_t)width * 4, height, stride);
 
       struct ImageStreamData {
+        // Keeps the allocator alive should the camera go first.
+        std::shared_ptr<FrameAllocator> allocator;
         FlMethodChannel* channel;
         int camera_id;
         uint8_t* pixels;
@@ -313,6 +517,7 @@ GstFlowReturn Camera::OnNewSample(GstAppSink* sink, gpointer user_data) {
       };
 
       auto* stream_data = new ImageStreamData();
+      stream_data->allocator = self->allocator_;
       stream_data->channel = self->method_channel_;
       stream_data->camera_id = self->camera_id_;
       stream_data->pixels = frame_copy;
@@ -338,7 +543,7 @@ GstFlowReturn Camera::OnNewSample(GstAppSink* sink, gpointer user_data) {
             fl_method_channel_invoke_method(data->channel, "imageStreamFrame",
                                             args, nullptr, nullptr, nullptr);
 
-            g_free(data->pixels);
+            data->allocator->Release(data->pixels, data->size);
             delete data;
             return G_SOURCE_REMOVE;
           },
@@ -365,8 +570,7 @@ GstFlowReturn Camera::OnNewSample(GstAppSink* sink, gpointer user_data) {
   return GST_FLOW_OK;
 }
 
-gboolean Camera::OnBusMessage(GstBus* bus, GstMessage* msg,
-                              gpointer user_data) {
+void Camera::OnSessionMessage(GstMessage* msg, gpointer user_data) {
   Camera* self = static_cast<Camera*>(user_data);
 
   switch (GST_MESSAGE_TYPE(msg)) {
@@ -379,6 +583,7 @@ gboolean Camera::OnBusMessage(GstBus* bus, GstMessage* msg,
       CameraState s = self->state_.load();
       if (s == CameraState::kInitializing) {
         self->RespondToPendingInit(false, err->message);
+        self->ReleaseBranch();
         self->state_.store(CameraState::kCreated);
       } else if (s == CameraState::kRunning || s == CameraState::kPaused) {
         self->SendError(err->message);
@@ -388,6 +593,14 @@ gboolean Camera::OnBusMessage(GstBus* bus, GstMessage* msg,
       g_free(debug);
       break;
     }
+    case GST_MESSAGE_APPLICATION: {
+      const GstStructure* structure = gst_message_get_structure(msg);
+      if (structure && gst_structure_has_name(
+                           structure, CaptureSession::kReconnectMessage)) {
+        self->OnReconnectMessage(structure);
+      }
+      break;
+    }
     case GST_MESSAGE_EOS: {
       // End of stream (e.g., device unplugged).
       CameraState s = self->state_.load();
@@ -399,7 +612,6 @@ gboolean Camera::OnBusMessage(GstBus* bus, GstMessage* msg,
     default:
       break;
   }
-  return TRUE;
 }
 
 gboolean Camera::OnInitTimeout(gpointer user_data) {
@@ -409,14 +621,454 @@ gboolean Camera::OnInitTimeout(gpointer user_data) {
   if (self->state_.load() == CameraState::kInitializing) {
     self->RespondToPendingInit(
         false, "Camera initialization timed out — no frames received");
-    if (self->pipeline_) {
-      gst_element_set_state(self->pipeline_, GST_STATE_NULL);
-    }
+    // Other cameras on the same device keep streaming; only this branch
+    // goes away. The device stops if this was its only camera.
+    self->ReleaseBranch();
     self->state_.store(CameraState::kCreated);
   }
   return G_SOURCE_REMOVE;
 }
 
+GstPadProbeReturn Camera::OnAppsinkBuffer(GstPad* pad, GstPadProbeInfo* info,
+                                          gpointer user_data) {
+  // Same streaming thread as OnNewSample, so the single-writer rule holds.
+  StatsBump(static_cast<Camera*>(user_data)->stats_.frames_arrived);
+  return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn Camera::OnBranchInput(GstPad* pad, GstPadProbeInfo* info,
+                                        gpointer user_data) {
+  Camera* self = static_cast<Camera*>(user_data);
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent* event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+      GstCaps* caps = nullptr;
+      gst_event_parse_caps(event, &caps);
+      self->input_info_valid_ =
+          gst_video_info_from_caps(&self->input_info_, caps);
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  gint64 now_us = g_get_monotonic_time();
+  bool pass;
+  GstMapInfo map;
+  if (self->adaptive_rate_.needs_pixels() && self->input_info_valid_ &&
+      gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    pass = self->adaptive_rate_.ShouldPass(
+        map.data, GST_VIDEO_INFO_WIDTH(&self->input_info_),
+        GST_VIDEO_INFO_HEIGHT(&self->input_info_),
+        GST_VIDEO_INFO_PLANE_STRIDE(&self->input_info_, 0), now_us);
+    gst_buffer_unmap(buffer, &map);
+  } else {
+    pass = self->adaptive_rate_.ShouldPass(nullptr, 0, 0, 0, now_us);
+  }
+  return pass ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
+}
+
+namespace {
+
+FlValue* HistogramToFlValue(const LatencyHistogram::Snapshot& h) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "count", fl_value_new_int(h.count));
+  fl_value_set_string_take(map, "meanUs", fl_value_new_float(h.MeanUs()));
+  fl_value_set_string_take(map, "p50Us", fl_value_new_int(h.Percentile(0.5)));
+  fl_value_set_string_take(map, "p99Us",
+                           fl_value_new_int(h.Percentile(0.99)));
+  fl_value_set_string_take(map, "maxUs", fl_value_new_int(h.max_us));
+  // Log2 buckets, trimmed after the last non-empty one.
+  int last = LatencyHistogram::kBuckets - 1;
+  while (last >= 0 && h.buckets[last] == 0) last--;
+  FlValue* buckets = fl_value_new_list();
+  for (int i = 0; i <= last; i++) {
+    fl_value_append_take(buckets, fl_value_new_int(h.buckets[i]));
+  }
+  fl_value_set_string_take(map, "log2Buckets", buckets);
+  return map;
+}
+
+}  // namespace
+
+FlValue* Camera::GetStats() {
+  uint64_t arrived = stats_.frames_arrived.load(std::memory_order_relaxed);
+  uint64_t captured = stats_.frames_captured.load(std::memory_order_relaxed);
+  uint64_t preview = stats_.preview_updated.load(std::memory_order_relaxed);
+
+  gint64 now_us = g_get_monotonic_time();
+  double window_s = stats_last_report_us_ > 0
+                        ? (now_us - stats_last_report_us_) / 1e6
+                        : 0.0;
+
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "cameraId", fl_value_new_int(camera_id_));
+  fl_value_set_string_take(result, "framesCaptured",
+                           fl_value_new_int(captured));
+  fl_value_set_string_take(result, "framesPreviewUpdated",
+                           fl_value_new_int(preview));
+  // A frame can be between the probe and OnNewSample; never report that
+  // one as dropped.
+  fl_value_set_string_take(
+      result, "framesAppsinkDropped",
+      fl_value_new_int(arrived > captured + 1 ? arrived - captured - 1 : 0));
+  fl_value_set_string_take(
+      result, "framesPreviewDecimated",
+      fl_value_new_int(
+          stats_.preview_decimated.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(
+      result, "framesStreamed",
+      fl_value_new_int(
+          stats_.stream_published.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(
+      result, "framesStreamSkipped",
+      fl_value_new_int(stats_.stream_skipped.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(
+      result, "captureFps",
+      fl_value_new_float(window_s > 0
+                             ? (captured - stats_last_captured_) / window_s
+                             : 0.0));
+  fl_value_set_string_take(
+      result, "previewFps",
+      fl_value_new_float(window_s > 0
+                             ? (preview - stats_last_preview_) / window_s
+                             : 0.0));
+  fl_value_set_string_take(result, "copyTime",
+                           HistogramToFlValue(stats_.copy_time.Read()));
+  fl_value_set_string_take(
+      result, "captureToTextureLatency",
+      HistogramToFlValue(stats_.capture_to_texture.Read()));
+
+  guint queue_buffers = 0;
+  guint64 queue_time_ns = 0;
+  if (record_handler_->is_recording() &&
+      record_handler_->GetQueueLevel(&queue_buffers, &queue_time_ns)) {
+    fl_value_set_string_take(result, "encoderQueueDepth",
+                             fl_value_new_int(queue_buffers));
+    fl_value_set_string_take(
+        result, "encoderQueueMs",
+        fl_value_new_int(GST_TIME_AS_MSECONDS(queue_time_ns)));
+  }
+
+  fl_value_set_string_take(result, "reconnects",
+                           fl_value_new_int(reconnects_));
+  if (last_recovery_us_ > 0) {
+    fl_value_set_string_take(result, "lastRecoveryUs",
+                             fl_value_new_int(last_recovery_us_));
+  }
+
+  fl_value_set_string_take(
+      result, "framesUnchanged",
+      fl_value_new_int(
+          stats_.frames_unchanged.load(std::memory_order_relaxed)));
+  fl_value_set_string_take(result, "adaptiveIdle",
+                           fl_value_new_bool(adaptive_rate_.idle()));
+  fl_value_set_string_take(
+      result, "framesIdleSkipped",
+      fl_value_new_int(adaptive_rate_.frames_skipped()));
+  fl_value_set_string_take(result, "standby",
+                           fl_value_new_bool(standby_.load()));
+  gint64 last_wake_us = last_wake_us_.load();
+  if (last_wake_us > 0) {
+    fl_value_set_string_take(result, "lastWakeUs",
+                             fl_value_new_int(last_wake_us));
+  }
+
+  fl_value_set_string_take(
+      result, "idleBufferReleases",
+      fl_value_new_int(idle_releases_.load(std::memory_order_relaxed)));
+  FrameAllocator::Usage memory = allocator_->usage();
+  fl_value_set_string_take(result, "frameMemoryBytes",
+                           fl_value_new_int(memory.resident_bytes));
+  fl_value_set_string_take(result, "frameMemoryHugePageBytes",
+                           fl_value_new_int(memory.huge_page_bytes));
+  fl_value_set_string_take(result, "frameBufferAllocations",
+                           fl_value_new_int(memory.allocations));
+  fl_value_set_string_take(result, "frameBufferReuses",
+                           fl_value_new_int(memory.reuses));
+
+  stats_last_report_us_ = now_us;
+  stats_last_captured_ = captured;
+  stats_last_preview_ = preview;
+  return result;
+}
+
+bool Camera::SetLatencyTracing(bool enabled) {
+  if (!enabled) {
+    latency_tracer_.reset();
+    return true;
+  }
+  if (!branch_ || !session_ || !session_->pipeline()) return false;
+  if (latency_tracer_) return true;
+
+  latency_tracer_ = std::make_unique<LatencyTracer>();
+  // Top-level children of the session are the shared source elements (other
+  // cameras' branch bins are skipped); then this camera's own branch.
+  latency_tracer_->Instrument(GST_BIN(session_->pipeline()),
+                              LatencyTracer::Stage::kCapture);
+  latency_tracer_->Instrument(GST_BIN(branch_), LatencyTracer::Stage::kBranch);
+  return true;
+}
+
+FlValue* Camera::GetPipelineLatency() {
+  if (!latency_tracer_) return nullptr;
+
+  FlValue* result = fl_value_new_list();
+  for (const auto& element : latency_tracer_->Report()) {
+    FlValue* entry = fl_value_new_map();
+    fl_value_set_string_take(entry, "element",
+                             fl_value_new_string(element.name.c_str()));
+    fl_value_set_string_take(entry, "factory",
+                             fl_value_new_string(element.factory.c_str()));
+    fl_value_set_string_take(entry, "kind",
+                             fl_value_new_string(element.kind.c_str()));
+    fl_value_set_string_take(
+        entry, "stage",
+        fl_value_new_string(LatencyTracer::StageName(element.stage)));
+    fl_value_set_string_take(entry, "latency",
+                             HistogramToFlValue(element.latency));
+    fl_value_append_take(result, entry);
+  }
+  return result;
+}
+
+void Camera::SetStatsInterval(int interval_ms) {
+  if (stats_timer_id_ > 0) {
+    g_source_remove(stats_timer_id_);
+    stats_timer_id_ = 0;
+  }
+  if (interval_ms > 0) {
+    stats_timer_id_ = g_timeout_add(interval_ms, Camera::OnStatsTimer, this);
+  }
+}
+
+gboolean Camera::OnStatsTimer(gpointer user_data) {
+  Camera* self = static_cast<Camera*>(user_data);
+  g_autoptr(FlValue) args = self->GetStats();
+  fl_method_channel_invoke_method(self->method_channel_, "cameraStats", args,
+                                  nullptr, nullptr, nullptr);
+  return G_SOURCE_CONTINUE;
+}
+
+void Camera::SetMemoryBudget(size_t bytes) {
+  memory_budget_ = bytes;
+  if (bytes > 0 && memory_timer_id_ == 0) {
+    memory_timer_id_ = g_timeout_add_seconds(1, Camera::OnMemoryTimer, this);
+  } else if (bytes == 0 && memory_timer_id_ > 0) {
+    g_source_remove(memory_timer_id_);
+    memory_timer_id_ = 0;
+  }
+  ApplyMemoryBudget();
+}
+
+gboolean Camera::OnMemoryTimer(gpointer user_data) {
+  static_cast<Camera*>(user_data)->ApplyMemoryBudget();
+  return G_SOURCE_CONTINUE;
+}
+
+void Camera::ApplyMemoryBudget() {
+  size_t frame = (size_t)actual_width_.load() * actual_height_.load() * 4;
+  bool double_buffered = false;
+  bool reduced = false;
+  size_t queue_max = RecordHandler::kDefaultQueueMaxBytes;
+
+  // Planned from frame sizes rather than measured, so a degradation does
+  // not undo itself by bringing the usage back under the budget.
+  if (memory_budget_ > 0 && frame > 0) {
+    size_t stream = image_stream_buffer_size_.load();
+    if (stream == 0 && image_streaming_.load()) {
+      stream = offsetof(ImageStreamBuffer, pixels) + frame;
+    }
+    // The queue gives way first, down to its minimum while recording; the
+    // texture shrinks only if the frames still do not fit.
+    size_t queue_min =
+        record_handler_->is_recording() ? RecordHandler::kMinQueueMaxBytes : 0;
+    size_t texture = 3 * frame;
+    if (stream + texture + queue_min > memory_budget_) {
+      double_buffered = true;
+      texture = 2 * frame;
+    }
+    if (stream + texture + queue_min > memory_budget_) {
+      reduced = true;
+      texture = 2 * (frame / 4);
+    }
+    size_t room = memory_budget_ > stream + texture
+                      ? memory_budget_ - stream - texture
+                      : 0;
+    if (room < queue_max) queue_max = room;
+  }
+
+  record_handler_->SetQueueMaxBytes((guint)queue_max);
+  // Both texture changes take effect with the next texture update; make
+  // sure one comes even if static-frame skipping holds back a still scene.
+  bool texture_changed = false;
+  if (texture_ && double_buffered != texture_double_buffered_) {
+    camera_texture_set_buffer_count(texture_, double_buffered ? 2 : 3);
+    texture_double_buffered_ = double_buffered;
+    texture_changed = true;
+  }
+  if (preview_reduced_.exchange(reduced) != reduced) texture_changed = true;
+  if (texture_changed) change_reset_.store(true);
+
+  // Buffers given up by a degradation, and recycled temporaries, wait in the
+  // allocator's free list; over budget, return them to the system.
+  if (memory_budget_ > 0 && MemoryInUse() > memory_budget_) {
+    allocator_->Trim();
+  }
+}
+
+void Camera::SetIdleBufferRelease(int idle_ms) {
+  idle_release_ms_ = idle_ms;
+  if (idle_ms > 0 && idle_timer_id_ == 0) {
+    idle_timer_id_ = g_timeout_add_seconds(1, Camera::OnIdleTimer, this);
+  } else if (idle_ms == 0 && idle_timer_id_ > 0) {
+    g_source_remove(idle_timer_id_);
+    idle_timer_id_ = 0;
+  }
+}
+
+gboolean Camera::OnIdleTimer(gpointer user_data) {
+  static_cast<Camera*>(user_data)->CheckIdleBuffers();
+  return G_SOURCE_CONTINUE;
+}
+
+void Camera::CheckIdleBuffers() {
+  gint64 now_us = g_get_monotonic_time();
+  gint64 delay_us = (gint64)idle_release_ms_ * 1000;
+
+  if (!preview_paused_.load() && !standby_.load()) {
+    preview_idle_since_us_ = 0;
+    preview_trimmed_ = false;
+  } else if (preview_idle_since_us_ == 0) {
+    preview_idle_since_us_ = now_us;
+  }
+  if (image_streaming_.load()) {
+    stream_idle_since_us_ = 0;
+    stream_trimmed_ = false;
+  } else if (stream_idle_since_us_ == 0) {
+    stream_idle_since_us_ = now_us;
+  }
+
+  int what = 0;
+  if (preview_idle_since_us_ > 0 && !preview_trimmed_ &&
+      now_us - preview_idle_since_us_ >= delay_us) {
+    preview_trimmed_ = true;
+    what |= kTrimTexture;
+  }
+  if (stream_idle_since_us_ > 0 && !stream_trimmed_ &&
+      now_us - stream_idle_since_us_ >= delay_us) {
+    stream_trimmed_ = true;
+    if (image_stream_buffer_size_.load() > 0) what |= kTrimStream;
+  }
+  if (what == 0) return;
+
+  // With the device stopped for standby there is no streaming thread to
+  // hand the trim to, and none to race with.
+  if (standby_.load() && session_ && session_->standby()) {
+    TrimIdleBuffers(what);
+  } else {
+    trim_requested_.fetch_or(what);
+  }
+}
+
+void Camera::TrimIdleBuffers(int what) {
+  // Rechecked here: the preview or the stream may have resumed since.
+  bool released = false;
+  if ((what & kTrimTexture) && texture_ &&
+      (preview_paused_.load() || standby_.load())) {
+    camera_texture_trim(texture_);
+    released = true;
+  }
+  if ((what & kTrimStream) && image_stream_buffer_ &&
+      !image_streaming_.load()) {
+    allocator_->Release(image_stream_buffer_, image_stream_buffer_size_);
+    image_stream_buffer_ = nullptr;
+    image_stream_buffer_size_ = 0;
+    released = true;
+  }
+  if (!released) return;
+  allocator_->Trim();
+  idle_releases_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t Camera::MemoryInUse() const {
+  return allocator_->usage().resident_bytes +
+         record_handler_->GetQueueBytes();
+}
+
+FlValue* Camera::GetMemoryUsage() {
+  FrameAllocator::Usage usage = allocator_->usage();
+  size_t texture = texture_ ? camera_texture_get_memory(texture_) : 0;
+  size_t stream = image_stream_buffer_size_.load();
+  size_t owned = texture + stream;
+  size_t queue = record_handler_->GetQueueBytes();
+
+  FlValue* result = fl_value_new_map();
+  fl_value_set_string_take(result, "cameraId", fl_value_new_int(camera_id_));
+  fl_value_set_string_take(result, "texture", fl_value_new_int(texture));
+  fl_value_set_string_take(result, "imageStream", fl_value_new_int(stream));
+  // Temporaries handed out and not yet back: method-channel frames waiting
+  // for the main thread, the repack buffer mid-frame.
+  fl_value_set_string_take(
+      result, "inFlight",
+      fl_value_new_int(usage.in_use_bytes > owned ? usage.in_use_bytes - owned
+                                                  : 0));
+  fl_value_set_string_take(
+      result, "recycled",
+      fl_value_new_int(usage.resident_bytes - usage.in_use_bytes));
+  fl_value_set_string_take(result, "recordingQueue", fl_value_new_int(queue));
+  fl_value_set_string_take(
+      result, "recordingQueueLimit",
+      fl_value_new_int(record_handler_->queue_max_bytes()));
+  fl_value_set_string_take(result, "total",
+                           fl_value_new_int(usage.resident_bytes + queue));
+  fl_value_set_string_take(result, "budget",
+                           fl_value_new_int(memory_budget_));
+
+  FlValue* degradations = fl_value_new_list();
+  if (record_handler_->queue_max_bytes() <
+      RecordHandler::kDefaultQueueMaxBytes) {
+    fl_value_append_take(degradations,
+                         fl_value_new_string("recordingQueue"));
+  }
+  if (texture_double_buffered_) {
+    fl_value_append_take(degradations, fl_value_new_string("doubleBuffer"));
+  }
+  if (preview_reduced_.load()) {
+    fl_value_append_take(degradations,
+                         fl_value_new_string("reducedPreview"));
+  }
+  fl_value_set_string_take(result, "degradations", degradations);
+  return result;
+}
+
+void Camera::OnReconnectMessage(const GstStructure* structure) {
+  const char* state = gst_structure_get_string(structure, "state");
+  if (!state) return;
+  int attempts = 0;
+  gint64 downtime_us = 0;
+  gst_structure_get_int(structure, "attempts", &attempts);
+  gst_structure_get_int64(structure, "downtime-us", &downtime_us);
+  if (strcmp(state, "recovered") == 0) {
+    reconnects_++;
+    last_recovery_us_ = downtime_us;
+  }
+
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "cameraId", fl_value_new_int(camera_id_));
+  fl_value_set_string_take(args, "state", fl_value_new_string(state));
+  fl_value_set_string_take(args, "attempts", fl_value_new_int(attempts));
+  if (downtime_us > 0) {
+    fl_value_set_string_take(args, "downtimeUs",
+                             fl_value_new_int(downtime_us));
+  }
+  fl_method_channel_invoke_method(method_channel_, "cameraReconnect", args,
+                                  nullptr, nullptr, nullptr);
+}
+
+void Camera::SetReconnectPolicy(const ReconnectPolicy& policy) {
+  if (session_) session_->SetReconnectPolicy(policy);
+}
+
 void Camera::SendError(const std::string& description) {
   g_autoptr(FlValue) args = fl_value_new_map();
   fl_value_set_string_take(args, "cameraId",
@@ -435,6 +1087,12 @@ void Camera::TakePicture(FlMethodCall* method_call) {
                                  "Camera is not running", details, nullptr);
     return;
   }
+  if (standby_.load()) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "standby",
+                                 "Camera is in standby", details, nullptr);
+    return;
+  }
 
   // Generate a unique temporary file path using an atomic sequence counter
   // rather than the wall clock to prevent collisions under NTP corrections.
@@ -513,13 +1171,19 @@ void Camera::StartVideoRecording(FlMethodCall* method_call) {
                                  "Camera is not running", details, nullptr);
     return;
   }
+  if (standby_.load()) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "standby",
+                                 "Camera is in standby", details, nullptr);
+    return;
+  }
 
   // Set up the recording branch on first use.
   if (!record_handler_->is_recording()) {
     GError* error = nullptr;
     // H-2: load actual dimensions atomically — they are written from the
     // GStreamer streaming thread on first frame.
-    if (!record_handler_->Setup(pipeline_, tee_,
+    if (!record_handler_->Setup(branch_, tee_,
                                 actual_width_.load(), actual_height_.load(),
                                 config_.target_fps,
                                 config_.target_bitrate,
@@ -537,6 +1201,11 @@ void Camera::StartVideoRecording(FlMethodCall* method_call) {
       SendError("Audio recording was requested but audio setup failed. "
                 "Recording will continue without audio.");
     }
+    // Pick up the recording elements that were just added to the branch.
+    if (latency_tracer_) {
+      latency_tracer_->Instrument(GST_BIN(branch_),
+                                  LatencyTracer::Stage::kBranch);
+    }
   }
 
   // H-6: derive extension from the muxer that was actually selected so the
@@ -548,8 +1217,11 @@ void Camera::StartVideoRecording(FlMethodCall* method_call) {
       rec_seq.fetch_add(1, std::memory_order_relaxed),
       record_handler_->output_extension());
 
+  // The recording needs every frame.
+  adaptive_rate_.SetHoldFullRate(true);
   GError* error = nullptr;
   if (!record_handler_->StartRecording(tmp_path, &error)) {
+    adaptive_rate_.SetHoldFullRate(false);
     g_autoptr(FlValue) details = fl_value_new_null();
     fl_method_call_respond_error(
         method_call, "recording_start_failed",
@@ -573,9 +1245,38 @@ void Camera::StopVideoRecording(FlMethodCall* method_call) {
   }
 
   record_handler_->StopRecording(method_call);
+  adaptive_rate_.SetHoldFullRate(false);
+}
+
+void Camera::SwitchSource(std::shared_ptr<CaptureSession> session,
+                          FlMethodCall* method_call) {
+  CameraState s = state_.load();
+  if (s != CameraState::kRunning && s != CameraState::kPaused) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "not_running",
+                                 "Camera is not running", details, nullptr);
+    return;
+  }
+
+  // The switcher is owned by this camera and fails a pending switch when the
+  // branch is released, so the call is always answered.
+  FlMethodCall* call = FL_METHOD_CALL(g_object_ref(method_call));
+  source_switcher_->SwitchTo(
+      std::move(session), [call](bool success, const std::string& error) {
+        if (success) {
+          fl_method_call_respond_success(call, nullptr, nullptr);
+        } else {
+          g_autoptr(FlValue) details = fl_value_new_null();
+          fl_method_call_respond_error(call, "switch_failed", error.c_str(),
+                                       details, nullptr);
+        }
+        g_object_unref(call);
+      });
 }
 
 void Camera::StartImageStream() {
+  // The stream buffer may hold an older frame than the detector's reference.
+  change_reset_.store(true);
   image_streaming_ = true;
 }
 
@@ -600,15 +1301,71 @@ void Camera::PausePreview() {
 }
 
 void Camera::ResumePreview() {
+  // The texture lags the detector's reference after a pause.
+  change_reset_.store(true);
   preview_paused_.store(false);
 }
 
+void Camera::SetAdaptiveFrameRate(const AdaptiveRateConfig& config) {
+  adaptive_rate_.Configure(config);
+}
+
+void Camera::SetAppHidden(bool hidden) {
+  adaptive_rate_.SetHidden(hidden);
+}
+
+void Camera::SetStaticFrameSkipping(bool enabled, int threshold) {
+  change_reset_.store(true);
+  static_skip_threshold_.store(enabled ? threshold : -1);
+}
+
+bool Camera::SetStandby(bool standby, std::string* error) {
+  CameraState s = state_.load();
+  if (s != CameraState::kRunning && s != CameraState::kPaused) {
+    *error = "Camera is not running";
+    return false;
+  }
+  if (standby == standby_.load()) return true;
+  if (standby) {
+    if (record_handler_->is_recording()) {
+      *error = "Cannot enter standby while recording";
+      return false;
+    }
+    standby_.store(true);
+    session_->SetBranchStandby(branch_, true, nullptr);
+    return true;
+  }
+
+  wake_requested_us_.store(g_get_monotonic_time());
+  GError* gerror = nullptr;
+  if (!session_->SetBranchStandby(branch_, false, &gerror)) {
+    *error = gerror ? gerror->message : "Failed to leave standby";
+    if (gerror) g_error_free(gerror);
+    wake_requested_us_.store(0);
+    return false;
+  }
+  standby_.store(false);
+  return true;
+}
+
 void Camera::SetMirror(bool mirrored) {
   if (!videoflip_) return;
   // GstVideoFlipMethod: 0 = none (identity), 4 = horizontal-flip
   g_object_set(videoflip_, "method", mirrored ? 4 : 0, nullptr);
 }
 
+std::map<ThreadRole, std::string> Camera::SetThreadSchedule(
+    const CameraThreadSchedule& schedule, std::string* error) {
+  thread_schedule_ = schedule;
+  if (!branch_ || !session_) {
+    // Applied by Initialize once the branch is attached.
+    return {{ThreadRole::kCapture, "pending"},
+            {ThreadRole::kConvert, "pending"},
+            {ThreadRole::kEncode, "pending"}};
+  }
+  return session_->SetBranchSchedule(branch_, schedule, error);
+}
+
 void Camera::Dispose() {
   // C-2: use atomic exchange so the check-and-set is race-free. If two threads
   // somehow call Dispose() concurrently, only one proceeds.
@@ -617,6 +1374,13 @@ void Camera::Dispose() {
     return;
   }
 
+  SetStatsInterval(0);
+  if (memory_timer_id_ > 0) {
+    g_source_remove(memory_timer_id_);
+    memory_timer_id_ = 0;
+  }
+  SetIdleBufferRelease(0);
+
   // Cancel pending init if still waiting (main thread → main thread, safe).
   if (pending_init_call_) {
     RespondToPendingInit(false, "Camera disposed during initialization");
@@ -627,32 +1391,25 @@ void Camera::Dispose() {
   // but does NOT free the buffer yet — that must wait until the pipeline stops.
   image_stream_callback_.store(nullptr);
 
-  // C-1 FIX: stop the pipeline BEFORE freeing image_stream_buffer_.
-  // gst_element_set_state(NULL) blocks until the GStreamer streaming thread
-  // (which runs OnNewSample and accesses image_stream_buffer_) is fully
-  // stopped. Freeing before this point was a use-after-free.
-  if (pipeline_) {
-    videoflip_ = nullptr;
-    gst_element_set_state(pipeline_, GST_STATE_NULL);
-    if (bus_watch_id_ > 0) {
-      g_source_remove(bus_watch_id_);
-      bus_watch_id_ = 0;
-    }
-    gst_object_unref(pipeline_);
-    pipeline_ = nullptr;
-    appsink_ = nullptr;
-  }
+  // C-1 FIX: stop the branch BEFORE freeing image_stream_buffer_.
+  // Detaching sets the branch to NULL, which blocks until the GStreamer
+  // streaming thread (which runs OnNewSample and accesses
+  // image_stream_buffer_) is fully stopped. Freeing before this point was a
+  // use-after-free.
+  ReleaseBranch();
+  // Drop our share of the device; the last camera out closes it.
+  session_.reset();
 
   // Now safe: the GStreamer streaming thread is guaranteed to have exited
   // OnNewSample and will never access image_stream_buffer_ again.
   if (image_stream_buffer_) {
-    g_free(image_stream_buffer_);
+    allocator_->Release(image_stream_buffer_, image_stream_buffer_size_);
     image_stream_buffer_ = nullptr;
     image_stream_buffer_size_ = 0;
   }
 
-  // Unregister the texture.
-  if (texture_ && texture_registrar_) {
+  // Unregister the texture, unless it is handed on.
+  if (texture_ && texture_registrar_ && !keep_texture_) {
     fl_texture_registrar_unregister_texture(
         texture_registrar_, camera_texture_as_fl_texture(texture_));
     g_object_unref(texture_);
@@ -668,3 +1425,12 @@ void Camera::Dispose() {
 
   state_.store(CameraState::kDisposed);
 }
+
+CameraTexture* Camera::DisposeKeepingTexture() {
+  keep_texture_ = true;
+  Dispose();
+  // The streaming thread is gone, so nothing else touches it any more.
+  CameraTexture* texture = texture_;
+  texture_ = nullptr;
+  return texture;
+}
@@ -4,14 +4,25 @@
 #include <flutter_linux/flutter_linux.h>
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
+#include <gst/video/video.h>
 
 #include <atomic>
+#include <map>
 #include <memory>
 #include <string>
 
+#include "adaptive_rate.h"
+#include "camera_stats.h"
 #include "camera_texture.h"
+#include "capture_session.h"
 #include "device_enumerator.h"
+#include "frame_allocator.h"
+#include "frame_change.h"
+#include "frame_copy.h"
+#include "latency_tracer.h"
+#include "preview_decimator.h"
 #include "record_handler.h"
+#include "source_switcher.h"
 
 enum class CameraState {
   kCreated,
@@ -22,38 +33,62 @@ enum class CameraState {
   kDisposed,
 };
 
+// Plugin-side cold-start timestamps (g_get_monotonic_time, 0 when not
+// recorded), handed to the Camera so initialize can report the full
+// breakdown. The camera records the later phases itself.
+struct StartupTimeline {
+  gint64 gst_init_start_us = 0;
+  gint64 gst_init_end_us = 0;
+  gint64 create_start_us = 0;
+  gint64 enumerated_us = 0;  // Device and resolution lookup done.
+  bool pooled = false;  // Session and texture came from the camera pool.
+};
+
 // Alias for the image-stream callback function pointer type.
 using ImageStreamCallback = void (*)(int32_t);
 
-struct CameraConfig {
-  std::string device_path;
-  int resolution_preset;
-  bool enable_audio;
-  int target_width;
-  int target_height;
-  int target_fps;
-  int target_bitrate;
-  int audio_bitrate = 0;
-};
-
+// A logical camera: one Flutter texture, mirror state, image stream and
+// recording. Several Cameras may share the same device through a
+// CaptureSession; each attaches its own branch to the session's tee.
 class Camera {
  public:
   Camera(int camera_id,
          FlTextureRegistrar* texture_registrar,
          FlMethodChannel* method_channel,
-         const CameraConfig& config);
+         const CameraConfig& config,
+         std::shared_ptr<CaptureSession> session);
   ~Camera();
 
+  // Texture updates are capped at this rate, the display's. A camera
+  // capturing faster (high-frame-rate mode) updates its preview at about
+  // this rate, while the image stream and recording get every frame.
+  static constexpr int kPreviewMaxFps = 60;
+
   int camera_id() const { return camera_id_; }
   int64_t texture_id() const { return texture_id_; }
   CameraState state() const { return state_; }
+  const CameraConfig& config() const { return config_; }
+  const std::shared_ptr<CaptureSession>& session() const { return session_; }
+
+  // Phases recorded before the camera existed; reported by Initialize.
+  void set_startup_timeline(const StartupTimeline& timeline) {
+    startup_ = timeline;
+  }
 
   // Allocates the texture and registers it. Must be called before Initialize.
   // Returns the texture_id on success, -1 on failure.
   int64_t RegisterTexture();
 
-  // Builds and starts the GStreamer pipeline. Responds to |method_call|
-  // asynchronously once the first frame arrives or an error/timeout occurs.
+  // Takes over |texture|, already registered by an earlier camera (see
+  // DisposeKeepingTexture), in place of RegisterTexture. Its buffers are
+  // reused as they are. Returns its texture_id.
+  int64_t AdoptTexture(CameraTexture* texture);
+
+  // Builds this camera's branch and attaches it to the capture session,
+  // starting the device if it is not already streaming. Responds to
+  // |method_call| asynchronously once the first frame arrives or an
+  // error/timeout occurs. The success result carries the preview size and a
+  // "startup" map of per-phase durations (see StartupBreakdown).
   void Initialize(FlMethodCall* method_call);
 
   // Captures a still image and saves it to a temporary JPEG file.
@@ -64,12 +99,61 @@ class Camera {
   void PausePreview();
   void ResumePreview();
 
+  // Standby sits between PausePreview and Dispose. The camera stops taking
+  // frames while its texture stays registered with the last frame on it,
+  // and once no other camera streams from the device, the device stops
+  // streaming too (see CaptureSession::SetBranchStandby). Leaving standby
+  // restarts it without rebuilding anything. Not possible while recording;
+  // returns false and sets |error| on failure.
+  bool SetStandby(bool standby, std::string* error);
+  bool standby() const { return standby_; }
+
+  // Lowers the rate this camera processes frames at while the app is
+  // hidden or the scene is static (see AdaptiveFrameRate). Full rate is
+  // kept while recording.
+  void SetAdaptiveFrameRate(const AdaptiveRateConfig& config);
+  // Whether the app's window is hidden (minimized or covered), as reported
+  // by the app.
+  void SetAppHidden(bool hidden);
+
+  // Skips the texture update and image stream copy of frames that differ
+  // from the last delivered one by at most |threshold| (mean per-channel
+  // difference, see FrameChangeDetector). Stream readers see such frames
+  // as an "unchanged" sequence bump (see MarkImageStreamUnchanged).
+  void SetStaticFrameSkipping(bool enabled, int threshold);
+
+  // Caps the bytes this camera's frames may take: texture, image stream,
+  // recycled buffers and the recording queue. 0 removes the cap. Over
+  // budget the camera degrades rather than grows, in this order: a shorter
+  // recording queue, a double-buffered texture, then a preview texture at
+  // half the size. Re-planned every second, so it follows resolution,
+  // streaming and recording changes, and recovers when they allow.
+  void SetMemoryBudget(size_t bytes);
+
+  // Gives back the texture's spare frames once the preview has been paused
+  // (or in standby) for |idle_ms|, and the image stream buffer once the
+  // stream has been stopped that long, returning the memory to the system.
+  // They are allocated again with the next frame that needs them. 0 turns
+  // this off.
+  void SetIdleBufferRelease(int idle_ms);
+
+  // Bytes held per subsystem, the budget, and the degradations in effect,
+  // as a map for the method channel.
+  FlValue* GetMemoryUsage();
+
   // Starts video recording (silent — no audio).
   void StartVideoRecording(FlMethodCall* method_call);
 
   // Stops video recording and returns the file path.
   void StopVideoRecording(FlMethodCall* method_call);
 
+  // Feeds this camera from |session|'s device instead of its own, without
+  // interrupting the preview or a recording in progress (see
+  // SourceSwitcher). A null |session| switches back to the camera's own
+  // device. Responds to |method_call| once the new frames are flowing.
+  void SwitchSource(std::shared_ptr<CaptureSession> session,
+                    FlMethodCall* method_call);
+
   // Starts/stops sending raw frame data to Dart via method channel.
   void StartImageStream();
   void StopImageStream();
@@ -82,21 +166,85 @@ class Camera {
   // Toggles horizontal mirroring on the live video feed.
   void SetMirror(bool mirrored);
 
-  // Tears down the pipeline and releases all resources.
+  // Returns this camera's performance counters and histograms as a map for
+  // the method channel. Frame rates cover the time since the previous call
+  // (or the periodic push, whichever came last).
+  FlValue* GetStats();
+
+  // Pushes GetStats() to Dart as a "cameraStats" event every |interval_ms|.
+  // 0 stops the push.
+  void SetStatsInterval(int interval_ms);
+
+  // Turns per-element latency tracing on or off for this camera's path
+  // through the pipeline: the shared source elements, its own branch, and
+  // the recording elements once recording starts. Only possible while the
+  // branch is attached; returns false otherwise.
+  bool SetLatencyTracing(bool enabled);
+
+  // Per-element latency breakdown as a list for the method channel, or
+  // nullptr when tracing is off.
+  FlValue* GetPipelineLatency();
+
+  // Sets the scheduling policy and CPU affinity of this camera's capture,
+  // convert and encode threads. Takes effect on running threads right away
+  // and is re-applied whenever the branch is (re)attached. Returns what took
+  // effect per role (see CaptureSession::SetBranchSchedule).
+  std::map<ThreadRole, std::string> SetThreadSchedule(
+      const CameraThreadSchedule& schedule, std::string* error);
+
+  // Sets how this camera's device recovers from a disconnect or stream
+  // error (see ReconnectPolicy). Shared with every camera on the device.
+  void SetReconnectPolicy(const ReconnectPolicy& policy);
+
+  // Detaches this camera's branch and releases all resources. The device
+  // stays open while other cameras still share the session.
   void Dispose();
 
+  // Dispose(), except that the texture stays registered and is returned
+  // with its reference, for a later camera to adopt. Returns nullptr if the
+  // camera never had one.
+  CameraTexture* DisposeKeepingTexture();
+
  private:
-  bool BuildPipeline(GError** error);
+  bool BuildBranch(GError** error);
+  void ReleaseBranch();
   void RespondToPendingInit(bool success, const char* error_message);
+  // Per-phase cold-start durations in microseconds, for the initialize
+  // response. Phases this camera did not go through (the device was already
+  // streaming for another camera) are left out.
+  FlValue* StartupBreakdown() const;
 
   // GStreamer callbacks (static with user_data = Camera*).
   static GstFlowReturn OnNewSample(GstAppSink* sink, gpointer user_data);
-  static gboolean OnBusMessage(GstBus* bus, GstMessage* msg,
-                               gpointer user_data);
+  static void OnSessionMessage(GstMessage* msg, gpointer user_data);
   static gboolean OnInitTimeout(gpointer user_data);
+  static GstPadProbeReturn OnAppsinkBuffer(GstPad* pad, GstPadProbeInfo* info,
+                                           gpointer user_data);
+  // On the branch's input, on the session's streaming thread: drops the
+  // frames adaptive_rate_ declines.
+  static GstPadProbeReturn OnBranchInput(GstPad* pad, GstPadProbeInfo* info,
+                                         gpointer user_data);
+  static gboolean OnStatsTimer(gpointer user_data);
+  static gboolean OnMemoryTimer(gpointer user_data);
+  static gboolean OnIdleTimer(gpointer user_data);
+  // Tracks how long the preview and the stream have been idle and asks
+  // for their buffers to be trimmed once due.
+  void CheckIdleBuffers();
+  // Trims the buffers in |what| (kTrimTexture, kTrimStream) that are still
+  // idle. Runs on the streaming thread at the start of a frame, or on the
+  // main thread while no frames flow.
+  static constexpr int kTrimTexture = 1;
+  static constexpr int kTrimStream = 2;
+  void TrimIdleBuffers(int what);
+  // Plans the degradations memory_budget_ needs and applies them.
+  void ApplyMemoryBudget();
+  // Bytes held now: the allocator's buffers and the recording queue.
+  size_t MemoryInUse() const;
 
   // Sends an error event to Dart via the method channel.
   void SendError(const std::string& description);
+  // Relays a CaptureSession::kReconnectMessage to Dart as "cameraReconnect".
+  void OnReconnectMessage(const GstStructure* structure);
 
   int camera_id_;
   int64_t texture_id_;
@@ -108,15 +256,25 @@ class Camera {
   FlTextureRegistrar* texture_registrar_;  // Not owned.
   FlMethodChannel* method_channel_;        // Not owned.
   CameraTexture* texture_;                 // Owned (GObject ref).
+  bool keep_texture_ = false;              // See DisposeKeepingTexture.
+  // Serves every frame buffer of the camera, the texture's included. An
+  // adopted texture brings its own, which replaces this one.
+  std::shared_ptr<FrameAllocator> allocator_;
 
-  GstElement* pipeline_;
-  GstElement* tee_;       // For branching preview + recording.
+  std::shared_ptr<CaptureSession> session_;
+
+  GstElement* branch_;     // Owned (ref held while attached to session_).
+  GstElement* tee_;        // For branching preview + recording.
   GstElement* appsink_;
-  GstElement* videoflip_;  // Named element in pipeline for mirror toggle.
-  guint bus_watch_id_;
+  GstElement* videoflip_;  // Named element in branch for mirror toggle.
+  // Streaming thread only; decimates at rates above kPreviewMaxFps.
+  PreviewDecimator preview_decimator_;
   guint init_timeout_id_;
+  CameraThreadSchedule thread_schedule_;
 
   std::unique_ptr<RecordHandler> record_handler_;
+  std::unique_ptr<SourceSwitcher> source_switcher_;
+  std::unique_ptr<LatencyTracer> latency_tracer_;  // Only while tracing.
 
   // Pending async initialization — stores the FlMethodCall until first frame.
   // Only accessed from the main thread (set in Initialize, cleared in
@@ -131,24 +289,51 @@ class Camera {
 
   std::atomic<bool> image_streaming_;
 
-  // FFI image stream shared buffer.
-  // NOTE: The |ready| field acts as a release/acquire flag between the
-  // GStreamer thread (writer) and Dart (reader). The native side MUST issue a
-  // std::atomic_thread_fence(release) before writing ready=1, ensuring all
-  // pixel writes are visible before Dart observes ready==1. (C-5)
-  struct ImageStreamBuffer {
-    int64_t  sequence;
-    int32_t  width;
-    int32_t  height;
-    int32_t  bytes_per_row;
-    int32_t  format;       // 0=BGRA, 1=RGBA
-    int32_t  ready;        // 1=Dart may read, 0=native writing
-    int32_t  _pad;
-    uint8_t  pixels[];     // flexible array member
-  };
+  AdaptiveFrameRate adaptive_rate_;
+
+  // Static-frame skipping. The threshold is -1 while disabled; written on
+  // the main thread. change_reset_ asks the streaming thread to drop the
+  // detector's reference, after which it delivers the next frame in full.
+  std::atomic<int> static_skip_threshold_{-1};
+  std::atomic<bool> change_reset_{false};
+  // Streaming thread only. stream_in_sync_: the image stream buffer holds a
+  // frame matching the detector's reference.
+  FrameChangeDetector change_detector_;
+  bool stream_in_sync_ = false;
+  // Caps entering the branch; written and read in OnBranchInput only.
+  GstVideoInfo input_info_;
+  bool input_info_valid_ = false;
 
+  // Written from the main thread, read from the GStreamer streaming thread.
+  std::atomic<bool> standby_{false};
+  // Set when leaving standby; the next frame turns it into last_wake_us_,
+  // the time from the request to that frame.
+  std::atomic<gint64> wake_requested_us_{0};
+  std::atomic<gint64> last_wake_us_{0};
+
+  // FFI image stream shared buffer (layout and publish protocol in
+  // frame_copy.h).
   ImageStreamBuffer* image_stream_buffer_ = nullptr;
-  size_t image_stream_buffer_size_ = 0;
+  // Written on the streaming thread, read by the memory accounting.
+  std::atomic<size_t> image_stream_buffer_size_{0};
+
+  // Memory budget, 0 when unset. Main thread only, except preview_reduced_,
+  // which the streaming thread reads.
+  size_t memory_budget_ = 0;
+  guint memory_timer_id_ = 0;
+  bool texture_double_buffered_ = false;
+  std::atomic<bool> preview_reduced_{false};
+
+  // Idle buffer release. Main thread only, except trim_requested_, which
+  // the streaming thread takes, and idle_releases_.
+  int idle_release_ms_ = 0;
+  guint idle_timer_id_ = 0;
+  gint64 preview_idle_since_us_ = 0;  // 0 while the preview is live.
+  gint64 stream_idle_since_us_ = 0;   // 0 while the stream runs.
+  bool preview_trimmed_ = false;
+  bool stream_trimmed_ = false;
+  std::atomic<int> trim_requested_{0};  // kTrim* bits.
+  std::atomic<uint64_t> idle_releases_{0};
 
   // Written from the main thread, read from the GStreamer streaming thread.
   // Must be atomic to avoid data races and torn reads. (C-4)
@@ -156,6 +341,26 @@ class Camera {
 
   int64_t image_stream_sequence_ = 0;
 
+  // Lock-free counters written on the streaming thread (see camera_stats.h).
+  CameraStats stats_;
+  // Main-thread bookkeeping for the per-report frame rates.
+  gint64 stats_last_report_us_ = 0;
+  uint64_t stats_last_captured_ = 0;
+  uint64_t stats_last_preview_ = 0;
+  guint stats_timer_id_ = 0;
+  // Main thread only.
+  int reconnects_ = 0;
+  gint64 last_recovery_us_ = 0;  // Downtime of the last reconnect.
+
+  // Cold-start timestamps. startup_ and init_start_us_/branch_built_us_ are
+  // main-thread only; the first-frame stamps are written on the streaming
+  // thread before the response is posted to the main thread.
+  StartupTimeline startup_;
+  gint64 init_start_us_ = 0;
+  gint64 branch_built_us_ = 0;
+  std::atomic<gint64> first_sample_us_{0};
+  std::atomic<gint64> first_texture_us_{0};
+
   // Written from the GStreamer streaming thread on first frame, read from the
   // main thread in StartVideoRecording. Must be atomic. (H-2)
   std::atomic<int> actual_width_;
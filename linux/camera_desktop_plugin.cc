@@ -2,24 +2,80 @@
 
 #include <flutter_linux/flutter_linux.h>
 #include <gst/gst.h>
+#include <sched.h>
 
-
+#include <cmath>
 #include <map>
 #include <memory>
 #include <string>
 #include <cstdint>
+#include <list>
+#include <utility>
+#include <vector>
 
 #include "camera.h"
+#include "capture_session.h"
 #include "device_enumerator.h"
+#include "frame_trace.h"
+#include "gst_warmup.h"
+#include "mosaic.h"
+#include "streaming_thread_pool.h"
+#include "virtual_source.h"
 
 int64_t camera_desktop_ffi_register_stream_handle(Camera* camera);
 void camera_desktop_ffi_release_stream_handle(int64_t stream_handle);
 void camera_desktop_ffi_release_handles_for_camera(Camera* camera);
 
+// How long a prepared device stays open waiting for its camera.
+static const guint kPreparedTimeoutMs = 10000;
+
+// A capture session brought up by prepare() ahead of create/initialize.
+// Holds the device open until a camera claims it or the timeout passes.
+struct PreparedSession {
+  std::shared_ptr<CaptureSession> session;
+  guint timeout_id = 0;
+};
+
+// Default idle expiry of a pooled camera.
+static const guint kPoolIdleTimeoutMs = 30000;
+
+// Default time a camera's preview or image stream stays idle before its
+// buffers are given back (see Camera::SetIdleBufferRelease).
+static const int kIdleBufferReleaseMs = 30000;
+
+// A disposed camera parked for reuse (configureCameraPool): its session,
+// held open with the pipeline already built, and its registered texture
+// with the buffers and last frame still in it. A create with the same key
+// picks both up again.
+struct PooledCamera {
+  int id = 0;
+  std::string key;  // See pool_key.
+  std::shared_ptr<CaptureSession> session;
+  CameraTexture* texture = nullptr;  // Registered, holds a ref.
+  guint timeout_id = 0;
+};
+
 // Plugin data stored as an opaque C++ pointer inside the GObject struct.
 struct PluginData {
   std::map<int, std::unique_ptr<Camera>> cameras;
   int next_camera_id = 1;
+  // One capture session per device, shared by every camera opened on it.
+  // Cameras hold the strong references; an entry expires once the last
+  // camera using the device is disposed.
+  std::map<std::string, std::weak_ptr<CaptureSession>> sessions;
+  std::map<int, std::unique_ptr<Mosaic>> mosaics;
+  int next_mosaic_id = 1;
+  // By device path (or virtual source URI).
+  std::map<std::string, PreparedSession> prepared;
+  // Most recently parked first. Pooling is off while pool_max_entries is 0.
+  std::list<PooledCamera> pool;
+  int next_pool_id = 1;
+  size_t pool_max_entries = 0;
+  guint pool_idle_ms = kPoolIdleTimeoutMs;
+  // Last reported by setAppVisibility; applies to every camera.
+  bool app_hidden = false;
+  // Set by configureIdleBufferRelease; applies to every camera. 0 is off.
+  int idle_release_ms = kIdleBufferReleaseMs;
 };
 
 #define CAMERA_DESKTOP_PLUGIN(obj) \
@@ -35,6 +91,116 @@ struct _CameraDesktopPlugin {
 
 G_DEFINE_TYPE(CameraDesktopPlugin, camera_desktop_plugin, g_object_get_type())
 
+// Extracts the source from a camera name.
+// Format: "Friendly Name (/dev/videoN)" — extract the part in parentheses;
+// falls back to the whole name. Besides device paths this may be a virtual
+// source URI (see virtual_source.h).
+static std::string extract_source(const char* camera_name) {
+  std::string name_str(camera_name ? camera_name : "");
+  size_t paren_start = name_str.rfind('(');
+  size_t paren_end = name_str.rfind(')');
+  if (paren_start != std::string::npos && paren_end != std::string::npos &&
+      paren_end > paren_start) {
+    return name_str.substr(paren_start + 1, paren_end - paren_start - 1);
+  }
+  return name_str;
+}
+
+// Extracts the device path from a camera name.
+// Returns an empty string if the name does not carry a /dev/ path.
+static std::string extract_device_path(const char* camera_name) {
+  std::string device_path = extract_source(camera_name);
+  if (device_path.find("/dev/") != 0) return "";
+  return device_path;
+}
+
+// Forgets sessions whose last camera or mosaic tile has gone away.
+static void prune_sessions(CameraDesktopPlugin* self) {
+  auto& sessions = self->data->sessions;
+  for (auto it = sessions.begin(); it != sessions.end();) {
+    if (it->second.expired()) {
+      it = sessions.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+// Returns the live session for |config.device_path|, or opens a new one
+// configured from |config|. Callers fit a live one to |config| first with
+// fit_shared_session.
+static std::shared_ptr<CaptureSession> acquire_session(
+    CameraDesktopPlugin* self, const CameraConfig& config) {
+  // A virtual source is not an exclusive device; each camera gets its own,
+  // so N cameras on the same URI are N independent sources.
+  if (!config.source.empty()) {
+    return std::make_shared<CaptureSession>(config);
+  }
+  auto& sessions = self->data->sessions;
+  auto it = sessions.find(config.device_path);
+  if (it != sessions.end()) {
+    if (auto session = it->second.lock()) return session;
+  }
+  auto session = std::make_shared<CaptureSession>(config);
+  sessions[config.device_path] = session;
+  return session;
+}
+
+// A device already open in this process is shared. Cameras that ask for
+// less than its format scale down inside their own branch; a larger or
+// faster |config| first moves the live session to a mode covering both
+// (see DeviceEnumerator::SelectSharedFormat), so no camera or mosaic tile
+// is handed an upscaled or slower capture. Returns false with |message|
+// set if the device has no such mode or does not restart in it.
+static bool grow_shared_session(CameraDesktopPlugin* self,
+                                const CameraConfig& config,
+                                std::string* message) {
+  if (!config.source.empty()) return true;
+  auto it = self->data->sessions.find(config.device_path);
+  if (it == self->data->sessions.end()) return true;
+  auto session = it->second.lock();
+  if (!session) return true;
+
+  const CameraConfig& shared = session->config();
+  ResolutionInfo selected;
+  if (!DeviceEnumerator::SelectSharedFormat(
+          DeviceEnumerator::EnumerateResolutions(config.device_path),
+          {shared.target_width, shared.target_height, shared.target_fps},
+          {config.target_width, config.target_height, config.target_fps},
+          &selected)) {
+    *message = config.device_path + " is already open at " +
+               std::to_string(shared.target_width) + "x" +
+               std::to_string(shared.target_height) + " and " +
+               std::to_string(shared.target_fps) +
+               " fps, and has no mode covering both that and " +
+               std::to_string(config.target_width) + "x" +
+               std::to_string(config.target_height) + " at " +
+               std::to_string(config.target_fps) + " fps";
+    return false;
+  }
+  GError* error = nullptr;
+  if (!session->SetCaptureFormat(selected.width, selected.height,
+                                 selected.max_fps, &error)) {
+    *message = error ? error->message : "Failed to change the capture format";
+    if (error) g_error_free(error);
+    return false;
+  }
+  return true;
+}
+
+// grow_shared_session for a camera: responds with format_conflict and
+// returns false if the shared device cannot serve |config|.
+static bool fit_shared_session(CameraDesktopPlugin* self,
+                               FlMethodCall* method_call,
+                               const CameraConfig& config) {
+  std::string message;
+  if (grow_shared_session(self, config, &message)) return true;
+  g_autoptr(FlValue) details = fl_value_new_null();
+  fl_method_call_respond_error(method_call, "format_conflict",
+                               message.c_str(), details, nullptr);
+  return false;
+}
+
 // --- Method handlers ---
 
 static void handle_available_cameras(CameraDesktopPlugin* self,
@@ -72,11 +238,111 @@ static void handle_get_platform_capabilities(FlMethodCall* method_call) {
                            fl_value_new_bool(true));
   fl_value_set_string_take(result, "supportsVideoBitrateControl",
                            fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsMosaic", fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsCameraStats",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsPrepare", fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsSetDescriptionWhileRecording",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsAutoReconnect",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsCameraPool",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsStandby", fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsAdaptiveFrameRate",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsStaticFrameSkipping",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsMemoryBudget",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsIdleBufferRelease",
+                           fl_value_new_bool(true));
+  fl_value_set_string_take(result, "supportsHighFrameRate",
+                           fl_value_new_bool(true));
   fl_method_call_respond_success(method_call, result, nullptr);
 }
 
-static void handle_create(CameraDesktopPlugin* self,
-                          FlMethodCall* method_call) {
+// Resolves |camera_name| to the device path (or virtual source) and capture
+// size for |resolution_preset|, filling those fields of |config|.
+// |target_fps| is the requested rate; a virtual source URI may override it,
+// and a device falls back to its fastest mode when it is 0. A device asked
+// for more than Camera::kPreviewMaxFps gets a size it reports for the rate.
+// Responds with an error and returns false if the name does not denote a
+// usable source or the device cannot reach the rate.
+static bool resolve_camera_source(FlMethodCall* method_call,
+                                  const char* camera_name,
+                                  int resolution_preset, int* target_fps,
+                                  CameraConfig* config) {
+  ResolutionInfo selected;
+  std::string source_uri = extract_source(camera_name);
+  if (IsVirtualSourceUri(source_uri)) {
+    VirtualSource source;
+    std::string source_error;
+    if (!ParseVirtualSourceUri(source_uri, &source, &source_error)) {
+      g_autoptr(FlValue) details = fl_value_new_null();
+      fl_method_call_respond_error(method_call, "invalid_source",
+                                   source_error.c_str(), details, nullptr);
+      return false;
+    }
+    // Sizes the URI leaves out follow the preset, as if the source offered
+    // the usual webcam modes.
+    selected = DeviceEnumerator::SelectResolution(
+        {{3840, 2160, 30}, {1920, 1080, 30}, {1280, 720, 30},
+         {640, 480, 30}, {320, 240, 30}},
+        resolution_preset);
+    if (source.width > 0) selected.width = source.width;
+    if (source.height > 0) selected.height = source.height;
+    // An explicit rate in the URI wins over the clamped request.
+    if (source.fps > 0) *target_fps = source.fps;
+    config->device_path = source_uri;
+    config->source = source.description;
+    config->loop_source = source.loop;
+  } else {
+    std::string device_path = extract_device_path(camera_name);
+    if (device_path.empty()) {
+      g_autoptr(FlValue) details = fl_value_new_null();
+      fl_method_call_respond_error(
+          method_call, "invalid_camera_name",
+          "Could not extract device path from camera name", details,
+          nullptr);
+      return false;
+    }
+
+    // Enumerate resolutions and select the best match for the preset.
+    auto resolutions = DeviceEnumerator::EnumerateResolutions(device_path);
+    if (*target_fps > Camera::kPreviewMaxFps) {
+      // High-frame-rate mode: only a mode the device reports for the rate
+      // will negotiate, often smaller than the preset asks for.
+      if (!DeviceEnumerator::SelectResolutionForFps(
+              resolutions, resolution_preset, *target_fps, &selected)) {
+        int max_fps = 0;
+        for (const auto& r : resolutions) max_fps = MAX(max_fps, r.max_fps);
+        std::string message = device_path + " does not support " +
+                              std::to_string(*target_fps) + " fps (at most " +
+                              std::to_string(max_fps) + " fps)";
+        g_autoptr(FlValue) details = fl_value_new_null();
+        fl_method_call_respond_error(method_call, "unsupported_fps",
+                                     message.c_str(), details, nullptr);
+        return false;
+      }
+    } else {
+      selected = DeviceEnumerator::SelectResolution(resolutions,
+                                                    resolution_preset);
+    }
+    config->device_path = device_path;
+  }
+
+  config->target_width = selected.width;
+  config->target_height = selected.height;
+  if (*target_fps <= 0) *target_fps = selected.max_fps;
+  return true;
+}
+
+// Reads the camera settings shared by create and prepare into |config|,
+// enumerating the device's resolutions to honour the preset. Responds with
+// an error and returns false if the arguments do not name a usable source.
+static bool parse_camera_config(FlMethodCall* method_call,
+                                CameraConfig* config) {
   FlValue* args = fl_method_call_get_args(method_call);
   const char* camera_name =
       fl_value_get_string(fl_value_lookup_string(args, "cameraName"));
@@ -93,7 +359,15 @@ static void handle_create(CameraDesktopPlugin* self,
     target_fps = static_cast<int>(fl_value_get_float(fps_val));
   }
   if (target_fps < 5) target_fps = 5;
-  if (target_fps > 60) target_fps = 60;
+  if (target_fps > kMaxCaptureFps) {
+    std::string message = std::to_string(target_fps) +
+                          " fps is above the limit of " +
+                          std::to_string(kMaxCaptureFps) + " fps";
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "unsupported_fps",
+                                 message.c_str(), details, nullptr);
+    return false;
+  }
 
   int target_bitrate = 0;
   FlValue* bitrate_val = fl_value_lookup_string(args, "videoBitrate");
@@ -116,48 +390,144 @@ static void handle_create(CameraDesktopPlugin* self,
   }
   if (audio_bitrate < 0) audio_bitrate = 0;
 
-  // Extract device path from the camera name.
-  // Format: "Friendly Name (/dev/videoN)" — extract the path in parentheses.
-  std::string name_str(camera_name);
-  std::string device_path;
-  size_t paren_start = name_str.rfind('(');
-  size_t paren_end = name_str.rfind(')');
-  if (paren_start != std::string::npos && paren_end != std::string::npos &&
-      paren_end > paren_start) {
-    device_path = name_str.substr(paren_start + 1, paren_end - paren_start - 1);
-  } else {
-    // Fallback: treat the whole name as a device path.
-    device_path = name_str;
+  if (!resolve_camera_source(method_call, camera_name, resolution_preset,
+                             &target_fps, config)) {
+    return false;
   }
 
-  if (device_path.empty() || device_path.find("/dev/") != 0) {
-    g_autoptr(FlValue) details = fl_value_new_null();
-    fl_method_call_respond_error(method_call, "invalid_camera_name",
-                                 "Could not extract device path from camera name",
-                                 details, nullptr);
-    return;
+  config->resolution_preset = resolution_preset;
+  config->enable_audio = enable_audio;
+  config->target_fps = target_fps;
+  config->target_bitrate = target_bitrate;
+  config->audio_bitrate = audio_bitrate;
+  return true;
+}
+
+// Whether a session opened for |a| captures what |b| asks for.
+static bool same_capture_format(const CameraConfig& a, const CameraConfig& b) {
+  return a.target_width == b.target_width &&
+         a.target_height == b.target_height &&
+         a.target_fps == b.target_fps && a.source == b.source;
+}
+
+// Hands over the session prepare() brought up for |config|'s device, if it
+// was prepared with the same capture format. A mismatching one is dropped,
+// which releases the device before it is opened again.
+static std::shared_ptr<CaptureSession> take_prepared_session(
+    CameraDesktopPlugin* self, const CameraConfig& config) {
+  auto& prepared = self->data->prepared;
+  auto it = prepared.find(config.device_path);
+  if (it == prepared.end()) return nullptr;
+  std::shared_ptr<CaptureSession> session = std::move(it->second.session);
+  if (it->second.timeout_id > 0) g_source_remove(it->second.timeout_id);
+  prepared.erase(it);
+
+  if (!same_capture_format(session->config(), config)) {
+    session.reset();
+    prune_sessions(self);
+    return nullptr;
+  }
+  return session;
+}
+
+// Pool key: the source and the capture format it was opened with.
+static std::string pool_key(const CameraConfig& config) {
+  return (config.source.empty() ? config.device_path : config.source) + "|" +
+         std::to_string(config.target_width) + "x" +
+         std::to_string(config.target_height) + "@" +
+         std::to_string(config.target_fps);
+}
+
+// Unregisters the texture of a pool entry that is being dropped. The
+// session goes with the entry.
+static void release_pooled(CameraDesktopPlugin* self, PooledCamera* entry) {
+  if (entry->timeout_id > 0) g_source_remove(entry->timeout_id);
+  entry->timeout_id = 0;
+  if (entry->texture) {
+    fl_texture_registrar_unregister_texture(
+        self->texture_registrar, camera_texture_as_fl_texture(entry->texture));
+    g_object_unref(entry->texture);
+    entry->texture = nullptr;
+  }
+}
+
+// Drops pool entries from the least recently parked until at most
+// |max_entries| are left.
+static void trim_pool(CameraDesktopPlugin* self, size_t max_entries) {
+  auto& pool = self->data->pool;
+  while (pool.size() > max_entries) {
+    release_pooled(self, &pool.back());
+    pool.pop_back();
   }
+  prune_sessions(self);
+}
 
-  // Enumerate resolutions and select the best match for the preset.
-  auto resolutions = DeviceEnumerator::EnumerateResolutions(device_path);
-  auto selected = DeviceEnumerator::SelectResolution(resolutions,
-                                                     resolution_preset);
+// Takes the pooled camera matching |config| out of the pool. Entries for
+// the same source in another format are dropped, so the device is free to
+// be opened again with the new one.
+static bool take_pooled(CameraDesktopPlugin* self, const CameraConfig& config,
+                        PooledCamera* taken) {
+  const std::string key = pool_key(config);
+  const std::string source =
+      config.source.empty() ? config.device_path : config.source;
+  bool found = false;
+  auto& pool = self->data->pool;
+  for (auto it = pool.begin(); it != pool.end();) {
+    if (!found && it->key == key) {
+      *taken = std::move(*it);
+      if (taken->timeout_id > 0) g_source_remove(taken->timeout_id);
+      taken->timeout_id = 0;
+      it = pool.erase(it);
+      found = true;
+    } else if (it->key.compare(0, source.size() + 1, source + "|") == 0) {
+      release_pooled(self, &*it);
+      it = pool.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  prune_sessions(self);
+  return found;
+}
+
+static void handle_create(CameraDesktopPlugin* self,
+                          FlMethodCall* method_call) {
+  StartupTimeline timeline;
+  timeline.gst_init_start_us = GstWarmup::init_start_us();
+  timeline.gst_init_end_us = GstWarmup::init_end_us();
+  timeline.create_start_us = g_get_monotonic_time();
 
   CameraConfig config;
-  config.device_path = device_path;
-  config.resolution_preset = resolution_preset;
-  config.enable_audio = enable_audio;
-  config.target_width = selected.width;
-  config.target_height = selected.height;
-  config.target_fps = target_fps > 0 ? target_fps : selected.max_fps;
-  config.target_bitrate = target_bitrate;
-  config.audio_bitrate = audio_bitrate;
+  if (!parse_camera_config(method_call, &config)) return;
+  timeline.enumerated_us = g_get_monotonic_time();
+
+  // A camera parked in the pool with the same settings comes back with its
+  // pipeline and texture. Otherwise a device that is already open in this
+  // process is shared rather than opened a second time (which V4L2 would
+  // refuse as busy).
+  PooledCamera pooled;
+  std::shared_ptr<CaptureSession> session;
+  if (take_pooled(self, config, &pooled)) {
+    session = std::move(pooled.session);
+    timeline.pooled = true;
+  } else {
+    session = take_prepared_session(self, config);
+  }
+  if (!session) {
+    if (!fit_shared_session(self, method_call, config)) return;
+    session = acquire_session(self, config);
+  }
 
   int camera_id = self->data->next_camera_id++;
   auto camera = std::make_unique<Camera>(
-      camera_id, self->texture_registrar, self->channel, config);
+      camera_id, self->texture_registrar, self->channel, config,
+      std::move(session));
+  camera->set_startup_timeline(timeline);
+  camera->SetAppHidden(self->data->app_hidden);
+  camera->SetIdleBufferRelease(self->data->idle_release_ms);
 
-  int64_t texture_id = camera->RegisterTexture();
+  int64_t texture_id = pooled.texture ? camera->AdoptTexture(pooled.texture)
+                                      : camera->RegisterTexture();
   if (texture_id < 0) {
     g_autoptr(FlValue) details = fl_value_new_null();
     fl_method_call_respond_error(method_call, "texture_registration_failed",
@@ -176,6 +546,74 @@ static void handle_create(CameraDesktopPlugin* self,
   fl_method_call_respond_success(method_call, result, nullptr);
 }
 
+struct PreparedTimeout {
+  CameraDesktopPlugin* plugin;
+  std::string device_path;
+};
+
+// Releases a prepared device nobody claimed in time.
+static gboolean on_prepared_timeout(gpointer user_data) {
+  auto* timeout = static_cast<PreparedTimeout*>(user_data);
+  auto& prepared = timeout->plugin->data->prepared;
+  auto it = prepared.find(timeout->device_path);
+  if (it != prepared.end()) {
+    it->second.timeout_id = 0;
+    prepared.erase(it);
+    prune_sessions(timeout->plugin);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// (Re)starts the wait for a camera to claim |entry|.
+static void arm_prepared_timeout(CameraDesktopPlugin* self,
+                                 PreparedSession* entry,
+                                 const std::string& device_path) {
+  if (entry->timeout_id > 0) g_source_remove(entry->timeout_id);
+  entry->timeout_id = g_timeout_add_full(
+      G_PRIORITY_DEFAULT, kPreparedTimeoutMs, on_prepared_timeout,
+      new PreparedTimeout{self, device_path},
+      [](gpointer p) { delete static_cast<PreparedTimeout*>(p); });
+}
+
+static void handle_prepare(CameraDesktopPlugin* self,
+                           FlMethodCall* method_call) {
+  CameraConfig config;
+  if (!parse_camera_config(method_call, &config)) return;
+
+  // Preparing the same device again in the same format keeps the device
+  // open and only restarts the wait; another format replaces it.
+  auto prepared = self->data->prepared.find(config.device_path);
+  if (prepared != self->data->prepared.end() &&
+      same_capture_format(prepared->second.session->config(), config)) {
+    arm_prepared_timeout(self, &prepared->second, config.device_path);
+    fl_method_call_respond_success(method_call, nullptr, nullptr);
+    return;
+  }
+  take_prepared_session(self, config).reset();
+  prune_sessions(self);
+
+  if (!fit_shared_session(self, method_call, config)) return;
+  std::shared_ptr<CaptureSession> session = acquire_session(self, config);
+  // A device another camera is already streaming needs no preparation.
+  if (session->branch_count() == 0) {
+    GError* error = nullptr;
+    if (!session->Prepare(&error)) {
+      g_autoptr(FlValue) details = fl_value_new_null();
+      fl_method_call_respond_error(method_call, "prepare_failed",
+                                   error ? error->message
+                                         : "Failed to prepare camera",
+                                   details, nullptr);
+      if (error) g_error_free(error);
+      prune_sessions(self);
+      return;
+    }
+    PreparedSession& entry = self->data->prepared[config.device_path];
+    entry.session = std::move(session);
+    arm_prepared_timeout(self, &entry, config.device_path);
+  }
+  fl_method_call_respond_success(method_call, nullptr, nullptr);
+}
+
 static Camera* find_camera(CameraDesktopPlugin* self,
                            FlMethodCall* method_call) {
   FlValue* args = fl_method_call_get_args(method_call);
@@ -220,6 +658,48 @@ static void handle_stop_video_recording(CameraDesktopPlugin* self,
   camera->StopVideoRecording(method_call);
 }
 
+// Moves a camera onto another device while it keeps recording into the same
+// file. The new device is captured at the camera's own preset and frame
+// rate and converted to its format; naming the camera's own device switches
+// back.
+static void handle_set_description_while_recording(
+    CameraDesktopPlugin* self, FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* name_val = fl_value_lookup_string(args, "cameraName");
+  if (!name_val || fl_value_get_type(name_val) != FL_VALUE_TYPE_STRING) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "invalid_camera_name",
+                                 "cameraName is required", details, nullptr);
+    return;
+  }
+
+  const CameraConfig& current = camera->config();
+  CameraConfig config = current;
+  int target_fps = current.target_fps;
+  if (!resolve_camera_source(method_call, fl_value_get_string(name_val),
+                             current.resolution_preset, &target_fps,
+                             &config)) {
+    return;
+  }
+  config.target_fps = target_fps;
+
+  if (config.device_path == current.device_path) {
+    camera->SwitchSource(nullptr, method_call);
+    return;
+  }
+  // Shares the device if another camera already streams it.
+  std::shared_ptr<CaptureSession> session =
+      take_prepared_session(self, config);
+  if (!session) {
+    if (!fit_shared_session(self, method_call, config)) return;
+    session = acquire_session(self, config);
+  }
+  camera->SwitchSource(std::move(session), method_call);
+  prune_sessions(self);
+}
+
 static void handle_start_image_stream(CameraDesktopPlugin* self,
                                       FlMethodCall* method_call) {
   Camera* camera = find_camera(self, method_call);
@@ -261,6 +741,80 @@ static void handle_resume_preview(CameraDesktopPlugin* self,
   fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
 }
 
+static void handle_set_standby(CameraDesktopPlugin* self,
+                               FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* standby_val = fl_value_lookup_string(args, "standby");
+  bool standby = standby_val && fl_value_get_bool(standby_val);
+
+  std::string error;
+  if (!camera->SetStandby(standby, &error)) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "standby_failed", error.c_str(),
+                                 details, nullptr);
+    return;
+  }
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_set_adaptive_frame_rate(CameraDesktopPlugin* self,
+                                           FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  AdaptiveRateConfig config;
+  FlValue* value = fl_value_lookup_string(args, "enabled");
+  if (value) config.enabled = fl_value_get_bool(value);
+  value = fl_value_lookup_string(args, "idleFps");
+  if (value && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    config.idle_fps = CLAMP(fl_value_get_int(value), 1, 60);
+  }
+  value = fl_value_lookup_string(args, "staticThreshold");
+  if (value && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    config.static_threshold = CLAMP(fl_value_get_int(value), 0, 255);
+  }
+  value = fl_value_lookup_string(args, "staticDelayMs");
+  if (value && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    config.static_delay_ms = CLAMP(fl_value_get_int(value), 0, 60000);
+  }
+
+  camera->SetAdaptiveFrameRate(config);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_set_static_frame_skipping(CameraDesktopPlugin* self,
+                                             FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* enabled_val = fl_value_lookup_string(args, "enabled");
+  bool enabled = enabled_val && fl_value_get_bool(enabled_val);
+  int threshold = 2;
+  FlValue* threshold_val = fl_value_lookup_string(args, "threshold");
+  if (threshold_val && fl_value_get_type(threshold_val) == FL_VALUE_TYPE_INT) {
+    threshold = CLAMP(fl_value_get_int(threshold_val), 0, 255);
+  }
+
+  camera->SetStaticFrameSkipping(enabled, threshold);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_set_app_visibility(CameraDesktopPlugin* self,
+                                      FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* hidden_val = fl_value_lookup_string(args, "hidden");
+  self->data->app_hidden = hidden_val && fl_value_get_bool(hidden_val);
+  for (auto& pair : self->data->cameras) {
+    pair.second->SetAppHidden(self->data->app_hidden);
+  }
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
 static void handle_set_mirror(CameraDesktopPlugin* self,
                               FlMethodCall* method_call) {
   Camera* camera = find_camera(self, method_call);
@@ -274,6 +828,255 @@ static void handle_set_mirror(CameraDesktopPlugin* self,
   fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
 }
 
+static void handle_get_camera_stats(CameraDesktopPlugin* self,
+                                    FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  g_autoptr(FlValue) result = camera->GetStats();
+  fl_method_call_respond_success(method_call, result, nullptr);
+}
+
+static void handle_get_memory_usage(CameraDesktopPlugin* self,
+                                    FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  g_autoptr(FlValue) result = camera->GetMemoryUsage();
+  fl_method_call_respond_success(method_call, result, nullptr);
+}
+
+static void handle_set_memory_budget(CameraDesktopPlugin* self,
+                                     FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* budget_val = fl_value_lookup_string(args, "budgetBytes");
+  int64_t budget = 0;
+  if (budget_val && fl_value_get_type(budget_val) == FL_VALUE_TYPE_INT) {
+    budget = MAX(fl_value_get_int(budget_val), 0);
+  }
+  camera->SetMemoryBudget((size_t)budget);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_set_camera_stats_interval(CameraDesktopPlugin* self,
+                                             FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* interval_val = fl_value_lookup_string(args, "intervalMs");
+  int interval_ms = 0;
+  if (interval_val && fl_value_get_type(interval_val) == FL_VALUE_TYPE_INT) {
+    // Floor at 100 ms: the push runs on the UI thread.
+    int64_t v = fl_value_get_int(interval_val);
+    interval_ms = v <= 0 ? 0 : static_cast<int>(CLAMP(v, 100, 60000));
+  }
+
+  camera->SetStatsInterval(interval_ms);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_set_latency_tracing(CameraDesktopPlugin* self,
+                                       FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* enabled_val = fl_value_lookup_string(args, "enabled");
+  bool enabled = enabled_val && fl_value_get_bool(enabled_val);
+
+  if (!camera->SetLatencyTracing(enabled)) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "not_running",
+                                 "Camera is not initialized", details,
+                                 nullptr);
+    return;
+  }
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_set_reconnect_policy(CameraDesktopPlugin* self,
+                                        FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  ReconnectPolicy policy;
+  FlValue* enabled_val = fl_value_lookup_string(args, "enabled");
+  policy.enabled = enabled_val && fl_value_get_bool(enabled_val);
+  auto read_int = [args](const char* key, int64_t min, int64_t max,
+                         int* out) {
+    FlValue* value = fl_value_lookup_string(args, key);
+    if (value && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+      *out = static_cast<int>(CLAMP(fl_value_get_int(value), min, max));
+    }
+  };
+  read_int("initialDelayMs", 1, 60000, &policy.initial_delay_ms);
+  read_int("maxDelayMs", 1, 600000, &policy.max_delay_ms);
+  read_int("maxAttempts", 0, 1000000, &policy.max_attempts);
+
+  camera->SetReconnectPolicy(policy);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_get_pipeline_latency(CameraDesktopPlugin* self,
+                                        FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  g_autoptr(FlValue) result = camera->GetPipelineLatency();
+  if (!result) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "not_enabled",
+                                 "Latency tracing is not enabled", details,
+                                 nullptr);
+    return;
+  }
+  fl_method_call_respond_success(method_call, result, nullptr);
+}
+
+// Parses {policy: "default"|"nice"|"fifo", priority: int, cpus: [int]}.
+static ThreadSchedule parse_thread_schedule(FlValue* value) {
+  ThreadSchedule schedule;
+  if (!value || fl_value_get_type(value) != FL_VALUE_TYPE_MAP) {
+    return schedule;
+  }
+
+  FlValue* policy_val = fl_value_lookup_string(value, "policy");
+  if (policy_val && fl_value_get_type(policy_val) == FL_VALUE_TYPE_STRING) {
+    const char* policy = fl_value_get_string(policy_val);
+    if (strcmp(policy, "nice") == 0) {
+      schedule.policy = ThreadSchedule::Policy::kNice;
+    } else if (strcmp(policy, "fifo") == 0) {
+      schedule.policy = ThreadSchedule::Policy::kFifo;
+    }
+  }
+
+  FlValue* priority_val = fl_value_lookup_string(value, "priority");
+  if (priority_val && fl_value_get_type(priority_val) == FL_VALUE_TYPE_INT) {
+    schedule.priority = static_cast<int>(fl_value_get_int(priority_val));
+  }
+
+  FlValue* cpus_val = fl_value_lookup_string(value, "cpus");
+  if (cpus_val && fl_value_get_type(cpus_val) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(cpus_val); i++) {
+      FlValue* cpu = fl_value_get_list_value(cpus_val, i);
+      if (fl_value_get_type(cpu) != FL_VALUE_TYPE_INT) continue;
+      int64_t index = fl_value_get_int(cpu);
+      if (index >= 0 && index < CPU_SETSIZE) {
+        schedule.cpus.push_back(static_cast<int>(index));
+      }
+    }
+  }
+  return schedule;
+}
+
+static void handle_set_thread_scheduling(CameraDesktopPlugin* self,
+                                         FlMethodCall* method_call) {
+  Camera* camera = find_camera(self, method_call);
+  if (!camera) return;
+
+  FlValue* args = fl_method_call_get_args(method_call);
+  CameraThreadSchedule schedule;
+  schedule.capture = parse_thread_schedule(fl_value_lookup_string(args,
+                                                                  "capture"));
+  schedule.convert = parse_thread_schedule(fl_value_lookup_string(args,
+                                                                  "convert"));
+  schedule.encode = parse_thread_schedule(fl_value_lookup_string(args,
+                                                                 "encode"));
+
+  std::string error;
+  std::map<ThreadRole, std::string> applied =
+      camera->SetThreadSchedule(schedule, &error);
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(
+      result, "capture",
+      fl_value_new_string(applied[ThreadRole::kCapture].c_str()));
+  fl_value_set_string_take(
+      result, "convert",
+      fl_value_new_string(applied[ThreadRole::kConvert].c_str()));
+  fl_value_set_string_take(
+      result, "encode",
+      fl_value_new_string(applied[ThreadRole::kEncode].c_str()));
+  if (!error.empty()) {
+    fl_value_set_string_take(result, "error",
+                             fl_value_new_string(error.c_str()));
+  }
+  fl_method_call_respond_success(method_call, result, nullptr);
+}
+
+struct PoolTimeout {
+  CameraDesktopPlugin* plugin;
+  int id;
+};
+
+// Drops a pooled camera nobody re-created in time.
+static gboolean on_pool_timeout(gpointer user_data) {
+  auto* timeout = static_cast<PoolTimeout*>(user_data);
+  CameraDesktopPlugin* self = timeout->plugin;
+  auto& pool = self->data->pool;
+  for (auto it = pool.begin(); it != pool.end(); ++it) {
+    if (it->id != timeout->id) continue;
+    it->timeout_id = 0;
+    release_pooled(self, &*it);
+    pool.erase(it);
+    prune_sessions(self);
+    break;
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Disposes |camera| into the pool. Its session is parked with the pipeline
+// built and the device open (see CaptureSession::Prepare) unless other
+// cameras still stream from it. Returns false, leaving the camera
+// untouched, if pooling is off or the camera never streamed.
+static bool park_camera(CameraDesktopPlugin* self, Camera* camera) {
+  // Only cameras that got as far as streaming: a failed one may have left
+  // its device in a bad state.
+  CameraState state = camera->state();
+  if (self->data->pool_max_entries == 0 || camera->texture_id() < 0 ||
+      (state != CameraState::kRunning && state != CameraState::kPaused)) {
+    return false;
+  }
+  PooledCamera entry;
+  entry.session = camera->session();
+  entry.texture = camera->DisposeKeepingTexture();
+  entry.key = pool_key(camera->config());
+  entry.id = self->data->next_pool_id++;
+
+  if (entry.session->branch_count() == 0) {
+    GError* error = nullptr;
+    if (!entry.session->Prepare(&error)) {
+      g_warning("Not pooling camera: %s",
+                error ? error->message : "prepare failed");
+      if (error) g_error_free(error);
+      release_pooled(self, &entry);
+      return true;
+    }
+  }
+  entry.timeout_id = g_timeout_add_full(
+      G_PRIORITY_DEFAULT, self->data->pool_idle_ms, on_pool_timeout,
+      new PoolTimeout{self, entry.id},
+      [](gpointer p) { delete static_cast<PoolTimeout*>(p); });
+
+  // One entry per key: a newer camera with the same settings replaces it.
+  auto& pool = self->data->pool;
+  for (auto it = pool.begin(); it != pool.end(); ++it) {
+    if (it->key == entry.key) {
+      release_pooled(self, &*it);
+      pool.erase(it);
+      break;
+    }
+  }
+  pool.push_front(std::move(entry));
+  trim_pool(self, self->data->pool_max_entries);
+  return true;
+}
+
 static void handle_dispose(CameraDesktopPlugin* self,
                            FlMethodCall* method_call) {
   FlValue* args = fl_method_call_get_args(method_call);
@@ -282,12 +1085,267 @@ static void handle_dispose(CameraDesktopPlugin* self,
   auto it = self->data->cameras.find(camera_id);
   if (it != self->data->cameras.end()) {
     camera_desktop_ffi_release_handles_for_camera(it->second.get());
-    it->second->Dispose();
+    if (!park_camera(self, it->second.get())) it->second->Dispose();
     self->data->cameras.erase(it);
   }
+  prune_sessions(self);
   fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
 }
 
+static void handle_create_mosaic(CameraDesktopPlugin* self,
+                                 FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* names = fl_value_lookup_string(args, "cameraNames");
+  if (!names || fl_value_get_type(names) != FL_VALUE_TYPE_LIST ||
+      fl_value_get_length(names) == 0) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "invalid_arguments",
+                                 "cameraNames must be a non-empty list",
+                                 details, nullptr);
+    return;
+  }
+  int count = static_cast<int>(fl_value_get_length(names));
+
+  auto get_int = [args](const char* key, int fallback) {
+    FlValue* v = fl_value_lookup_string(args, key);
+    if (v && fl_value_get_type(v) == FL_VALUE_TYPE_INT) {
+      return static_cast<int>(fl_value_get_int(v));
+    }
+    return fallback;
+  };
+
+  MosaicLayout layout;
+  layout.columns = get_int(
+      "columns", static_cast<int>(std::ceil(std::sqrt((double)count))));
+  if (layout.columns < 1) layout.columns = 1;
+  if (layout.columns > count) layout.columns = count;
+  layout.rows = (count + layout.columns - 1) / layout.columns;
+  layout.tile_width = get_int("tileWidth", 320);
+  layout.tile_height = get_int("tileHeight", 240);
+  layout.fps = get_int("fps", 15);
+  if (layout.fps < 1) layout.fps = 1;
+  if (layout.fps > 60) layout.fps = 60;
+  layout.target_bitrate = get_int("videoBitrate", 0);
+  // Keep tile dimensions even so the composed frame suits the encoder.
+  layout.tile_width = MAX(layout.tile_width & ~1, 16);
+  layout.tile_height = MAX(layout.tile_height & ~1, 16);
+  int resolution_preset =
+      get_int("resolutionPreset", ResolutionPreset::kMedium);
+
+  int mosaic_id = self->data->next_mosaic_id++;
+  auto mosaic = std::make_unique<Mosaic>(mosaic_id, self->texture_registrar,
+                                         self->channel, layout);
+
+  int64_t texture_id = mosaic->RegisterTexture();
+  if (texture_id < 0) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "texture_registration_failed",
+                                 "Failed to register Flutter texture",
+                                 details, nullptr);
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    FlValue* name_val = fl_value_get_list_value(names, i);
+    std::string device_path =
+        fl_value_get_type(name_val) == FL_VALUE_TYPE_STRING
+            ? extract_device_path(fl_value_get_string(name_val))
+            : "";
+    GError* error = nullptr;
+    bool ok = false;
+    if (!device_path.empty()) {
+      // Devices already open by a camera or another mosaic are shared; new
+      // ones open at a modest preset since they only feed a tile. A camera
+      // opened later at a larger size grows the device past it (see
+      // grow_shared_session), so a mosaic never holds a full view down.
+      auto resolutions = DeviceEnumerator::EnumerateResolutions(device_path);
+      auto selected =
+          DeviceEnumerator::SelectResolution(resolutions, resolution_preset);
+      CameraConfig config;
+      config.device_path = device_path;
+      config.resolution_preset = resolution_preset;
+      config.enable_audio = false;
+      config.target_width = selected.width;
+      config.target_height = selected.height;
+      config.target_fps = layout.fps;
+      config.target_bitrate = 0;
+      std::string message;
+      if (grow_shared_session(self, config, &message)) {
+        ok = mosaic->AddTile(i, acquire_session(self, config), &error);
+      } else {
+        error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED,
+                                    message.c_str());
+      }
+    }
+    if (!ok) {
+      g_autoptr(FlValue) details = fl_value_new_null();
+      fl_method_call_respond_error(
+          method_call, "mosaic_tile_failed",
+          error ? error->message : "Could not open camera for mosaic tile",
+          details, nullptr);
+      if (error) g_error_free(error);
+      mosaic->Dispose();
+      prune_sessions(self);
+      return;
+    }
+  }
+
+  mosaic->Start();
+
+  g_autoptr(FlValue) result = fl_value_new_map();
+  fl_value_set_string_take(result, "mosaicId", fl_value_new_int(mosaic_id));
+  fl_value_set_string_take(result, "textureId", fl_value_new_int(texture_id));
+  fl_value_set_string_take(result, "width", fl_value_new_int(mosaic->width()));
+  fl_value_set_string_take(result, "height",
+                           fl_value_new_int(mosaic->height()));
+  self->data->mosaics[mosaic_id] = std::move(mosaic);
+  fl_method_call_respond_success(method_call, result, nullptr);
+}
+
+static Mosaic* find_mosaic(CameraDesktopPlugin* self,
+                           FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  int mosaic_id = fl_value_get_int(fl_value_lookup_string(args, "mosaicId"));
+  auto it = self->data->mosaics.find(mosaic_id);
+  if (it == self->data->mosaics.end()) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "mosaic_not_found",
+                                 "No mosaic found with the given ID",
+                                 details, nullptr);
+    return nullptr;
+  }
+  return it->second.get();
+}
+
+static void handle_start_mosaic_recording(CameraDesktopPlugin* self,
+                                          FlMethodCall* method_call) {
+  Mosaic* mosaic = find_mosaic(self, method_call);
+  if (!mosaic) return;
+  mosaic->StartRecording(method_call);
+}
+
+static void handle_stop_mosaic_recording(CameraDesktopPlugin* self,
+                                         FlMethodCall* method_call) {
+  Mosaic* mosaic = find_mosaic(self, method_call);
+  if (!mosaic) return;
+  mosaic->StopRecording(method_call);
+}
+
+static void handle_dispose_mosaic(CameraDesktopPlugin* self,
+                                  FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  int mosaic_id = fl_value_get_int(fl_value_lookup_string(args, "mosaicId"));
+
+  auto it = self->data->mosaics.find(mosaic_id);
+  if (it != self->data->mosaics.end()) {
+    it->second->Dispose();
+    self->data->mosaics.erase(it);
+  }
+  prune_sessions(self);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_configure_streaming_threads(FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  guint warm_threads = 4;
+  FlValue* warm_val = fl_value_lookup_string(args, "warmThreads");
+  if (warm_val && fl_value_get_type(warm_val) == FL_VALUE_TYPE_INT) {
+    int64_t v = fl_value_get_int(warm_val);
+    warm_threads = v < 0 ? 0 : static_cast<guint>(MIN(v, 256));
+  }
+
+  std::vector<int> cpus;
+  FlValue* cpus_val = fl_value_lookup_string(args, "cpus");
+  if (cpus_val && fl_value_get_type(cpus_val) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(cpus_val); i++) {
+      FlValue* cpu = fl_value_get_list_value(cpus_val, i);
+      if (fl_value_get_type(cpu) != FL_VALUE_TYPE_INT) continue;
+      int64_t index = fl_value_get_int(cpu);
+      if (index >= 0 && index < CPU_SETSIZE) {
+        cpus.push_back(static_cast<int>(index));
+      }
+    }
+  }
+
+  // Applies to streaming threads started from now on; running cameras keep
+  // their current threads until they restart.
+  streaming_thread_pool_configure(streaming_thread_pool_get_default(),
+                                  warm_threads, cpus.data(),
+                                  static_cast<guint>(cpus.size()));
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_configure_camera_pool(CameraDesktopPlugin* self,
+                                         FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+
+  int64_t max_entries = 0;
+  FlValue* max_val = fl_value_lookup_string(args, "maxEntries");
+  if (max_val && fl_value_get_type(max_val) == FL_VALUE_TYPE_INT) {
+    max_entries = CLAMP(fl_value_get_int(max_val), 0, 16);
+  }
+  int64_t idle_ms = kPoolIdleTimeoutMs;
+  FlValue* idle_val = fl_value_lookup_string(args, "idleTimeoutMs");
+  if (idle_val && fl_value_get_type(idle_val) == FL_VALUE_TYPE_INT) {
+    idle_ms = CLAMP(fl_value_get_int(idle_val), 100, 10 * 60 * 1000);
+  }
+
+  // The new expiry applies to cameras parked from now on; a smaller limit
+  // (or 0, which turns pooling off) releases the excess right away.
+  self->data->pool_max_entries = static_cast<size_t>(max_entries);
+  self->data->pool_idle_ms = static_cast<guint>(idle_ms);
+  trim_pool(self, self->data->pool_max_entries);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_configure_idle_buffer_release(CameraDesktopPlugin* self,
+                                                 FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  int64_t idle_ms = kIdleBufferReleaseMs;
+  FlValue* idle_val = fl_value_lookup_string(args, "idleTimeoutMs");
+  if (idle_val && fl_value_get_type(idle_val) == FL_VALUE_TYPE_INT) {
+    idle_ms = fl_value_get_int(idle_val);
+    if (idle_ms > 0) idle_ms = CLAMP(idle_ms, 1000, 60 * 60 * 1000);
+    if (idle_ms < 0) idle_ms = 0;
+  }
+
+  self->data->idle_release_ms = static_cast<int>(idle_ms);
+  for (auto& pair : self->data->cameras) {
+    pair.second->SetIdleBufferRelease(self->data->idle_release_ms);
+  }
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_set_frame_tracing(FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* enabled_val = fl_value_lookup_string(args, "enabled");
+  frame_trace::SetEnabled(enabled_val && fl_value_get_bool(enabled_val));
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+static void handle_dump_trace(FlMethodCall* method_call) {
+  FlValue* args = fl_method_call_get_args(method_call);
+  FlValue* path_val = fl_value_lookup_string(args, "path");
+  if (!path_val || fl_value_get_type(path_val) != FL_VALUE_TYPE_STRING) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "invalid_args",
+                                 "path is required", details, nullptr);
+    return;
+  }
+
+  std::string error;
+  int64_t events = frame_trace::Dump(fl_value_get_string(path_val), &error);
+  if (events < 0) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "trace_write_failed",
+                                 error.c_str(), details, nullptr);
+    return;
+  }
+  fl_method_call_respond_success(method_call, fl_value_new_int(events),
+                                 nullptr);
+}
+
 // --- Plugin lifecycle ---
 
 static void camera_desktop_plugin_handle_method_call(
@@ -301,6 +1359,8 @@ static void camera_desktop_plugin_handle_method_call(
     handle_get_platform_capabilities(method_call);
   } else if (strcmp(method, "create") == 0) {
     handle_create(self, method_call);
+  } else if (strcmp(method, "prepare") == 0) {
+    handle_prepare(self, method_call);
   } else if (strcmp(method, "initialize") == 0) {
     handle_initialize(self, method_call);
   } else if (strcmp(method, "takePicture") == 0) {
@@ -309,6 +1369,8 @@ static void camera_desktop_plugin_handle_method_call(
     handle_start_video_recording(self, method_call);
   } else if (strcmp(method, "stopVideoRecording") == 0) {
     handle_stop_video_recording(self, method_call);
+  } else if (strcmp(method, "setDescriptionWhileRecording") == 0) {
+    handle_set_description_while_recording(self, method_call);
   } else if (strcmp(method, "startImageStream") == 0) {
     handle_start_image_stream(self, method_call);
   } else if (strcmp(method, "stopImageStream") == 0) {
@@ -317,10 +1379,52 @@ static void camera_desktop_plugin_handle_method_call(
     handle_pause_preview(self, method_call);
   } else if (strcmp(method, "resumePreview") == 0) {
     handle_resume_preview(self, method_call);
+  } else if (strcmp(method, "setStandby") == 0) {
+    handle_set_standby(self, method_call);
+  } else if (strcmp(method, "setAdaptiveFrameRate") == 0) {
+    handle_set_adaptive_frame_rate(self, method_call);
+  } else if (strcmp(method, "setStaticFrameSkipping") == 0) {
+    handle_set_static_frame_skipping(self, method_call);
+  } else if (strcmp(method, "setAppVisibility") == 0) {
+    handle_set_app_visibility(self, method_call);
   } else if (strcmp(method, "setMirror") == 0) {
     handle_set_mirror(self, method_call);
+  } else if (strcmp(method, "getCameraStats") == 0) {
+    handle_get_camera_stats(self, method_call);
+  } else if (strcmp(method, "getMemoryUsage") == 0) {
+    handle_get_memory_usage(self, method_call);
+  } else if (strcmp(method, "setMemoryBudget") == 0) {
+    handle_set_memory_budget(self, method_call);
+  } else if (strcmp(method, "setCameraStatsInterval") == 0) {
+    handle_set_camera_stats_interval(self, method_call);
+  } else if (strcmp(method, "setLatencyTracing") == 0) {
+    handle_set_latency_tracing(self, method_call);
+  } else if (strcmp(method, "setReconnectPolicy") == 0) {
+    handle_set_reconnect_policy(self, method_call);
+  } else if (strcmp(method, "getPipelineLatency") == 0) {
+    handle_get_pipeline_latency(self, method_call);
+  } else if (strcmp(method, "setThreadScheduling") == 0) {
+    handle_set_thread_scheduling(self, method_call);
   } else if (strcmp(method, "dispose") == 0) {
     handle_dispose(self, method_call);
+  } else if (strcmp(method, "setFrameTracing") == 0) {
+    handle_set_frame_tracing(method_call);
+  } else if (strcmp(method, "dumpTrace") == 0) {
+    handle_dump_trace(method_call);
+  } else if (strcmp(method, "configureCameraPool") == 0) {
+    handle_configure_camera_pool(self, method_call);
+  } else if (strcmp(method, "configureIdleBufferRelease") == 0) {
+    handle_configure_idle_buffer_release(self, method_call);
+  } else if (strcmp(method, "configureStreamingThreads") == 0) {
+    handle_configure_streaming_threads(method_call);
+  } else if (strcmp(method, "createMosaic") == 0) {
+    handle_create_mosaic(self, method_call);
+  } else if (strcmp(method, "startMosaicRecording") == 0) {
+    handle_start_mosaic_recording(self, method_call);
+  } else if (strcmp(method, "stopMosaicRecording") == 0) {
+    handle_stop_mosaic_recording(self, method_call);
+  } else if (strcmp(method, "disposeMosaic") == 0) {
+    handle_dispose_mosaic(self, method_call);
   } else {
     fl_method_call_respond_not_implemented(method_call, nullptr);
   }
@@ -330,6 +1434,8 @@ static void method_call_cb(FlMethodChannel* channel,
                            FlMethodCall* method_call,
                            gpointer user_data) {
   CameraDesktopPlugin* plugin = CAMERA_DESKTOP_PLUGIN(user_data);
+  // Only waits if the app calls in before background initialization is done.
+  GstWarmup::EnsureInitialized();
   camera_desktop_plugin_handle_method_call(plugin, method_call);
 }
 
@@ -342,6 +1448,15 @@ static void camera_desktop_plugin_dispose(GObject* object) {
       camera_desktop_ffi_release_handles_for_camera(pair.second.get());
       pair.second->Dispose();
     }
+    for (auto& pair : self->data->mosaics) {
+      pair.second->Dispose();
+    }
+    for (auto& pair : self->data->prepared) {
+      if (pair.second.timeout_id > 0) g_source_remove(pair.second.timeout_id);
+    }
+    for (PooledCamera& entry : self->data->pool) {
+      release_pooled(self, &entry);
+    }
     delete self->data;
     self->data = nullptr;
   }
@@ -361,8 +1476,9 @@ static void camera_desktop_plugin_init(CameraDesktopPlugin* self) {
 
 void camera_desktop_plugin_register_with_registrar(
     FlPluginRegistrar* registrar) {
-  // Initialize GStreamer (safe to call multiple times).
-  gst_init(nullptr, nullptr);
+  // GStreamer is initialized in the background so app launch does not wait
+  // for the registry scan; method calls wait for it if they arrive first.
+  GstWarmup::Start();
 
   CameraDesktopPlugin* plugin = CAMERA_DESKTOP_PLUGIN(
       g_object_new(camera_desktop_plugin_get_type(), nullptr));
@@ -0,0 +1,60 @@
+#include "camera_stats.h"
+
+#include <algorithm>
+
+namespace {
+
+int BucketFor(uint64_t us) {
+  int bucket = 0;
+  while (us > 1 && bucket < LatencyHistogram::kBuckets - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : count_(0), sum_us_(0), max_us_(0) {
+  for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Record(int64_t us) {
+  uint64_t value = us < 0 ? 0 : static_cast<uint64_t>(us);
+  StatsBump(buckets_[BucketFor(value)]);
+  StatsBump(count_);
+  StatsBump(sum_us_, value);
+  if (value > max_us_.load(std::memory_order_relaxed)) {
+    max_us_.store(value, std::memory_order_relaxed);
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Read() const {
+  Snapshot snapshot;
+  for (int i = 0; i < kBuckets; i++) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count = count_.load(std::memory_order_relaxed);
+  snapshot.sum_us = sum_us_.load(std::memory_order_relaxed);
+  snapshot.max_us = max_us_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+uint64_t LatencyHistogram::Snapshot::Percentile(double p) const {
+  // Sum the buckets rather than trusting |count|: the writer may be between
+  // the two stores.
+  uint64_t total = 0;
+  for (int i = 0; i < kBuckets; i++) total += buckets[i];
+  if (total == 0) return 0;
+
+  uint64_t rank = static_cast<uint64_t>(p * (total - 1)) + 1;
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      uint64_t upper = (uint64_t{1} << (i + 1)) - 1;
+      return std::min(upper, max_us);
+    }
+  }
+  return max_us;
+}
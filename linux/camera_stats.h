@@ -0,0 +1,65 @@
+#ifndef CAMERA_STATS_H_
+#define CAMERA_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free performance counters for one camera.
+//
+// Every field has exactly one writer thread (noted per field), so updates
+// are a relaxed load + store with no read-modify-write and no lock: the
+// cost on the hot path is a few plain moves. Readers on any thread get a
+// consistent value per field, though not a consistent snapshot across
+// fields.
+
+// Adds |n| to a counter owned by the calling thread.
+inline void StatsBump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+  counter.store(counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+
+// Log2 histogram of durations in microseconds. Bucket i counts samples in
+// [2^i, 2^(i+1)) us, with 0 us counted in bucket 0; the last bucket is
+// open-ended. Single writer, any number of readers.
+class LatencyHistogram {
+ public:
+  static constexpr int kBuckets = 24;  // Last bucket starts at ~8.4 s.
+
+  struct Snapshot {
+    uint64_t buckets[kBuckets];
+    uint64_t count;
+    uint64_t sum_us;
+    uint64_t max_us;
+
+    // Upper bound of the bucket holding the |p| quantile (0..1), capped at
+    // the observed maximum. 0 when empty.
+    uint64_t Percentile(double p) const;
+    double MeanUs() const { return count ? double(sum_us) / count : 0.0; }
+  };
+
+  LatencyHistogram();
+
+  void Record(int64_t us);
+  Snapshot Read() const;
+
+ private:
+  std::atomic<uint64_t> buckets_[kBuckets];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_us_;
+  std::atomic<uint64_t> max_us_;
+};
+
+struct CameraStats {
+  // Written by the branch streaming thread.
+  std::atomic<uint64_t> frames_arrived{0};    // Buffers reaching the appsink.
+  std::atomic<uint64_t> frames_captured{0};   // Samples pulled in OnNewSample.
+  std::atomic<uint64_t> preview_updated{0};   // Frames written to the texture.
+  std::atomic<uint64_t> stream_published{0};  // Frames written to the stream.
+  std::atomic<uint64_t> stream_skipped{0};    // Overwritten before Dart read.
+  std::atomic<uint64_t> frames_unchanged{0};  // Matched the last delivered.
+  std::atomic<uint64_t> preview_decimated{0};  // Above kPreviewMaxFps.
+  LatencyHistogram copy_time;           // Texture copy in OnNewSample.
+  LatencyHistogram capture_to_texture;  // Buffer PTS to texture handoff.
+};
+
+#endif  // CAMERA_STATS_H_
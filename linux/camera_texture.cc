@@ -1,6 +1,10 @@
 #include "camera_texture.h"
 
 #include <cstring>
+#include <utility>
+
+#include "frame_copy.h"
+#include "frame_trace.h"
 
 // Triple-buffer texture for safe GStreamer→Flutter frame delivery.
 //
@@ -9,15 +13,25 @@
 // - Flutter render thread (copy_pixels) swaps ready_idx ↔ read_idx (under
 //   mutex) and returns buffers[read_idx]. This buffer is safe because neither
 //   the GStreamer thread nor the swap touches it until the next copy_pixels.
+//
+// Double-buffered (see camera_texture_set_buffer_count), there is no write
+// buffer: the GStreamer thread writes into buffers[ready_idx] itself, with
+// has_new_frame cleared for the duration so copy_pixels does not take it
+// half-written.
 
 struct _CameraTexture {
   FlPixelBufferTexture parent_instance;
 
+  // Heap-held so the shared_ptr survives GObject's zero-initialized
+  // instance memory; created in init, deleted in finalize.
+  std::shared_ptr<FrameAllocator>* allocator;
   uint8_t* buffers[3];
   int write_idx;
   int read_idx;
   int ready_idx;
   gboolean has_new_frame;
+  int buffer_count;          // 2 or 3. Set by the streaming thread.
+  int pending_buffer_count;  // Requested count, or 0. Under the mutex.
 
   uint32_t width;
   uint32_t height;
@@ -36,6 +50,7 @@ static gboolean camera_texture_copy_pixels_impl(
     uint32_t* height,
     GError** error) {
   CameraTexture* self = CAMERA_TEXTURE(texture);
+  frame_trace::Scope trace("copy_pixels", 0);
 
   g_mutex_lock(&self->mutex);
 
@@ -66,7 +81,7 @@ static void camera_texture_dispose(GObject* object) {
 
   g_mutex_lock(&self->mutex);
   for (int i = 0; i < 3; i++) {
-    g_free(self->buffers[i]);
+    (*self->allocator)->Release(self->buffers[i], self->buffer_size);
     self->buffers[i] = nullptr;
   }
   self->width = 0;
@@ -74,23 +89,37 @@ static void camera_texture_dispose(GObject* object) {
   self->buffer_size = 0;
   g_mutex_unlock(&self->mutex);
 
+  G_OBJECT_CLASS(camera_texture_parent_class)->dispose(object);
+}
+
+static void camera_texture_finalize(GObject* object) {
+  CameraTexture* self = CAMERA_TEXTURE(object);
+
+  // dispose may run more than once; the mutex and the allocator must
+  // outlive every run.
   g_mutex_clear(&self->mutex);
+  delete self->allocator;
+  self->allocator = nullptr;
 
-  G_OBJECT_CLASS(camera_texture_parent_class)->dispose(object);
+  G_OBJECT_CLASS(camera_texture_parent_class)->finalize(object);
 }
 
 static void camera_texture_class_init(CameraTextureClass* klass) {
   G_OBJECT_CLASS(klass)->dispose = camera_texture_dispose;
+  G_OBJECT_CLASS(klass)->finalize = camera_texture_finalize;
   FL_PIXEL_BUFFER_TEXTURE_CLASS(klass)->copy_pixels =
       camera_texture_copy_pixels_impl;
 }
 
 static void camera_texture_init(CameraTexture* self) {
   g_mutex_init(&self->mutex);
+  self->allocator = new std::shared_ptr<FrameAllocator>();
   self->write_idx = 0;
   self->read_idx = 1;
   self->ready_idx = 2;
   self->has_new_frame = FALSE;
+  self->buffer_count = 3;
+  self->pending_buffer_count = 0;
   self->width = 0;
   self->height = 0;
   self->buffer_size = 0;
@@ -100,7 +129,80 @@ static void camera_texture_init(CameraTexture* self) {
 }
 
 CameraTexture* camera_texture_new(void) {
-  return CAMERA_TEXTURE(g_object_new(CAMERA_TEXTURE_TYPE, nullptr));
+  return camera_texture_new_with_allocator(std::make_shared<FrameAllocator>());
+}
+
+CameraTexture* camera_texture_new_with_allocator(
+    std::shared_ptr<FrameAllocator> allocator) {
+  CameraTexture* self =
+      CAMERA_TEXTURE(g_object_new(CAMERA_TEXTURE_TYPE, nullptr));
+  *self->allocator = std::move(allocator);
+  return self;
+}
+
+std::shared_ptr<FrameAllocator> camera_texture_get_allocator(
+    CameraTexture* self) {
+  return *self->allocator;
+}
+
+// Switches to pending_buffer_count buffers. Called with the mutex held, from
+// the streaming thread outside of a write, so no buffer is mid-write; the
+// one copy_pixels handed out last is kept.
+static void camera_texture_apply_buffer_count(CameraTexture* self,
+                                              FrameAllocator* allocator) {
+  int count = self->pending_buffer_count;
+  self->pending_buffer_count = 0;
+  if (count == self->buffer_count) return;
+
+  if (count == 2) {
+    allocator->Release(self->buffers[self->write_idx], self->buffer_size);
+    uint8_t* read = self->buffers[self->read_idx];
+    uint8_t* ready = self->buffers[self->ready_idx];
+    self->buffers[0] = read;
+    self->buffers[1] = ready;
+    self->buffers[2] = nullptr;
+    self->read_idx = 0;
+    self->ready_idx = 1;
+    self->write_idx = 2;  // Unused while double-buffered.
+  } else {
+    self->buffers[2] =
+        self->buffer_size > 0 ? allocator->Allocate(self->buffer_size)
+                              : nullptr;
+    self->write_idx = 2;
+  }
+  self->buffer_count = count;
+}
+
+void camera_texture_set_buffer_count(CameraTexture* self, int count) {
+  g_return_if_fail(CAMERA_IS_TEXTURE(self));
+  g_return_if_fail(count == 2 || count == 3);
+  g_mutex_lock(&self->mutex);
+  self->pending_buffer_count = count;
+  g_mutex_unlock(&self->mutex);
+}
+
+void camera_texture_trim(CameraTexture* self) {
+  g_return_if_fail(CAMERA_IS_TEXTURE(self));
+  g_mutex_lock(&self->mutex);
+  for (int i = 0; i < 3; i++) {
+    if (i == self->read_idx || (self->has_new_frame && i == self->ready_idx)) {
+      continue;
+    }
+    (*self->allocator)->Release(self->buffers[i], self->buffer_size);
+    self->buffers[i] = nullptr;
+  }
+  g_mutex_unlock(&self->mutex);
+}
+
+size_t camera_texture_get_memory(CameraTexture* self) {
+  g_return_val_if_fail(CAMERA_IS_TEXTURE(self), 0);
+  g_mutex_lock(&self->mutex);
+  size_t bytes = 0;
+  for (int i = 0; i < 3; i++) {
+    if (self->buffers[i]) bytes += self->buffer_size;
+  }
+  g_mutex_unlock(&self->mutex);
+  return bytes;
 }
 
 void camera_texture_update(CameraTexture* self,
@@ -109,6 +211,7 @@ void camera_texture_update(CameraTexture* self,
                            uint32_t height) {
   g_return_if_fail(CAMERA_IS_TEXTURE(self));
   g_return_if_fail(data != nullptr);
+  frame_trace::Scope trace("camera_texture_update", 0);
 
   size_t required = (size_t)width * height * 4;
 
@@ -119,20 +222,34 @@ void camera_texture_update(CameraTexture* self,
   // buffers[read_idx] concurrently and we must not free it mid-read.
   g_mutex_lock(&self->mutex);
 
+  FrameAllocator* allocator = self->allocator->get();
+  if (self->pending_buffer_count != 0) {
+    camera_texture_apply_buffer_count(self, allocator);
+  }
+
   if (required != self->buffer_size) {
-    for (int i = 0; i < 3; i++) {
-      g_free(self->buffers[i]);
-      self->buffers[i] = (uint8_t*)g_malloc(required);
+    for (int i = 0; i < self->buffer_count; i++) {
+      allocator->Release(self->buffers[i], self->buffer_size);
+      self->buffers[i] = allocator->Allocate(required);
     }
     self->buffer_size = required;
     self->width = width;
     self->height = height;
+  } else {
+    // Buffers given back by camera_texture_trim.
+    for (int i = 0; i < self->buffer_count; i++) {
+      if (!self->buffers[i]) self->buffers[i] = allocator->Allocate(required);
+    }
   }
 
   // Capture the current write index while the lock is held. write_idx is
   // exclusively owned by this thread (only this function ever modifies it),
   // so it will not change between now and Phase 3.
   int wi = self->write_idx;
+  if (self->buffer_count == 2) {
+    wi = self->ready_idx;
+    self->has_new_frame = FALSE;
+  }
 
   g_mutex_unlock(&self->mutex);
 
@@ -145,14 +262,18 @@ void camera_texture_update(CameraTexture* self,
   //   - The consumer (copy_pixels_impl) only ever swaps ready_idx ↔ read_idx,
   //     never write_idx. So buffers[wi] is not touched by any other thread
   //     while we're here.
-  memcpy(self->buffers[wi], data, required);
+  // Large frames are written with streaming stores (see frame_copy.h): the
+  // raster thread reads them once, later, from another core.
+  CopyFrame(self->buffers[wi], data, required);
 
   // --- Phase 3: atomically swap write ↔ ready under the lock. ---
   g_mutex_lock(&self->mutex);
 
-  int tmp = self->write_idx;
-  self->write_idx = self->ready_idx;
-  self->ready_idx = tmp;
+  if (self->buffer_count == 3) {
+    int tmp = self->write_idx;
+    self->write_idx = self->ready_idx;
+    self->ready_idx = tmp;
+  }
   self->has_new_frame = TRUE;
 
   g_mutex_unlock(&self->mutex);
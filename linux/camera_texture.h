@@ -3,13 +3,17 @@
 
 #include <flutter_linux/flutter_linux.h>
 
+#include <memory>
+
+#include "frame_allocator.h"
+
 G_BEGIN_DECLS
 
 #define CAMERA_TEXTURE_TYPE (camera_texture_get_type())
 G_DECLARE_FINAL_TYPE(CameraTexture, camera_texture, CAMERA, TEXTURE,
                      FlPixelBufferTexture)
 
-// Creates a new CameraTexture instance.
+// Creates a new CameraTexture instance with a frame allocator of its own.
 CameraTexture* camera_texture_new(void);
 
 // Updates the texture with new RGBA frame data.
@@ -22,9 +26,33 @@ void camera_texture_update(CameraTexture* self,
                            uint32_t width,
                            uint32_t height);
 
+// Switches between triple (3, the default) and double (2) buffering; takes
+// effect with the next camera_texture_update. Double buffering saves a frame
+// of memory, at the cost of the render thread occasionally finding the only
+// spare buffer mid-write and showing the previous frame once more.
+void camera_texture_set_buffer_count(CameraTexture* self, int count);
+
+// Gives back every frame buffer except the one on screen (and a newer one
+// the render thread has yet to take), for a texture that is not being
+// updated. The next camera_texture_update allocates them again. Must not run
+// concurrently with camera_texture_update.
+void camera_texture_trim(CameraTexture* self);
+
+// Bytes of frame buffers the texture holds.
+size_t camera_texture_get_memory(CameraTexture* self);
+
 // Returns the FlTexture base pointer (for registrar calls).
 FlTexture* camera_texture_as_fl_texture(CameraTexture* self);
 
 G_END_DECLS
 
+// Creates a texture whose frame buffers come from |allocator|, normally the
+// allocator of the camera the texture belongs to.
+CameraTexture* camera_texture_new_with_allocator(
+    std::shared_ptr<FrameAllocator> allocator);
+
+// Returns the allocator serving the texture's frame buffers.
+std::shared_ptr<FrameAllocator> camera_texture_get_allocator(
+    CameraTexture* self);
+
 #endif  // CAMERA_TEXTURE_H_
@@ -0,0 +1,985 @@
+#include "capture_session.h"
+
+#include <gio/gio.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "control_thread.h"
+#include "device_enumerator.h"
+#include "streaming_thread_pool.h"
+
+// Upper bound on how long DetachBranch waits for the tee pad to go idle
+// before forcing the branch down. The pad is normally idle within one frame
+// interval; it only stays busy if the branch itself is blocked downstream.
+static const gint64 kDetachIdleTimeoutUs = G_USEC_PER_SEC;
+
+// How long a reconnect attempt waits for the restarted source's first frame
+// before counting as failed.
+static const guint kReconnectFrameTimeoutMs = 3000;
+
+const char CaptureSession::kReconnectMessage[] = "capture-session-reconnect";
+
+struct CaptureSession::TeeWatch {
+  std::weak_ptr<CaptureSession> session;  // Locked on the main thread only.
+  bool loop_source = false;
+  std::atomic<bool> reconnect_enabled{false};
+  // Raised while the source restarts; the first frame after it lowers it.
+  std::atomic<bool> restarting{false};
+  // Raised while a looping source seeks back; its new segment lowers it.
+  std::atomic<bool> rewinding{false};
+};
+
+CaptureSession::CaptureSession(const CameraConfig& config)
+    : config_(config),
+      pipeline_(nullptr),
+      tee_(nullptr),
+      bus_watch_(nullptr),
+      playing_(false),
+      capture_owner_(nullptr) {
+  g_mutex_init(&sched_mutex_);
+}
+
+CaptureSession::~CaptureSession() {
+  // Cameras detach their branches before dropping the session, so normally
+  // nothing is left here; stop the pipeline regardless.
+  if (prepare_cancelled_) prepare_cancelled_->store(true);
+  CancelReconnect();
+  for (GstElement* element : source_elements_) gst_object_unref(element);
+  source_elements_.clear();
+  if (pipeline_) {
+    gst_element_set_state(pipeline_, GST_STATE_NULL);
+    if (bus_watch_) {
+      g_source_destroy(bus_watch_);
+      g_source_unref(bus_watch_);
+      bus_watch_ = nullptr;
+    }
+    for (auto& branch : branches_) {
+      gst_element_release_request_pad(tee_, branch.tee_pad);
+      gst_object_unref(branch.tee_pad);
+    }
+    branches_.clear();
+    gst_object_unref(pipeline_);
+    pipeline_ = nullptr;
+    tee_ = nullptr;
+  }
+  g_mutex_clear(&sched_mutex_);
+}
+
+bool CaptureSession::BuildPipeline(GError** error) {
+  // The source stops at the tee; scaling and mirroring live in the per-camera
+  // branches so two cameras on one device can differ in both.
+  // allow-not-linked keeps the source running while branches come and go.
+  gchar* source_str =
+      config_.source.empty()
+          ? g_strdup_printf("v4l2src name=src device=%s",
+                            config_.device_path.c_str())
+          : g_strdup(config_.source.c_str());
+  gchar* pipeline_str = g_strdup_printf(
+      "%s "
+      "! videoconvert "
+      "! capsfilter name=srccaps "
+      "caps=\"video/x-raw,format=RGBA,width=%d,height=%d,framerate=%d/1\" "
+      "! tee name=t allow-not-linked=true",
+      source_str, config_.target_width, config_.target_height,
+      config_.target_fps);
+  g_free(source_str);
+
+  parse_start_us_ = g_get_monotonic_time();
+  pipeline_ = gst_parse_launch(pipeline_str, error);
+  parsed_us_ = g_get_monotonic_time();
+  g_free(pipeline_str);
+
+  if (!pipeline_) {
+    return false;
+  }
+
+  tee_ = gst_bin_get_by_name(GST_BIN(pipeline_), "t");
+  if (!tee_) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to find tee in pipeline");
+    gst_object_unref(pipeline_);
+    pipeline_ = nullptr;
+    return false;
+  }
+  // Release our ref (pipeline holds one).
+  gst_object_unref(tee_);
+
+  GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
+  // The sync handler sees stream-status messages while the posting element
+  // is still creating its task, which is the only point a pool can be set.
+  gst_bus_set_sync_handler(bus, CaptureSession::OnSyncMessage, this, nullptr);
+  // Bus traffic is handled on the control thread so it never waits behind,
+  // or wakes, the GTK main loop.
+  bus_watch_ = gst_bus_create_watch(bus);
+  g_source_set_callback(
+      bus_watch_, reinterpret_cast<GSourceFunc>(CaptureSession::OnBusMessage),
+      new std::weak_ptr<CaptureSession>(shared_from_this()),
+      [](gpointer p) { delete static_cast<std::weak_ptr<CaptureSession>*>(p); });
+  g_source_attach(bus_watch_, ControlThread::Context());
+  gst_object_unref(bus);
+
+  // Everything parsed so far besides the tee is the source side, which a
+  // reconnect restarts on its own.
+  GstIterator* it = gst_bin_iterate_elements(GST_BIN(pipeline_));
+  GValue item = G_VALUE_INIT;
+  while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+    auto* element = GST_ELEMENT(g_value_get_object(&item));
+    if (element != tee_) {
+      source_elements_.push_back(GST_ELEMENT(gst_object_ref(element)));
+    }
+    g_value_reset(&item);
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+  if (config_.source.empty()) {
+    bus_info_ = DeviceEnumerator::QueryBusInfo(config_.device_path);
+  }
+
+  tee_watch_ = std::make_shared<TeeWatch>();
+  tee_watch_->session = shared_from_this();
+  tee_watch_->loop_source = config_.loop_source;
+  tee_watch_->reconnect_enabled.store(reconnect_policy_.enabled);
+  GstPad* tee_sink = gst_element_get_static_pad(tee_, "sink");
+  gst_pad_add_probe(
+      tee_sink,
+      static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM |
+                                   GST_PAD_PROBE_TYPE_EVENT_FLUSH |
+                                   GST_PAD_PROBE_TYPE_BUFFER),
+      CaptureSession::OnTeeProbe,
+      new std::shared_ptr<TeeWatch>(tee_watch_),
+      [](gpointer p) { delete static_cast<std::shared_ptr<TeeWatch>*>(p); });
+  gst_object_unref(tee_sink);
+
+  return true;
+}
+
+GstPadProbeReturn CaptureSession::OnTeeProbe(GstPad* pad,
+                                             GstPadProbeInfo* info,
+                                             gpointer user_data) {
+  auto* watch = static_cast<std::shared_ptr<TeeWatch>*>(user_data)->get();
+
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    if (watch->restarting.load(std::memory_order_relaxed) &&
+        watch->restarting.exchange(false)) {
+      auto* session = new std::weak_ptr<CaptureSession>(watch->session);
+      g_idle_add(
+          [](gpointer p) -> gboolean {
+            auto* weak = static_cast<std::weak_ptr<CaptureSession>*>(p);
+            if (auto session = weak->lock()) session->OnSourceRecovered();
+            delete weak;
+            return G_SOURCE_REMOVE;
+          },
+          session);
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstEventType type = GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info));
+  if (watch->restarting.load() &&
+      (type == GST_EVENT_STREAM_START || type == GST_EVENT_SEGMENT)) {
+    // The restarted source opens a new stream; downstream it is the same
+    // one continuing, so an encoder or muxer never resets mid-file.
+    return GST_PAD_PROBE_DROP;
+  }
+  if (watch->rewinding.load()) {
+    // The rewind flushes the source side only. The segment it opens carries
+    // the running time on, so it goes through and ends the rewind.
+    if (type == GST_EVENT_FLUSH_START || type == GST_EVENT_FLUSH_STOP) {
+      return GST_PAD_PROBE_DROP;
+    }
+    if (type == GST_EVENT_SEGMENT) watch->rewinding.store(false);
+  }
+  if (type != GST_EVENT_EOS) return GST_PAD_PROBE_OK;
+
+  if (watch->loop_source) {
+    // Seeking from the streaming thread that is delivering EOS would
+    // deadlock on its own stream lock; rewind from the main thread instead.
+    // Branches never see the EOS, so previews and streams just carry on.
+    auto* session = new std::weak_ptr<CaptureSession>(watch->session);
+    g_idle_add(
+        [](gpointer p) -> gboolean {
+          auto* weak = static_cast<std::weak_ptr<CaptureSession>*>(p);
+          if (auto session = weak->lock()) session->Rewind();
+          delete weak;
+          return G_SOURCE_REMOVE;
+        },
+        session);
+    return GST_PAD_PROBE_DROP;
+  }
+  if (watch->reconnect_enabled.load()) {
+    // A source that ends (rather than failing) is lost all the same; an
+    // EOS let through would finalize every recording.
+    auto* session = new std::weak_ptr<CaptureSession>(watch->session);
+    g_idle_add(
+        [](gpointer p) -> gboolean {
+          auto* weak = static_cast<std::weak_ptr<CaptureSession>*>(p);
+          if (auto session = weak->lock()) session->OnSourceLost(nullptr);
+          delete weak;
+          return G_SOURCE_REMOVE;
+        },
+        session);
+    return GST_PAD_PROBE_DROP;
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+void CaptureSession::Rewind() {
+  if (!pipeline_ || !playing_) return;
+  // Only the source side seeks, as only it restarts on a reconnect; the tee
+  // probe keeps the flush from the branches, so recordings run on across the
+  // loop point. The restarted clip would start its running time over, so it
+  // is offset to the present where the source is paced, and both the pacing
+  // and the timestamps downstream carry on from the last pass.
+  GstClockTime now = GST_CLOCK_TIME_NONE;
+  if (GstClock* clock = gst_element_get_clock(pipeline_)) {
+    now = gst_clock_get_time(clock) - gst_element_get_base_time(pipeline_);
+    gst_object_unref(clock);
+  }
+  GstPad* tee_sink = gst_element_get_static_pad(tee_, "sink");
+  GstPad* source_pad = gst_pad_get_peer(tee_sink);
+  gst_object_unref(tee_sink);
+  if (!source_pad) return;
+  GstPad* paced_pad = nullptr;
+  for (GstElement* element : source_elements_) {
+    GstElementFactory* factory = gst_element_get_factory(element);
+    if (factory && g_strcmp0(GST_OBJECT_NAME(factory), "clocksync") == 0) {
+      paced_pad = gst_element_get_static_pad(element, "sink");
+      break;
+    }
+  }
+  if (!paced_pad) paced_pad = GST_PAD(gst_object_ref(source_pad));
+  if (GST_CLOCK_TIME_IS_VALID(now)) {
+    gst_pad_set_offset(paced_pad, static_cast<gint64>(now));
+  }
+  gst_object_unref(paced_pad);
+
+  tee_watch_->rewinding.store(true);
+  // Sent from the tee's upstream peer, the seek travels up the source side
+  // to the element that can serve it.
+  if (!gst_pad_send_event(
+          source_pad,
+          gst_event_new_seek(1.0, GST_FORMAT_TIME,
+                             static_cast<GstSeekFlags>(GST_SEEK_FLAG_FLUSH |
+                                                       GST_SEEK_FLAG_KEY_UNIT),
+                             GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_NONE,
+                             GST_CLOCK_TIME_NONE))) {
+    tee_watch_->rewinding.store(false);
+    g_warning("Failed to loop capture source %s",
+              config_.device_path.c_str());
+  }
+  gst_object_unref(source_pad);
+}
+
+bool CaptureSession::AttachBranch(GstElement* branch,
+                                  MessageCallback callback,
+                                  gpointer user_data,
+                                  GError** error) {
+  if (!pipeline_ && !BuildPipeline(error)) {
+    return false;
+  }
+
+  gst_bin_add(GST_BIN(pipeline_), branch);
+
+  GstPad* tee_pad = gst_element_request_pad_simple(tee_, "src_%u");
+  GstPad* branch_pad = gst_element_get_static_pad(branch, "sink");
+  GstPadLinkReturn link_ret = GST_PAD_LINK_REFUSED;
+  if (tee_pad && branch_pad) {
+    link_ret = gst_pad_link(tee_pad, branch_pad);
+  }
+  if (branch_pad) gst_object_unref(branch_pad);
+
+  if (link_ret != GST_PAD_LINK_OK) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to link camera branch to capture session");
+    if (tee_pad) {
+      gst_element_release_request_pad(tee_, tee_pad);
+      gst_object_unref(tee_pad);
+    }
+    gst_bin_remove(GST_BIN(pipeline_), branch);
+    return false;
+  }
+
+  branches_.push_back({branch, tee_pad, callback, user_data, false});
+  // Registered before the branch starts so its threads' ENTER messages can
+  // be attributed to it.
+  g_mutex_lock(&sched_mutex_);
+  schedules_.emplace_back(branch, CameraThreadSchedule());
+  g_mutex_unlock(&sched_mutex_);
+
+  if (playing_ && !standby_) {
+    // Joining a live pipeline: bring only the new branch up.
+    if (!gst_element_sync_state_with_parent(branch)) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                  "Failed to start camera branch");
+      DetachBranch(branch);
+      return false;
+    }
+    return true;
+  }
+
+  if (prepare_cancelled_) prepare_cancelled_->store(true);
+  playing_us_.store(0);
+  play_requested_us_ = g_get_monotonic_time();
+  GstStateChangeReturn ret =
+      gst_element_set_state(pipeline_, GST_STATE_PLAYING);
+  if (ret == GST_STATE_CHANGE_FAILURE) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to start GStreamer pipeline");
+    DetachBranch(branch);
+    return false;
+  }
+  playing_ = true;
+  standby_ = false;
+  return true;
+}
+
+bool CaptureSession::SetBranchStandby(GstElement* branch, bool standby,
+                                      GError** error) {
+  auto it = std::find_if(branches_.begin(), branches_.end(),
+                         [branch](const Branch& b) { return b.bin == branch; });
+  if (it == branches_.end()) return true;
+  it->standby = standby;
+  if (standby) {
+    UpdateStandby();
+    return true;
+  }
+  if (!standby_) return true;
+
+  playing_us_.store(0);
+  play_requested_us_ = g_get_monotonic_time();
+  if (gst_element_set_state(pipeline_, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to restart the camera from standby");
+    it->standby = true;
+    gst_element_set_state(pipeline_, GST_STATE_READY);
+    return false;
+  }
+  standby_ = false;
+  return true;
+}
+
+void CaptureSession::UpdateStandby() {
+  if (!playing_ || standby_ || branches_.empty()) return;
+  for (const Branch& b : branches_) {
+    if (!b.standby) return;
+  }
+  // A reconnect would only restart the source into a stopped pipeline; the
+  // next start opens the device again anyway.
+  CancelReconnect();
+  gst_element_set_state(pipeline_, GST_STATE_READY);
+  standby_ = true;
+}
+
+void CaptureSession::SetReconnectPolicy(const ReconnectPolicy& policy) {
+  reconnect_policy_ = policy;
+  if (reconnect_policy_.initial_delay_ms < 1) {
+    reconnect_policy_.initial_delay_ms = 1;
+  }
+  if (reconnect_policy_.max_delay_ms < reconnect_policy_.initial_delay_ms) {
+    reconnect_policy_.max_delay_ms = reconnect_policy_.initial_delay_ms;
+  }
+  if (tee_watch_) tee_watch_->reconnect_enabled.store(policy.enabled);
+}
+
+bool CaptureSession::OnSourceLost(GstMessage* error) {
+  // Only a source that was streaming is reconnected; failing to open in the
+  // first place is reported as before.
+  if (!reconnect_policy_.enabled || !playing_ || playing_us_.load() == 0 ||
+      delivering_source_error_) {
+    return false;
+  }
+  if (error && !source_error_) source_error_ = gst_message_ref(error);
+  if (!reconnecting_) {
+    reconnecting_ = true;
+    reconnect_attempts_ = 0;
+    reconnect_delay_ms_ = reconnect_policy_.initial_delay_ms;
+    source_lost_us_ = g_get_monotonic_time();
+    g_warning("Capture source %s lost; reconnecting",
+              config_.device_path.c_str());
+    NotifyReconnect("lost", 0);
+  } else if (reconnect_timer_id_ > 0) {
+    // Already waiting for the next attempt (an error and its EOS both
+    // report the same loss).
+    return true;
+  }
+  if (reconnect_check_id_ > 0) {
+    g_source_remove(reconnect_check_id_);
+    reconnect_check_id_ = 0;
+  }
+  StopSource();
+  ScheduleReconnect();
+  return true;
+}
+
+void CaptureSession::StopSource() {
+  if (tee_watch_) tee_watch_->restarting.store(false);
+  // Locked, the source stays down whatever the rest of the pipeline does
+  // until an attempt brings it back.
+  for (GstElement* element : source_elements_) {
+    gst_element_set_locked_state(element, TRUE);
+    gst_element_set_state(element, GST_STATE_NULL);
+  }
+}
+
+bool CaptureSession::StartSource() {
+  if (tee_watch_) tee_watch_->restarting.store(true);
+  // Downstream first, so each element has somewhere to push when its
+  // upstream neighbour starts.
+  for (auto it = source_elements_.rbegin(); it != source_elements_.rend();
+       ++it) {
+    gst_element_set_locked_state(*it, FALSE);
+    if (!gst_element_sync_state_with_parent(*it)) return false;
+  }
+  return true;
+}
+
+void CaptureSession::ScheduleReconnect() {
+  if (!reconnect_policy_.enabled ||
+      (reconnect_policy_.max_attempts > 0 &&
+       reconnect_attempts_ >= reconnect_policy_.max_attempts)) {
+    GiveUpReconnect();
+    return;
+  }
+  reconnect_timer_id_ = g_timeout_add(
+      reconnect_delay_ms_, CaptureSession::OnReconnectTimer, this);
+  reconnect_delay_ms_ =
+      std::min(reconnect_delay_ms_ * 2, reconnect_policy_.max_delay_ms);
+}
+
+gboolean CaptureSession::OnReconnectTimer(gpointer user_data) {
+  auto* self = static_cast<CaptureSession*>(user_data);
+  self->reconnect_timer_id_ = 0;
+  self->TryReconnect();
+  return G_SOURCE_REMOVE;
+}
+
+void CaptureSession::TryReconnect() {
+  reconnect_attempts_++;
+  if (config_.source.empty()) {
+    // The node path may change when the camera comes back; its bus_info
+    // does not.
+    std::string device_path =
+        bus_info_.empty() ? config_.device_path
+                          : DeviceEnumerator::FindDeviceByBusInfo(bus_info_);
+    if (device_path.empty() ||
+        !g_file_test(device_path.c_str(), G_FILE_TEST_EXISTS)) {
+      ScheduleReconnect();
+      return;
+    }
+    GstElement* src = gst_bin_get_by_name(GST_BIN(pipeline_), "src");
+    if (src) {
+      g_object_set(src, "device", device_path.c_str(), nullptr);
+      gst_object_unref(src);
+    }
+  }
+  if (!StartSource()) {
+    StopSource();
+    ScheduleReconnect();
+    return;
+  }
+  reconnect_check_id_ = g_timeout_add(kReconnectFrameTimeoutMs,
+                                      CaptureSession::OnReconnectCheck, this);
+}
+
+gboolean CaptureSession::OnReconnectCheck(gpointer user_data) {
+  auto* self = static_cast<CaptureSession*>(user_data);
+  self->reconnect_check_id_ = 0;
+  // No frame yet: the device opened but is not delivering.
+  self->StopSource();
+  self->ScheduleReconnect();
+  return G_SOURCE_REMOVE;
+}
+
+void CaptureSession::OnSourceRecovered() {
+  if (!reconnecting_) return;
+  if (reconnect_check_id_ > 0) {
+    g_source_remove(reconnect_check_id_);
+    reconnect_check_id_ = 0;
+  }
+  reconnecting_ = false;
+  if (source_error_) {
+    gst_message_unref(source_error_);
+    source_error_ = nullptr;
+  }
+  gint64 downtime_us = g_get_monotonic_time() - source_lost_us_;
+  g_message("Capture source %s recovered after %d attempt(s), %" G_GINT64_FORMAT
+            " ms",
+            config_.device_path.c_str(), reconnect_attempts_,
+            downtime_us / 1000);
+  NotifyReconnect("recovered", downtime_us);
+}
+
+void CaptureSession::GiveUpReconnect() {
+  GstMessage* error = source_error_;
+  source_error_ = nullptr;
+  reconnecting_ = false;
+  NotifyReconnect("failed", g_get_monotonic_time() - source_lost_us_);
+  // Now the cameras hear about the loss the way they would have without a
+  // policy.
+  if (!error) {
+    GError* err =
+        g_error_new_literal(GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_NOT_FOUND,
+                            "Camera disconnected and did not come back");
+    error = gst_message_new_error(GST_OBJECT(pipeline_), err, nullptr);
+    g_error_free(err);
+  }
+  for (GstElement* element : source_elements_) {
+    gst_element_set_locked_state(element, FALSE);
+  }
+  delivering_source_error_ = true;
+  DispatchMessage(error);
+  delivering_source_error_ = false;
+  gst_message_unref(error);
+}
+
+void CaptureSession::CancelReconnect() {
+  if (reconnect_timer_id_ > 0) {
+    g_source_remove(reconnect_timer_id_);
+    reconnect_timer_id_ = 0;
+  }
+  if (reconnect_check_id_ > 0) {
+    g_source_remove(reconnect_check_id_);
+    reconnect_check_id_ = 0;
+  }
+  if (source_error_) {
+    gst_message_unref(source_error_);
+    source_error_ = nullptr;
+  }
+  if (tee_watch_) tee_watch_->restarting.store(false);
+  for (GstElement* element : source_elements_) {
+    gst_element_set_locked_state(element, FALSE);
+  }
+  reconnecting_ = false;
+}
+
+void CaptureSession::NotifyReconnect(const char* state, gint64 downtime_us) {
+  GstStructure* structure = gst_structure_new(
+      kReconnectMessage, "state", G_TYPE_STRING, state, "attempts", G_TYPE_INT,
+      reconnect_attempts_, nullptr);
+  if (downtime_us > 0) {
+    gst_structure_set(structure, "downtime-us", G_TYPE_INT64, downtime_us,
+                      nullptr);
+  }
+  GstMessage* msg =
+      gst_message_new_application(GST_OBJECT(pipeline_), structure);
+  DispatchMessage(msg);
+  gst_message_unref(msg);
+}
+
+bool CaptureSession::SetCaptureFormat(int width, int height, int fps,
+                                      GError** error) {
+  if (width == config_.target_width && height == config_.target_height &&
+      fps == config_.target_fps) {
+    return true;
+  }
+  if (reconnecting_) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_BUSY,
+                "Cannot change the capture format while reconnecting");
+    return false;
+  }
+  CameraConfig previous = config_;
+  config_.target_width = width;
+  config_.target_height = height;
+  config_.target_fps = fps;
+  // Built later from config_.
+  if (!pipeline_) return true;
+
+  GstElement* capsfilter = gst_bin_get_by_name(GST_BIN(pipeline_), "srccaps");
+  if (!capsfilter) {
+    config_ = previous;
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to find source caps in capture session");
+    return false;
+  }
+  auto apply = [this, capsfilter](const CameraConfig& config) {
+    GstCaps* caps = gst_caps_new_simple(
+        "video/x-raw", "format", G_TYPE_STRING, "RGBA", "width", G_TYPE_INT,
+        config.target_width, "height", G_TYPE_INT, config.target_height,
+        "framerate", GST_TYPE_FRACTION, config.target_fps, 1, nullptr);
+    bool running = playing_ && !standby_;
+    // The device only takes another format once it has stopped streaming.
+    if (running) StopSource();
+    g_object_set(capsfilter, "caps", caps, nullptr);
+    gst_caps_unref(caps);
+    return !running || StartSource();
+  };
+  bool ok = apply(config_);
+  if (!ok) {
+    config_ = previous;
+    if (!apply(config_)) {
+      g_warning("Failed to restart capture source %s",
+                config_.device_path.c_str());
+    }
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "%s could not be restarted at %dx%d and %d fps",
+                config_.device_path.c_str(), width, height, fps);
+  }
+  gst_object_unref(capsfilter);
+  return ok;
+}
+
+bool CaptureSession::Prepare(GError** error) {
+  if (playing_ || prepare_cancelled_) return true;
+  if (!pipeline_ && !BuildPipeline(error)) return false;
+
+  prepared_us_ = g_get_monotonic_time();
+  prepare_cancelled_ = std::make_shared<std::atomic<bool>>(false);
+  // Opening a V4L2 device and querying its formats can take a while; keep
+  // it off the main thread.
+  gst_element_call_async(
+      pipeline_, CaptureSession::PrepareAsync,
+      new std::shared_ptr<std::atomic<bool>>(prepare_cancelled_),
+      [](gpointer p) {
+        delete static_cast<std::shared_ptr<std::atomic<bool>>*>(p);
+      });
+  return true;
+}
+
+void CaptureSession::PrepareAsync(GstElement* pipeline, gpointer user_data) {
+  auto* cancelled =
+      static_cast<std::shared_ptr<std::atomic<bool>>*>(user_data)->get();
+  // Holding the state lock orders this against AttachBranch's switch to
+  // PLAYING: either it sees the flag raised and stands down, or the switch
+  // waits for it.
+  GST_STATE_LOCK(pipeline);
+  if (!cancelled->load()) {
+    GstStateChangeReturn ret =
+        gst_element_set_state(pipeline, GST_STATE_PAUSED);
+    if (ret != GST_STATE_CHANGE_NO_PREROLL &&
+        ret != GST_STATE_CHANGE_FAILURE) {
+      gst_element_set_state(pipeline, GST_STATE_READY);
+    }
+  }
+  GST_STATE_UNLOCK(pipeline);
+}
+
+namespace {
+
+// Shared between DetachBranch and the idle probe. The probe may fire after
+// DetachBranch gave up waiting, so the state is reference-counted.
+struct UnlinkState {
+  GMutex mutex;
+  GCond cond;
+  bool done = false;
+  GstPad* branch_pad = nullptr;  // Holds a ref.
+
+  UnlinkState() {
+    g_mutex_init(&mutex);
+    g_cond_init(&cond);
+  }
+  ~UnlinkState() {
+    if (branch_pad) gst_object_unref(branch_pad);
+    g_cond_clear(&cond);
+    g_mutex_clear(&mutex);
+  }
+};
+
+GstPadProbeReturn OnTeePadIdle(GstPad* pad, GstPadProbeInfo* info,
+                               gpointer user_data) {
+  auto* state = static_cast<std::shared_ptr<UnlinkState>*>(user_data)->get();
+  gst_pad_unlink(pad, state->branch_pad);
+  g_mutex_lock(&state->mutex);
+  state->done = true;
+  g_cond_signal(&state->cond);
+  g_mutex_unlock(&state->mutex);
+  return GST_PAD_PROBE_REMOVE;
+}
+
+}  // namespace
+
+void CaptureSession::DetachBranch(GstElement* branch) {
+  auto it = std::find_if(branches_.begin(), branches_.end(),
+                         [branch](const Branch& b) { return b.bin == branch; });
+  if (it == branches_.end()) return;
+
+  GstPad* tee_pad = it->tee_pad;
+  branches_.erase(it);
+
+  if (branches_.empty()) {
+    // Last user: stopping the whole pipeline also stops the branch, so no
+    // idle-probe dance is needed. A reconnect in progress is abandoned; it
+    // unlocks the source so the next start includes it again.
+    CancelReconnect();
+    gst_element_set_state(pipeline_, GST_STATE_NULL);
+    playing_ = false;
+    standby_ = false;
+    prepare_cancelled_.reset();  // May be prepared again.
+  }
+
+  GstPad* branch_pad = gst_element_get_static_pad(branch, "sink");
+  if (branch_pad && gst_pad_is_linked(tee_pad)) {
+    if (!playing_) {
+      gst_pad_unlink(tee_pad, branch_pad);
+    } else {
+      // Other branches keep streaming. Unlink from an idle probe so the tee
+      // is never mid-push into this branch when it goes away.
+      auto* state = new std::shared_ptr<UnlinkState>(
+          std::make_shared<UnlinkState>());
+      (*state)->branch_pad = GST_PAD(gst_object_ref(branch_pad));
+      std::shared_ptr<UnlinkState> local = *state;
+      gst_pad_add_probe(
+          tee_pad, GST_PAD_PROBE_TYPE_IDLE, OnTeePadIdle, state,
+          [](gpointer p) {
+            delete static_cast<std::shared_ptr<UnlinkState>*>(p);
+          });
+
+      gint64 deadline = g_get_monotonic_time() + kDetachIdleTimeoutUs;
+      g_mutex_lock(&local->mutex);
+      while (!local->done) {
+        if (!g_cond_wait_until(&local->cond, &local->mutex, deadline)) {
+          // The branch is blocked downstream (e.g. a stalled encoder). Taking
+          // it to NULL below flushes it, which lets the tee push return and
+          // the probe fire.
+          g_warning("Camera branch did not go idle; forcing detach");
+          break;
+        }
+      }
+      g_mutex_unlock(&local->mutex);
+    }
+  }
+  if (branch_pad) gst_object_unref(branch_pad);
+
+  gst_element_set_state(branch, GST_STATE_NULL);
+  gst_bin_remove(GST_BIN(pipeline_), branch);
+
+  // The branch's threads have left (and been restored) by now. Drop any
+  // stragglers without touching them: their tids may already be reused.
+  g_mutex_lock(&sched_mutex_);
+  schedules_.erase(
+      std::remove_if(schedules_.begin(), schedules_.end(),
+                     [branch](const std::pair<GstElement*,
+                                              CameraThreadSchedule>& e) {
+                       return e.first == branch;
+                     }),
+      schedules_.end());
+  threads_.erase(std::remove_if(threads_.begin(), threads_.end(),
+                                [branch](const ScheduledThread& t) {
+                                  return t.branch == branch;
+                                }),
+                 threads_.end());
+  if (capture_owner_ == branch) {
+    PickCaptureOwnerLocked();
+    for (auto& thread : threads_) {
+      if (thread.role == ThreadRole::kCapture) ApplyLocked(&thread, nullptr);
+    }
+  }
+  g_mutex_unlock(&sched_mutex_);
+
+  gst_element_release_request_pad(tee_, tee_pad);
+  gst_object_unref(tee_pad);
+
+  // The branches left may all be in standby.
+  UpdateStandby();
+}
+
+namespace {
+
+struct MainThreadMessage {
+  std::weak_ptr<CaptureSession> session;
+  GstMessage* msg;  // Holds a ref.
+};
+
+}  // namespace
+
+gboolean CaptureSession::OnBusMessage(GstBus* bus, GstMessage* msg,
+                                      gpointer user_data) {
+  switch (GST_MESSAGE_TYPE(msg)) {
+    case GST_MESSAGE_ERROR:
+    case GST_MESSAGE_EOS:
+      break;
+    default:
+      // State changes, stream status, QoS and the like stop here; nothing on
+      // the main thread consumes them.
+      return TRUE;
+  }
+
+  // Never lock the weak pointer here: the last strong reference must be
+  // dropped on the main thread, where the pipeline is torn down.
+  auto* data = new MainThreadMessage{
+      *static_cast<std::weak_ptr<CaptureSession>*>(user_data),
+      gst_message_ref(msg)};
+  g_idle_add(
+      [](gpointer p) -> gboolean {
+        auto* data = static_cast<MainThreadMessage*>(p);
+        if (auto session = data->session.lock()) {
+          session->DispatchMessage(data->msg);
+        }
+        gst_message_unref(data->msg);
+        delete data;
+        return G_SOURCE_REMOVE;
+      },
+      data);
+  return TRUE;
+}
+
+void CaptureSession::DispatchMessage(GstMessage* msg) {
+  // Copy: a callback may detach its own branch while we iterate.
+  std::vector<Branch> branches = branches_;
+
+  if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+    // Posted by a branch that has since been detached: nobody to tell.
+    if (!pipeline_ || !gst_object_has_as_ancestor(GST_MESSAGE_SRC(msg),
+                                                  GST_OBJECT(pipeline_))) {
+      return;
+    }
+    for (const auto& branch : branches) {
+      if (gst_object_has_as_ancestor(GST_MESSAGE_SRC(msg),
+                                     GST_OBJECT(branch.bin))) {
+        if (branch.callback) branch.callback(msg, branch.user_data);
+        return;
+      }
+    }
+    // From the shared source: held back while a reconnect is tried.
+    if (OnSourceLost(msg)) return;
+  }
+
+  for (const auto& branch : branches) {
+    if (branch.callback) branch.callback(msg, branch.user_data);
+  }
+}
+
+GstBusSyncReply CaptureSession::OnSyncMessage(GstBus* bus, GstMessage* msg,
+                                              gpointer user_data) {
+  // Every camera's streaming threads (source, branch queue, recording queue)
+  // come from the process-wide pool rather than one pool per pipeline.
+  streaming_thread_pool_handle_message(streaming_thread_pool_get_default(),
+                                       msg);
+  auto* self = static_cast<CaptureSession*>(user_data);
+  if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STREAM_STATUS) {
+    self->OnStreamStatus(msg);
+  } else if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STATE_CHANGED &&
+             GST_MESSAGE_SRC(msg) == GST_OBJECT(self->pipeline_)) {
+    GstState new_state;
+    gst_message_parse_state_changed(msg, nullptr, &new_state, nullptr);
+    if (new_state == GST_STATE_PLAYING && self->playing_us_.load() == 0) {
+      self->playing_us_.store(g_get_monotonic_time());
+    }
+  }
+  return GST_BUS_PASS;
+}
+
+std::map<ThreadRole, std::string> CaptureSession::SetBranchSchedule(
+    GstElement* branch, const CameraThreadSchedule& schedule,
+    std::string* error) {
+  std::map<ThreadRole, std::string> applied;
+
+  g_mutex_lock(&sched_mutex_);
+  auto it = std::find_if(
+      schedules_.begin(), schedules_.end(),
+      [branch](const std::pair<GstElement*, CameraThreadSchedule>& e) {
+        return e.first == branch;
+      });
+  if (it == schedules_.end()) {
+    g_mutex_unlock(&sched_mutex_);
+    if (error) *error += "branch is not attached; ";
+    return applied;
+  }
+  it->second = schedule;
+
+  if (!schedule.capture.is_default()) {
+    capture_owner_ = branch;
+  } else if (capture_owner_ == branch) {
+    PickCaptureOwnerLocked();
+  }
+
+  for (auto& thread : threads_) {
+    bool affected = thread.branch == branch ||
+                    (thread.role == ThreadRole::kCapture && !thread.branch);
+    if (!affected) continue;
+    ApplyLocked(&thread, error);
+    applied[thread.role] =
+        thread.applied.empty() ? "default" : thread.applied;
+  }
+  g_mutex_unlock(&sched_mutex_);
+
+  for (ThreadRole role :
+       {ThreadRole::kCapture, ThreadRole::kConvert, ThreadRole::kEncode}) {
+    if (applied.find(role) == applied.end()) applied[role] = "pending";
+  }
+  return applied;
+}
+
+void CaptureSession::OnStreamStatus(GstMessage* msg) {
+  GstStreamStatusType type;
+  GstElement* owner = nullptr;
+  gst_message_parse_stream_status(msg, &type, &owner);
+  if (type != GST_STREAM_STATUS_TYPE_ENTER &&
+      type != GST_STREAM_STATUS_TYPE_LEAVE) {
+    return;
+  }
+
+  // ENTER and LEAVE are posted from the streaming thread itself.
+  pid_t tid = CurrentThreadId();
+
+  g_mutex_lock(&sched_mutex_);
+  if (type == GST_STREAM_STATUS_TYPE_LEAVE) {
+    auto it = std::find_if(
+        threads_.begin(), threads_.end(),
+        [tid](const ScheduledThread& t) { return t.tid == tid; });
+    if (it != threads_.end()) {
+      if (!it->applied.empty()) RestoreThreadSchedule(tid, it->saved);
+      threads_.erase(it);
+    }
+    g_mutex_unlock(&sched_mutex_);
+    return;
+  }
+
+  GstElement* branch = nullptr;
+  for (const auto& entry : schedules_) {
+    if (gst_object_has_as_ancestor(GST_OBJECT(owner),
+                                   GST_OBJECT(entry.first))) {
+      branch = entry.first;
+      break;
+    }
+  }
+  // Inside a branch, the recording elements (RecordHandler's rec_* queues)
+  // run the encoder; every other queue runs the scale/mirror/copy work.
+  ThreadRole role = ThreadRole::kCapture;
+  if (branch) {
+    role = g_str_has_prefix(GST_OBJECT_NAME(owner), "rec_")
+               ? ThreadRole::kEncode
+               : ThreadRole::kConvert;
+  }
+
+  ScheduledThread thread{tid, branch, role, SaveThreadSchedule(tid), ""};
+  ApplyLocked(&thread, nullptr);
+  threads_.push_back(thread);
+  g_mutex_unlock(&sched_mutex_);
+}
+
+const ThreadSchedule& CaptureSession::ScheduleForLocked(
+    GstElement* branch, ThreadRole role) const {
+  static const ThreadSchedule kDefault;
+  GstElement* key = role == ThreadRole::kCapture ? capture_owner_ : branch;
+  for (const auto& entry : schedules_) {
+    if (entry.first == key) return entry.second.ForRole(role);
+  }
+  return kDefault;
+}
+
+void CaptureSession::PickCaptureOwnerLocked() {
+  capture_owner_ = nullptr;
+  // Latest attached camera that asked for one.
+  for (auto it = schedules_.rbegin(); it != schedules_.rend(); ++it) {
+    if (!it->second.capture.is_default()) {
+      capture_owner_ = it->first;
+      return;
+    }
+  }
+}
+
+void CaptureSession::ApplyLocked(ScheduledThread* thread,
+                                 std::string* error) {
+  const ThreadSchedule& schedule =
+      ScheduleForLocked(thread->branch, thread->role);
+  // Start from the thread's original state so switching, say, from FIFO to
+  // nice does not leave the old policy or affinity behind.
+  if (!thread->applied.empty()) {
+    RestoreThreadSchedule(thread->tid, thread->saved);
+    thread->applied.clear();
+  }
+  if (schedule.is_default()) return;
+  thread->applied = ApplyThreadSchedule(thread->tid, schedule, error);
+}
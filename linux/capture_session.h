@@ -0,0 +1,293 @@
+#ifndef CAPTURE_SESSION_H_
+#define CAPTURE_SESSION_H_
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "thread_scheduling.h"
+
+// Highest frame rate a camera may ask for, whether from a device or from a
+// virtual source (see virtual_source.h). A device must also offer the rate.
+constexpr int kMaxCaptureFps = 1000;
+
+struct CameraConfig {
+  std::string device_path;
+  int resolution_preset;
+  bool enable_audio;
+  int target_width;
+  int target_height;
+  int target_fps;
+  int target_bitrate;
+  int audio_bitrate = 0;
+  // GStreamer description of the element(s) producing raw video, used in
+  // place of "v4l2src device=<device_path>" when set. Lets benchmarks run
+  // the real pipeline from videotestsrc or a file.
+  std::string source;
+  // Seek |source| back to the start instead of ending the stream at EOS.
+  // Only the source side is flushed; if |source| paces itself with a
+  // clocksync, the rewound clip is offset there to carry on in real time.
+  bool loop_source = false;
+};
+
+// What a CaptureSession does when its source fails or ends while running.
+// Disabled, the error reaches every camera as before. Enabled, the session
+// restarts only its source elements, looking the device up again by its
+// V4L2 bus_info (a replugged camera may come back under another /dev node),
+// and retries with exponential backoff. The camera branches stay attached
+// throughout, so textures, image streams and recordings carry on once
+// frames return.
+struct ReconnectPolicy {
+  bool enabled = false;
+  int initial_delay_ms = 100;  // Before the first attempt; doubles after each.
+  int max_delay_ms = 5000;
+  int max_attempts = 10;  // 0 retries until the last camera goes away.
+};
+
+// Owns the capture pipeline for a single device. A V4L2 node can only be
+// streamed by one pipeline at a time, so every Camera opened on the same
+// device shares one CaptureSession and attaches its own branch to the tee:
+//
+//   v4l2src ! videoconvert ! caps ! tee name=t
+//     t. ! [camera 1 branch: scale, mirror, preview, recording]
+//     t. ! [camera 2 branch: ...]
+//
+// The session is reference-counted through std::shared_ptr by the cameras
+// using it and must always be owned by one. The pipeline runs while at least
+// one branch is attached and is stopped when the last branch is detached.
+//
+// The bus is watched from the shared ControlThread, not the GTK main loop.
+// Only messages a branch needs to act on (errors, EOS) are marshalled to the
+// main thread, where the branch callbacks run. While a reconnect policy is
+// enabled, source failures are replaced by "capture-session-reconnect"
+// application messages (see kReconnectMessage), and the original error is
+// delivered only if recovery gives up.
+//
+// All methods must be called from the main thread.
+class CaptureSession : public std::enable_shared_from_this<CaptureSession> {
+ public:
+  // Name of the application-message structure announcing reconnects. Fields:
+  // "state" ("lost", "recovered" or "failed"), "attempts" (int) and, once
+  // recovered or failed, "downtime-us" (int64).
+  static const char kReconnectMessage[];
+
+  // Receives bus messages for an attached branch, on the main thread. Only
+  // errors, EOS and reconnect notifications are forwarded. Errors raised by
+  // elements inside a branch are delivered only to that branch; errors from
+  // the shared source and EOS are delivered to every branch.
+  using MessageCallback = void (*)(GstMessage* message, gpointer user_data);
+
+  // |config| determines the source caps (resolution and frame rate). Cameras
+  // attaching later with a smaller size scale inside their own branch; a
+  // larger one first grows the source with SetCaptureFormat.
+  explicit CaptureSession(const CameraConfig& config);
+  ~CaptureSession();
+
+  CaptureSession(const CaptureSession&) = delete;
+  CaptureSession& operator=(const CaptureSession&) = delete;
+
+  const CameraConfig& config() const { return config_; }
+  const std::string& device_path() const { return config_.device_path; }
+  size_t branch_count() const { return branches_.size(); }
+  // The shared pipeline, or nullptr before the first branch is attached.
+  GstElement* pipeline() const { return pipeline_; }
+  bool playing() const { return playing_; }
+
+  // When the pipeline was last parsed, prepared and started
+  // (g_get_monotonic_time, 0 until reached), for the cold-start breakdown in
+  // initialize.
+  struct StartupTimes {
+    gint64 parse_start_us;
+    gint64 parsed_us;
+    gint64 prepared_us;  // Prepare() called.
+    gint64 play_requested_us;
+    gint64 playing_us;  // The pipeline's own state change to PLAYING.
+  };
+  StartupTimes startup_times() const {
+    return {parse_start_us_, parsed_us_, prepared_us_, play_requested_us_,
+            playing_us_.load()};
+  }
+
+  // Builds the pipeline and opens the device ahead of the first branch, so
+  // AttachBranch only has to switch to PLAYING. The state change runs off
+  // the main thread: a live source goes to PAUSED, where it negotiates caps
+  // and allocates its buffers and then waits for PLAYING; anything else
+  // stays in READY, since with no branch attached it would just run and
+  // discard frames. Failures to open the device surface when a branch
+  // attaches. Does nothing once the pipeline is running or prepared.
+  // Returns false and sets |error| if the pipeline cannot be built.
+  bool Prepare(GError** error);
+
+  // Changes the source caps to |width|x|height| at |fps|. A running source
+  // is restarted in the new format, as on a reconnect, so its branches see
+  // only a caps change and keep scaling to their own sizes; otherwise the
+  // caps apply when it next starts. Fails (keeping the old format) while
+  // the source reconnects or if it does not start in the new format.
+  // Main thread only.
+  bool SetCaptureFormat(int width, int height, int fps, GError** error);
+
+  // Adds |branch| to the pipeline and links its "sink" ghost pad to the tee.
+  // Starts the pipeline if this is the first branch. The pipeline takes its
+  // own reference on |branch|; the caller keeps theirs.
+  // Returns true on success; sets |error| on failure.
+  bool AttachBranch(GstElement* branch, MessageCallback callback,
+                    gpointer user_data, GError** error);
+
+  // Puts |branch| in or out of standby. While every attached branch is in
+  // standby the pipeline waits in READY: the source stops streaming and
+  // frees its buffers (and the USB bandwidth they reserve), but the
+  // elements, the open device and the negotiated caps stay, so leaving
+  // standby is a single state change back to PLAYING. A branch in standby
+  // on a session that other branches keep running still receives frames.
+  // Returns false and sets |error| if the pipeline fails to restart.
+  bool SetBranchStandby(GstElement* branch, bool standby, GError** error);
+  // True while the pipeline waits in READY for a branch to leave standby.
+  bool standby() const { return standby_; }
+
+  // Unlinks |branch| from the tee, stops it and removes it from the pipeline.
+  // When this was the last branch, the whole pipeline is stopped first.
+  // After this returns, no streaming thread touches |branch| any more.
+  void DetachBranch(GstElement* branch);
+
+  // Sets how the session reacts to its source failing. The policy is shared
+  // by every camera on the device; the most recent call wins. Disabling it
+  // during a reconnect lets the pending attempt run, then gives up.
+  void SetReconnectPolicy(const ReconnectPolicy& policy);
+  // True between losing the source and recovering or giving up.
+  bool reconnecting() const { return reconnecting_; }
+
+  // Sets the scheduling of |branch|'s streaming threads. The capture role
+  // applies to the shared source thread; when several cameras on the device
+  // set one, the most recent non-default capture schedule wins.
+  //
+  // Threads are tracked through their stream-status ENTER/LEAVE messages:
+  // running threads are updated immediately, threads started later pick
+  // the schedule up on ENTER, and each thread's original scheduling is
+  // restored when its task leaves it. Returns what took effect per role;
+  // roles with no running thread report "pending". Failures are appended
+  // to |error|.
+  std::map<ThreadRole, std::string> SetBranchSchedule(
+      GstElement* branch, const CameraThreadSchedule& schedule,
+      std::string* error);
+
+ private:
+  struct Branch {
+    GstElement* bin;  // Not owned (the attaching camera holds a ref).
+    GstPad* tee_pad;  // Request pad on tee_, released on detach.
+    MessageCallback callback;
+    gpointer user_data;
+    bool standby;
+  };
+
+  // A streaming thread seen through a stream-status ENTER message.
+  struct ScheduledThread {
+    pid_t tid;
+    GstElement* branch;  // nullptr for the shared source thread.
+    ThreadRole role;
+    SavedThreadSchedule saved;
+    std::string applied;  // Empty while the thread is untouched.
+  };
+
+  bool BuildPipeline(GError** error);
+  // Parks the pipeline in READY once every branch is in standby.
+  void UpdateStandby();
+
+  // Called from streaming threads via OnSyncMessage.
+  void OnStreamStatus(GstMessage* msg);
+
+  // The following require sched_mutex_.
+  const ThreadSchedule& ScheduleForLocked(GstElement* branch,
+                                          ThreadRole role) const;
+  void PickCaptureOwnerLocked();
+  void ApplyLocked(ScheduledThread* thread, std::string* error);
+
+  // Runs on the control thread; user_data is a std::weak_ptr to the session
+  // so a message racing with the session's destruction is dropped.
+  static gboolean OnBusMessage(GstBus* bus, GstMessage* msg,
+                               gpointer user_data);
+  // Delivers |msg| to the attached branches. Main thread only.
+  void DispatchMessage(GstMessage* msg);
+  // Runs on the thread posting the message, before OnBusMessage.
+  static GstBusSyncReply OnSyncMessage(GstBus* bus, GstMessage* msg,
+                                       gpointer user_data);
+  // Watches what enters the tee, on the source's streaming thread; user_data
+  // is the TeeWatch. Looping sources: swallows EOS, has the main thread
+  // rewind the source, and swallows the rewind's flush. With a reconnect policy: swallows EOS (so branches
+  // and recordings never see it) and the restarted source's stream-start
+  // and segment, and reports the first frame after a restart.
+  static GstPadProbeReturn OnTeeProbe(GstPad* pad, GstPadProbeInfo* info,
+                                      gpointer user_data);
+  // Seeks the source elements back to the start. Main thread only.
+  void Rewind();
+
+  // Reconnect state machine, main thread only. OnSourceLost returns false
+  // when the policy does not apply and |error| should be dispatched as is.
+  bool OnSourceLost(GstMessage* error);
+  void StopSource();
+  bool StartSource();
+  void ScheduleReconnect();
+  void TryReconnect();
+  void OnSourceRecovered();
+  void GiveUpReconnect();
+  void CancelReconnect();
+  void NotifyReconnect(const char* state, gint64 downtime_us);
+  static gboolean OnReconnectTimer(gpointer user_data);
+  static gboolean OnReconnectCheck(gpointer user_data);
+  // Runs Prepare's state change via gst_element_call_async; user_data is
+  // the prepare_cancelled_ flag.
+  static void PrepareAsync(GstElement* pipeline, gpointer user_data);
+
+  CameraConfig config_;
+
+  GstElement* pipeline_;
+  GstElement* tee_;  // Owned by pipeline.
+  GSource* bus_watch_;  // Attached to ControlThread::Context().
+  bool playing_;
+  bool standby_ = false;  // Parked in READY while playing_; see standby().
+
+  // See startup_times(). playing_us_ is written from the sync handler.
+  gint64 parse_start_us_ = 0;
+  gint64 parsed_us_ = 0;
+  gint64 prepared_us_ = 0;
+  gint64 play_requested_us_ = 0;
+  std::atomic<gint64> playing_us_{0};
+
+  // What OnTeeProbe reads on the streaming thread. Shared with the probe so
+  // it never has to lock the session there (see OnBusMessage).
+  struct TeeWatch;
+  std::shared_ptr<TeeWatch> tee_watch_;
+
+  // The elements ahead of the tee, restarted on reconnect (refs held).
+  std::vector<GstElement*> source_elements_;
+  std::string bus_info_;  // Of config_.device_path, for finding it again.
+  ReconnectPolicy reconnect_policy_;
+  bool reconnecting_ = false;
+  int reconnect_attempts_ = 0;
+  int reconnect_delay_ms_ = 0;
+  gint64 source_lost_us_ = 0;
+  GstMessage* source_error_ = nullptr;  // Delivered if recovery gives up.
+  guint reconnect_timer_id_ = 0;  // Waiting to attempt.
+  guint reconnect_check_id_ = 0;  // Attempt made, waiting for a frame.
+  bool delivering_source_error_ = false;  // GiveUpReconnect is dispatching.
+
+  // Set by Prepare. Raised once a branch starts the pipeline or the session
+  // goes away, so a prepare state change still queued stands down; shared
+  // with it because it may run after the session is destroyed.
+  std::shared_ptr<std::atomic<bool>> prepare_cancelled_;
+
+  std::vector<Branch> branches_;
+
+  // Thread scheduling state. Read and written from streaming threads, so it
+  // is guarded by sched_mutex_ instead of relying on the main thread.
+  GMutex sched_mutex_;
+  std::vector<std::pair<GstElement*, CameraThreadSchedule>> schedules_;
+  GstElement* capture_owner_;  // Branch whose capture schedule is in use.
+  std::vector<ScheduledThread> threads_;
+};
+
+#endif  // CAPTURE_SESSION_H_
@@ -0,0 +1,26 @@
+#include "control_thread.h"
+
+namespace {
+
+gpointer ControlThreadMain(gpointer data) {
+  GMainContext* context = static_cast<GMainContext*>(data);
+  g_main_context_push_thread_default(context);
+  GMainLoop* loop = g_main_loop_new(context, FALSE);
+  g_main_loop_run(loop);  // Runs until process exit.
+  g_main_loop_unref(loop);
+  g_main_context_pop_thread_default(context);
+  return nullptr;
+}
+
+}  // namespace
+
+GMainContext* ControlThread::Context() {
+  static GMainContext* context = nullptr;
+  if (g_once_init_enter(&context)) {
+    GMainContext* c = g_main_context_new();
+    // The thread is never joined; it parks in poll() when there is no work.
+    g_thread_unref(g_thread_new("camera-control", ControlThreadMain, c));
+    g_once_init_leave(&context, c);
+  }
+  return context;
+}
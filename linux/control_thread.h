@@ -0,0 +1,20 @@
+#ifndef CONTROL_THREAD_H_
+#define CONTROL_THREAD_H_
+
+#include <glib.h>
+
+// A single long-lived thread shared by every camera that runs its own
+// GMainContext for pipeline control work (bus watches). Keeping it off the
+// GTK main loop means errors, EOS and state changes are seen promptly even
+// when the UI thread is busy rendering.
+//
+// Anything that reaches Flutter (method-call responses, channel events,
+// texture registration) must still be marshalled back to the main loop.
+class ControlThread {
+ public:
+  // Returns the control thread's main context, starting the thread on first
+  // use. The context lives for the rest of the process; do not unref it.
+  static GMainContext* Context();
+};
+
+#endif  // CONTROL_THREAD_H_
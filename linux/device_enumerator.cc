@@ -130,6 +130,30 @@ std::vector<DeviceInfo> DeviceEnumerator::EnumerateDevices() {
   return devices;
 }
 
+std::string DeviceEnumerator::QueryBusInfo(const std::string& device_path) {
+  int fd = open(device_path.c_str(), O_RDONLY | O_NONBLOCK);
+  if (fd < 0) return "";
+  struct v4l2_capability cap;
+  memset(&cap, 0, sizeof(cap));
+  std::string bus;
+  if (ioctl(fd, VIDIOC_QUERYCAP, &cap) == 0) {
+    bus = reinterpret_cast<const char*>(cap.bus_info);
+  }
+  close(fd);
+  return bus;
+}
+
+std::string DeviceEnumerator::FindDeviceByBusInfo(
+    const std::string& bus_info) {
+  if (bus_info.empty()) return "";
+  // EnumerateDevices keeps the first capture node per bus_info, the same
+  // one a camera is normally opened on.
+  for (const auto& device : EnumerateDevices()) {
+    if (device.bus_info == bus_info) return device.device_path;
+  }
+  return "";
+}
+
 std::vector<ResolutionInfo> DeviceEnumerator::EnumerateResolutions(
     const std::string& device_path) {
   std::vector<ResolutionInfo> resolutions;
@@ -220,3 +244,53 @@ ResolutionInfo DeviceEnumerator::SelectResolution(
   // No resolutions found — return a default and let GStreamer negotiate.
   return {640, 480, 30};
 }
+
+bool DeviceEnumerator::SelectResolutionForFps(
+    const std::vector<ResolutionInfo>& resolutions, int preset, int fps,
+    ResolutionInfo* selected) {
+  int max_height = MaxHeightForPreset(preset);
+  const ResolutionInfo* above_ceiling = nullptr;
+  // Resolutions are sorted descending, so the first match is the largest.
+  for (const auto& r : resolutions) {
+    if (r.max_fps < fps) continue;
+    if (r.height <= max_height) {
+      *selected = r;
+      return true;
+    }
+    // Keep the smallest above the ceiling: closest to what was asked for.
+    above_ceiling = &r;
+  }
+  if (!above_ceiling) return false;
+  *selected = *above_ceiling;
+  return true;
+}
+
+// Whether |a| is at least as large and as fast as |b|.
+static bool Covers(const ResolutionInfo& a, const ResolutionInfo& b) {
+  return a.width >= b.width && a.height >= b.height && a.max_fps >= b.max_fps;
+}
+
+bool DeviceEnumerator::SelectSharedFormat(
+    const std::vector<ResolutionInfo>& resolutions,
+    const ResolutionInfo& current, const ResolutionInfo& requested,
+    ResolutionInfo* selected) {
+  if (Covers(current, requested)) {
+    *selected = current;
+    return true;
+  }
+  if (Covers(requested, current)) {
+    *selected = requested;
+    return true;
+  }
+  ResolutionInfo needed = {std::max(current.width, requested.width),
+                           std::max(current.height, requested.height),
+                           std::max(current.max_fps, requested.max_fps)};
+  // Resolutions are sorted descending, so the last match is the smallest.
+  const ResolutionInfo* smallest = nullptr;
+  for (const auto& r : resolutions) {
+    if (Covers(r, needed)) smallest = &r;
+  }
+  if (!smallest) return false;
+  *selected = {smallest->width, smallest->height, needed.max_fps};
+  return true;
+}
@@ -34,6 +34,15 @@ class DeviceEnumerator {
   // bus_info so each physical camera appears only once.
   static std::vector<DeviceInfo> EnumerateDevices();
 
+  // V4L2 bus_info of |device_path| (e.g. "usb-0000:00:14.0-4"), or an
+  // empty string if the node cannot be queried. Stable across unplug and
+  // replug into the same port, unlike the node path.
+  static std::string QueryBusInfo(const std::string& device_path);
+
+  // Capture node currently exposing |bus_info|, or an empty string if no
+  // such device is connected.
+  static std::string FindDeviceByBusInfo(const std::string& bus_info);
+
   // Enumerates supported resolutions and frame rates for a device.
   // Handles discrete, stepwise, and continuous frame size types.
   static std::vector<ResolutionInfo> EnumerateResolutions(
@@ -45,6 +54,26 @@ class DeviceEnumerator {
   static ResolutionInfo SelectResolution(
       const std::vector<ResolutionInfo>& resolutions,
       int preset);
+
+  // Picks the highest resolution within the preset ceiling that supports
+  // |fps|, for rates above the usual webcam modes; many cameras reach 120
+  // or 240 fps only at reduced sizes. Falls back to the smallest supporting
+  // resolution above the ceiling, the closest to the preset. Returns false
+  // if no resolution supports |fps|.
+  static bool SelectResolutionForFps(
+      const std::vector<ResolutionInfo>& resolutions, int preset, int fps,
+      ResolutionInfo* selected);
+
+  // Format for a device shared by cameras asking for |current| (what it is
+  // open at) and |requested|, with max_fps as each one's rate: the smallest
+  // of |resolutions| at least as large as either, at the faster rate, so
+  // every camera only ever scales down. |current| itself when it already
+  // covers |requested|, and |requested| when that covers |current| (it was
+  // picked from the device's modes). Returns false if no mode covers both.
+  static bool SelectSharedFormat(
+      const std::vector<ResolutionInfo>& resolutions,
+      const ResolutionInfo& current, const ResolutionInfo& requested,
+      ResolutionInfo* selected);
 };
 
 #endif  // DEVICE_ENUMERATOR_H_
@@ -0,0 +1,133 @@
+#include "frame_allocator.h"
+
+#include <sys/mman.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const size_t kPageSize = 4096;
+
+size_t RoundUp(size_t size, size_t multiple) {
+  return (size + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+FrameAllocator::~FrameAllocator() {
+  // Buffers still handed out hold a reference to the allocator, so by now
+  // every buffer is back in free_.
+  Trim();
+}
+
+size_t FrameAllocator::Capacity(size_t size) {
+  // Mapped buffers are whole pages anyway; the tail past the last huge page
+  // is backed by ordinary pages.
+  return size >= kHugePageThreshold ? RoundUp(size, kPageSize)
+                                    : RoundUp(size, kAlignment);
+}
+
+void* FrameAllocator::SystemAllocate(size_t capacity) {
+  if (capacity < kHugePageThreshold) {
+    void* data = nullptr;
+    return posix_memalign(&data, kAlignment, capacity) == 0 ? data : nullptr;
+  }
+
+  // Over-map by a huge page and cut the ends off, so the buffer starts on a
+  // huge page boundary and the kernel can back it with huge pages.
+  size_t mapped = capacity + kHugePageSize;
+  void* region = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED) return nullptr;
+  uintptr_t start = reinterpret_cast<uintptr_t>(region);
+  uintptr_t aligned = RoundUp(start, kHugePageSize);
+  if (aligned > start) munmap(region, aligned - start);
+  size_t tail = start + mapped - (aligned + capacity);
+  if (tail > 0) munmap(reinterpret_cast<void*>(aligned + capacity), tail);
+  void* data = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+  // Advisory: without transparent huge pages this simply has no effect.
+  madvise(data, capacity, MADV_HUGEPAGE);
+#endif
+  return data;
+}
+
+void FrameAllocator::SystemFree(void* data, size_t capacity) {
+  if (capacity < kHugePageThreshold) {
+    free(data);
+  } else {
+    munmap(data, capacity);
+  }
+}
+
+uint8_t* FrameAllocator::Allocate(size_t size) {
+  size_t capacity = Capacity(size);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    // Most recent first: it is the likeliest to still be in cache.
+    for (size_t i = free_.size(); i-- > 0;) {
+      if (free_[i].capacity == capacity) {
+        void* data = free_[i].data;
+        free_.erase(free_.begin() + i);
+        usage_.in_use_bytes += capacity;
+        usage_.reuses++;
+        return static_cast<uint8_t*>(data);
+      }
+    }
+  }
+
+  void* data = SystemAllocate(capacity);
+  if (!data) {
+    fprintf(stderr, "camera_desktop: failed to allocate %zu frame bytes\n",
+            capacity);
+    abort();
+  }
+  std::lock_guard<std::mutex> lk(mutex_);
+  usage_.resident_bytes += capacity;
+  usage_.in_use_bytes += capacity;
+  if (capacity >= kHugePageThreshold) usage_.huge_page_bytes += capacity;
+  usage_.allocations++;
+  return static_cast<uint8_t*>(data);
+}
+
+void FrameAllocator::Release(void* data, size_t size) {
+  if (!data) return;
+  size_t capacity = Capacity(size);
+  Block evicted = {nullptr, 0};
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    usage_.in_use_bytes -= capacity;
+    free_.push_back({data, capacity});
+    if (free_.size() > kMaxFreeBuffers) {
+      evicted = free_.front();
+      free_.erase(free_.begin());
+      usage_.resident_bytes -= evicted.capacity;
+      if (evicted.capacity >= kHugePageThreshold) {
+        usage_.huge_page_bytes -= evicted.capacity;
+      }
+    }
+  }
+  // Unmapping a large buffer is not free; keep it out of the lock.
+  if (evicted.data) SystemFree(evicted.data, evicted.capacity);
+}
+
+void FrameAllocator::Trim() {
+  std::vector<Block> blocks;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    blocks.swap(free_);
+    for (const Block& block : blocks) {
+      usage_.resident_bytes -= block.capacity;
+      if (block.capacity >= kHugePageThreshold) {
+        usage_.huge_page_bytes -= block.capacity;
+      }
+    }
+  }
+  for (const Block& block : blocks) SystemFree(block.data, block.capacity);
+}
+
+FrameAllocator::Usage FrameAllocator::usage() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return usage_;
+}
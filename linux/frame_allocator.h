@@ -0,0 +1,72 @@
+#ifndef FRAME_ALLOCATOR_H_
+#define FRAME_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Source of every frame-sized buffer a camera uses: the texture's three
+// frames, the FFI image stream buffer, and the repack and legacy-stream
+// temporaries.
+//
+// Buffers are 64-byte aligned, so the copies into them start on a cache
+// line and SIMD stores never split one. Buffers of kHugePageThreshold bytes
+// or more are mapped directly, aligned to a huge page and advised with
+// MADV_HUGEPAGE: a 4K frame then spans 16 TLB entries instead of 8100.
+// Released buffers are kept for reuse, so a frame that needs a temporary, or
+// a texture that is recreated at the same size, does not go back to the
+// system; only the kMaxFreeBuffers most recent are kept.
+//
+// One allocator per camera, shared (std::shared_ptr) by the camera, its
+// texture, and in-flight legacy stream frames, any of which may go last.
+// Thread-safe: buffers are taken on the streaming thread and may be released
+// on the main thread.
+class FrameAllocator {
+ public:
+  static constexpr size_t kAlignment = 64;
+  static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+  static constexpr size_t kHugePageThreshold = kHugePageSize;
+  static constexpr size_t kMaxFreeBuffers = 4;
+
+  struct Usage {
+    size_t resident_bytes = 0;   // Held from the system, in use or free.
+    size_t in_use_bytes = 0;     // Handed out and not yet released.
+    size_t huge_page_bytes = 0;  // Of resident_bytes, huge-page mapped.
+    uint64_t allocations = 0;    // Buffers taken from the system.
+    uint64_t reuses = 0;         // Requests served from released buffers.
+  };
+
+  FrameAllocator() = default;
+  ~FrameAllocator();
+
+  FrameAllocator(const FrameAllocator&) = delete;
+  FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+  // Returns a buffer of at least |size| bytes. The contents are undefined.
+  // Like g_malloc, aborts if the system is out of memory.
+  uint8_t* Allocate(size_t size);
+  // Gives back a buffer from Allocate; |size| is the size it was asked for.
+  void Release(void* data, size_t size);
+  // Returns the kept buffers to the system.
+  void Trim();
+
+  Usage usage() const;
+
+ private:
+  struct Block {
+    void* data;
+    size_t capacity;
+  };
+
+  // Bytes actually reserved for a request of |size|.
+  static size_t Capacity(size_t size);
+  static void* SystemAllocate(size_t capacity);
+  static void SystemFree(void* data, size_t capacity);
+
+  mutable std::mutex mutex_;
+  std::vector<Block> free_;  // Oldest first.
+  Usage usage_;
+};
+
+#endif  // FRAME_ALLOCATOR_H_
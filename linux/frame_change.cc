@@ -0,0 +1,77 @@
+#include "frame_change.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+uint64_t SumAbsDiff(const uint8_t* a, const uint8_t* b, size_t size) {
+#if defined(__SSE2__)
+  // psadbw sums 8 byte differences into each 64-bit half.
+  __m128i sum = _mm_setzero_si128();
+  for (size_t i = 0; i < size; i += 16) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+  }
+  return static_cast<uint64_t>(_mm_cvtsi128_si64(sum)) +
+         static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum)));
+#elif defined(__ARM_NEON)
+  uint32x4_t sum = vdupq_n_u32(0);
+  for (size_t i = 0; i < size; i += 16) {
+    uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+    sum = vpadalq_u16(sum, vpaddlq_u8(diff));
+  }
+  return vgetq_lane_u32(sum, 0) + vgetq_lane_u32(sum, 1) +
+         vgetq_lane_u32(sum, 2) + vgetq_lane_u32(sum, 3);
+#else
+  uint64_t sum = 0;
+  for (size_t i = 0; i < size; i++) {
+    sum += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+  }
+  return sum;
+#endif
+}
+
+int FrameChangeDetector::Difference(const uint8_t* data, int width,
+                                    int height, size_t stride) {
+  sampled_ = false;
+  if (width < kSampleBytes / 4 || height < 1) return kMaxDifference;
+
+  // Four pixels around the centre of each grid cell.
+  uint8_t* latest = samples_[reference_ ^ 1];
+  for (int row = 0; row < kGridRows; row++) {
+    int y = (2 * row + 1) * height / (2 * kGridRows);
+    const uint8_t* line = data + y * stride;
+    for (int column = 0; column < kGridColumns; column++) {
+      int x = (2 * column + 1) * width / (2 * kGridColumns) - 2;
+      if (x < 0) x = 0;
+      if (x > width - 4) x = width - 4;
+      memcpy(latest, line + x * 4, kSampleBytes);
+      latest += kSampleBytes;
+    }
+  }
+  sampled_ = true;
+  sampled_width_ = width;
+  sampled_height_ = height;
+
+  if (!has_reference_ || width != width_ || height != height_) {
+    return kMaxDifference;
+  }
+  // Alpha is constant in camera frames; average over the colour channels.
+  uint64_t total =
+      SumAbsDiff(samples_[reference_ ^ 1], samples_[reference_], kSamplesSize);
+  return static_cast<int>(total / (kSamplesSize / 4 * 3));
+}
+
+void FrameChangeDetector::Commit() {
+  if (!sampled_) return;
+  reference_ ^= 1;
+  width_ = sampled_width_;
+  height_ = sampled_height_;
+  has_reference_ = true;
+  sampled_ = false;
+}
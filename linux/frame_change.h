@@ -0,0 +1,62 @@
+#ifndef FRAME_CHANGE_H_
+#define FRAME_CHANGE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Cheap scene-change metric for RGBA frames.
+//
+// Copies a fixed sparse grid of samples, four adjacent pixels each, out of
+// the frame (independent of the frame size, so the cost is the same at
+// 320x240 and 4K) and compares them with the samples of a reference frame
+// using a SIMD sum of absolute differences (SSE2 on x86-64, NEON on ARM).
+// Runs on a streaming thread for every frame; one detector per stream, not
+// shared between threads.
+class FrameChangeDetector {
+ public:
+  static constexpr int kGridColumns = 32;
+  static constexpr int kGridRows = 18;
+  static constexpr int kSampleBytes = 16;  // Four RGBA pixels.
+  static constexpr size_t kSamplesSize =
+      kGridColumns * kGridRows * kSampleBytes;
+  // Returned without a reference frame, or when the size changed.
+  static constexpr int kMaxDifference = 255;
+
+  FrameChangeDetector() = default;
+
+  // Samples |data| (|height| rows of |width| RGBA pixels, |stride| bytes
+  // apart) and returns the mean absolute difference per colour channel
+  // (0-255) from the reference frame.
+  int Difference(const uint8_t* data, int width, int height, size_t stride);
+
+  // Makes the frame last passed to Difference the reference. Comparing
+  // against the last frame that was acted on, rather than the one before,
+  // keeps a slow drift from going unnoticed one small step at a time.
+  void Commit();
+
+  // Difference followed by Commit: compares consecutive frames.
+  int Update(const uint8_t* data, int width, int height, size_t stride) {
+    int difference = Difference(data, width, height, stride);
+    Commit();
+    return difference;
+  }
+
+  // Forgets the reference, so the next Difference reports a change.
+  void Reset() { has_reference_ = false; }
+
+ private:
+  uint8_t samples_[2][kSamplesSize];
+  int reference_ = 0;  // Index into samples_; the other holds the latest.
+  bool has_reference_ = false;
+  bool sampled_ = false;  // Difference filled the latest samples.
+  int width_ = 0;  // Of the reference.
+  int height_ = 0;
+  int sampled_width_ = 0;
+  int sampled_height_ = 0;
+};
+
+// Sum of |a[i] - b[i]| over |size| bytes; |size| must be a multiple of 16.
+// Exposed for the hot-path benchmark.
+uint64_t SumAbsDiff(const uint8_t* a, const uint8_t* b, size_t size);
+
+#endif  // FRAME_CHANGE_H_
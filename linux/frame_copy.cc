@@ -0,0 +1,195 @@
+#include "frame_copy.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FRAME_COPY_X86 1
+#endif
+
+namespace {
+
+using StreamFn = void (*)(uint8_t* dst, const uint8_t* src, size_t size);
+
+#ifdef FRAME_COPY_X86
+// Both kernels: plain stores up to the first aligned destination address,
+// unaligned loads with aligned streaming stores for the bulk, plain stores
+// for the tail. No fence here; the caller issues one sfence per frame.
+
+__attribute__((target("sse2"))) void StreamSse2(uint8_t* dst,
+                                                const uint8_t* src,
+                                                size_t size) {
+  size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+  if (head > size) head = size;
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+  for (; size >= 64; size -= 64, dst += 64, src += 64) {
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    __m128i a = _mm_loadu_si128(s);
+    __m128i b = _mm_loadu_si128(s + 1);
+    __m128i c = _mm_loadu_si128(s + 2);
+    __m128i d = _mm_loadu_si128(s + 3);
+    __m128i* t = reinterpret_cast<__m128i*>(dst);
+    _mm_stream_si128(t, a);
+    _mm_stream_si128(t + 1, b);
+    _mm_stream_si128(t + 2, c);
+    _mm_stream_si128(t + 3, d);
+  }
+  for (; size >= 16; size -= 16, dst += 16, src += 16) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+  }
+  memcpy(dst, src, size);
+}
+
+__attribute__((target("avx2"))) void StreamAvx2(uint8_t* dst,
+                                                const uint8_t* src,
+                                                size_t size) {
+  size_t head = (32 - (reinterpret_cast<uintptr_t>(dst) & 31)) & 31;
+  if (head > size) head = size;
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+  for (; size >= 128; size -= 128, dst += 128, src += 128) {
+    const __m256i* s = reinterpret_cast<const __m256i*>(src);
+    __m256i a = _mm256_loadu_si256(s);
+    __m256i b = _mm256_loadu_si256(s + 1);
+    __m256i c = _mm256_loadu_si256(s + 2);
+    __m256i d = _mm256_loadu_si256(s + 3);
+    __m256i* t = reinterpret_cast<__m256i*>(dst);
+    _mm256_stream_si256(t, a);
+    _mm256_stream_si256(t + 1, b);
+    _mm256_stream_si256(t + 2, c);
+    _mm256_stream_si256(t + 3, d);
+  }
+  for (; size >= 32; size -= 32, dst += 32, src += 32) {
+    _mm256_stream_si256(
+        reinterpret_cast<__m256i*>(dst),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+  }
+  memcpy(dst, src, size);
+}
+#endif
+
+struct StreamKernel {
+  StreamFn fn;
+  const char* name;
+};
+
+StreamKernel DetectStreamKernel() {
+#ifdef FRAME_COPY_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return {StreamAvx2, "avx2"};
+  if (__builtin_cpu_supports("sse2")) return {StreamSse2, "sse2"};
+#endif
+  return {nullptr, "none"};
+}
+
+const StreamKernel& GetStreamKernel() {
+  static const StreamKernel kernel = DetectStreamKernel();
+  return kernel;
+}
+
+std::atomic<size_t> g_streaming_threshold{kStreamingCopyThreshold};
+
+// The kernel to use for a copy of |size| bytes, or null for memcpy.
+StreamFn StreamFor(size_t size) {
+  if (size < g_streaming_threshold.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return GetStreamKernel().fn;
+}
+
+// Streaming stores are weakly ordered. Drain them before anything that
+// publishes the frame: on x86 neither a release fence nor a mutex unlock
+// orders them on its own.
+#ifdef FRAME_COPY_X86
+__attribute__((target("sse2"))) void StreamFence() {
+  _mm_sfence();
+}
+#else
+void StreamFence() {}
+#endif
+
+}  // namespace
+
+void SetStreamingCopyThreshold(size_t bytes) {
+  g_streaming_threshold.store(bytes);
+}
+
+const char* StreamingCopyKernel() {
+  return GetStreamKernel().name;
+}
+
+void CopyFrame(uint8_t* dst, const uint8_t* src, size_t size) {
+  StreamFn stream = StreamFor(size);
+  if (!stream) {
+    memcpy(dst, src, size);
+    return;
+  }
+  stream(dst, src, size);
+  StreamFence();
+}
+
+void CopyFrameRows(uint8_t* dst, const uint8_t* src, size_t row_bytes,
+                   int height, size_t src_stride) {
+  if (src_stride == row_bytes) {
+    // No padding — direct copy.
+    CopyFrame(dst, src, row_bytes * height);
+    return;
+  }
+  StreamFn stream = StreamFor(row_bytes * height);
+  if (!stream) {
+    for (int row = 0; row < height; row++) {
+      memcpy(dst + row * row_bytes, src + row * src_stride, row_bytes);
+    }
+    return;
+  }
+  for (int row = 0; row < height; row++) {
+    stream(dst + row * row_bytes, src + row * src_stride, row_bytes);
+  }
+  StreamFence();
+}
+
+void DownscaleFrameHalf(uint8_t* dst, const uint8_t* src, int width,
+                        int height, size_t src_stride) {
+  int half_width = width / 2;
+  int half_height = height / 2;
+  for (int y = 0; y < half_height; y++) {
+    const uint8_t* line = src + (size_t)y * 2 * src_stride;
+    uint8_t* out = dst + (size_t)y * half_width * 4;
+    for (int x = 0; x < half_width; x++) {
+      memcpy(out + x * 4, line + x * 8, 4);
+    }
+  }
+}
+
+void PublishImageStreamFrame(ImageStreamBuffer* buf, const uint8_t* src,
+                             int width, int height, size_t src_stride,
+                             int64_t sequence) {
+  buf->ready = 0;
+
+  CopyFrameRows(buf->pixels, src, (size_t)width * 4, height, src_stride);
+
+  buf->width = width;
+  buf->height = height;
+  buf->bytes_per_row = width * 4;
+  buf->format = 1;  // RGBA (Linux GStreamer pipeline)
+  buf->sequence = sequence;
+
+  // C-5: release fence — guarantees all pixel and metadata writes above
+  // are visible to any thread that subsequently observes ready == 1.
+  std::atomic_thread_fence(std::memory_order_release);
+  buf->ready = 1;
+}
+
+void MarkImageStreamUnchanged(ImageStreamBuffer* buf, int64_t sequence) {
+  buf->ready = 0;
+  buf->sequence = sequence;
+  std::atomic_thread_fence(std::memory_order_release);
+  buf->ready = 2;
+}
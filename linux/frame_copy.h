@@ -0,0 +1,72 @@
+#ifndef FRAME_COPY_H_
+#define FRAME_COPY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Per-frame copies out of mapped GStreamer buffers. These run on the
+// streaming thread for every frame, so they are kept free of allocation and
+// locking; linux/benchmark/hot_path_benchmark.cc measures them.
+
+// Copies of at least this many bytes use non-temporal (streaming) stores,
+// which write around the cache: a frame is read once by another thread, long
+// after it was written, so caching it only evicts the working set of every
+// other thread sharing the L3, inference threads among them. Below the
+// threshold a frame fits comfortably in cache and memcpy is faster. Picked
+// at runtime: AVX2 where the CPU has it, else SSE2; memcpy elsewhere.
+constexpr size_t kStreamingCopyThreshold = 2 * 1024 * 1024;
+
+// Overrides kStreamingCopyThreshold; SIZE_MAX turns streaming copies off.
+// For benchmarks.
+void SetStreamingCopyThreshold(size_t bytes);
+
+// Name of the streaming kernel in use: "avx2", "sse2" or "none".
+const char* StreamingCopyKernel();
+
+// Copies |size| bytes from |src| to |dst|.
+void CopyFrame(uint8_t* dst, const uint8_t* src, size_t size);
+
+// Copies |height| rows of |row_bytes| from |src|, whose rows are
+// |src_stride| bytes apart, into |dst| packed tightly. A tight source is
+// copied in one go.
+void CopyFrameRows(uint8_t* dst, const uint8_t* src, size_t row_bytes,
+                   int height, size_t src_stride);
+
+// Writes |src|, |height| rows of |width| RGBA pixels |src_stride| bytes
+// apart, at half the size into |dst| ((width / 2) x (height / 2), packed
+// tightly), taking every other pixel of every other row. For a preview
+// texture reduced under a memory budget, where point sampling is good
+// enough and a filter would cost more than the copy it replaces.
+void DownscaleFrameHalf(uint8_t* dst, const uint8_t* src, int width,
+                        int height, size_t src_stride);
+
+// FFI image stream shared buffer, read by Dart through the FFI pointer.
+// NOTE: The |ready| field acts as a release/acquire flag between the
+// GStreamer thread (writer) and Dart (reader). The native side MUST issue a
+// std::atomic_thread_fence(release) before writing ready=1, ensuring all
+// pixel writes are visible before Dart observes ready==1. (C-5)
+struct ImageStreamBuffer {
+  int64_t  sequence;
+  int32_t  width;
+  int32_t  height;
+  int32_t  bytes_per_row;
+  int32_t  format;       // 0=BGRA, 1=RGBA
+  int32_t  ready;        // 1=Dart may read, 0=native writing, 2=unchanged
+  int32_t  consumed;     // Low 32 bits of the last sequence Dart read.
+  uint8_t  pixels[];     // flexible array member
+};
+
+// Writes one RGBA frame into |buf| as |sequence|: clears |ready|, copies the
+// pixels and metadata, then sets |ready| behind a release fence. |buf| must
+// have room for width * height * 4 pixel bytes.
+void PublishImageStreamFrame(ImageStreamBuffer* buf, const uint8_t* src,
+                             int width, int height, size_t src_stride,
+                             int64_t sequence);
+
+// Advances |buf| to |sequence| without touching the pixels, for a frame that
+// matches the one already there. |ready| becomes 2, which tells the reader
+// the pixels are still those of the previous sequence, so it need not copy
+// them again.
+void MarkImageStreamUnchanged(ImageStreamBuffer* buf, int64_t sequence);
+
+#endif  // FRAME_COPY_H_
@@ -0,0 +1,188 @@
+#include "frame_trace.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace frame_trace {
+
+std::atomic<bool> g_enabled{false};
+
+namespace {
+
+// Events kept per thread: about 10 s of a 30 fps camera's full lifecycle
+// on its streaming thread, at ~600 KB per ring.
+const size_t kRingSize = 1 << 14;
+
+struct Event {
+  const char* name;
+  int64_t ts_us;
+  uint64_t id;
+  int64_t arg;
+  char phase;  // 'B', 'E', 'b', 'e' as in the Chrome trace format.
+};
+
+struct ThreadRing {
+  // Total events ever written; the writer publishes with release so the
+  // dumper sees complete events up to |head|.
+  std::atomic<uint64_t> head{0};
+  std::atomic<bool> in_use{true};
+  pid_t tid = 0;
+  char thread_name[16] = {};
+  Event events[kRingSize];
+};
+
+// Rings are never freed: a dump may be reading one while its thread exits.
+// A ring whose thread has exited is handed to the next new thread instead.
+std::mutex g_rings_mutex;
+std::vector<ThreadRing*> g_rings;
+
+struct RingOwner {
+  ThreadRing* ring = nullptr;
+  ~RingOwner() {
+    if (ring) ring->in_use.store(false, std::memory_order_release);
+  }
+};
+
+thread_local RingOwner t_owner;
+
+ThreadRing* CurrentRing() {
+  if (t_owner.ring) return t_owner.ring;
+
+  std::lock_guard<std::mutex> lk(g_rings_mutex);
+  ThreadRing* ring = nullptr;
+  for (ThreadRing* r : g_rings) {
+    if (!r->in_use.load(std::memory_order_acquire)) {
+      ring = r;
+      ring->in_use.store(true, std::memory_order_relaxed);
+      ring->head.store(0, std::memory_order_relaxed);
+      break;
+    }
+  }
+  if (!ring) {
+    ring = new ThreadRing();
+    g_rings.push_back(ring);
+  }
+  ring->tid = static_cast<pid_t>(syscall(SYS_gettid));
+  memset(ring->thread_name, 0, sizeof(ring->thread_name));
+  pthread_getname_np(pthread_self(), ring->thread_name,
+                     sizeof(ring->thread_name));
+  t_owner.ring = ring;
+  return ring;
+}
+
+void Record(char phase, const char* name, uint64_t id, int64_t arg) {
+  if (!Enabled()) return;
+  ThreadRing* ring = CurrentRing();
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  Event& event = ring->events[head % kRingSize];
+  event.name = name;
+  event.ts_us = g_get_monotonic_time();
+  event.id = id;
+  event.arg = arg;
+  event.phase = phase;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+
+std::string JsonSafe(const char* s) {
+  std::string out;
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\' || static_cast<unsigned char>(*s) < 0x20) {
+      out += '_';
+    } else {
+      out += *s;
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+void SetEnabled(bool enabled) {
+  g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Begin(const char* name, int64_t arg) { Record('B', name, 0, arg); }
+
+void End(const char* name) { Record('E', name, 0, 0); }
+
+void AsyncBegin(const char* name, uint64_t id, int64_t arg) {
+  Record('b', name, id, arg);
+}
+
+void AsyncEnd(const char* name, uint64_t id) { Record('e', name, id, 0); }
+
+int64_t Dump(const std::string& path, std::string* error) {
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f) {
+    if (error) *error = std::string("Cannot open ") + path + ": " +
+                        strerror(errno);
+    return -1;
+  }
+
+  const int pid = static_cast<int>(getpid());
+  int64_t written = 0;
+  bool first = true;
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+
+  std::lock_guard<std::mutex> lk(g_rings_mutex);
+  std::vector<Event> events;
+  for (ThreadRing* ring : g_rings) {
+    // Copy without stopping the writer, then drop whatever it may have
+    // overwritten while we were copying.
+    uint64_t end = ring->head.load(std::memory_order_acquire);
+    uint64_t begin = end > kRingSize ? end - kRingSize : 0;
+    events.clear();
+    for (uint64_t i = begin; i < end; i++) {
+      events.push_back(ring->events[i % kRingSize]);
+    }
+    uint64_t after = ring->head.load(std::memory_order_acquire);
+    size_t skip = 0;
+    if (after > kRingSize && after - kRingSize > begin) {
+      skip = static_cast<size_t>(
+          std::min<uint64_t>(after - kRingSize - begin, events.size()));
+    }
+    if (events.size() == skip) continue;
+
+    fprintf(f,
+            "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,"
+            "\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",\n", pid, ring->tid,
+            JsonSafe(ring->thread_name).c_str());
+    first = false;
+
+    for (size_t i = skip; i < events.size(); i++) {
+      const Event& e = events[i];
+      fprintf(f,
+              ",\n{\"ph\":\"%c\",\"cat\":\"frame\",\"name\":\"%s\","
+              "\"pid\":%d,\"tid\":%d,\"ts\":%" G_GINT64_FORMAT,
+              e.phase, e.name, pid, ring->tid, e.ts_us);
+      if (e.phase == 'b' || e.phase == 'e') {
+        fprintf(f, ",\"id\":\"0x%" G_GINT64_MODIFIER "x\"",
+                static_cast<guint64>(e.id));
+      }
+      if (e.phase == 'B' || e.phase == 'b') {
+        fprintf(f, ",\"args\":{\"camera\":%" G_GINT64_FORMAT "}", e.arg);
+      }
+      fputs("}", f);
+      written++;
+    }
+  }
+  fputs("\n]}\n", f);
+
+  if (fclose(f) != 0) {
+    if (error) *error = std::string("Failed to write ") + path;
+    return -1;
+  }
+  return written;
+}
+
+}  // namespace frame_trace
@@ -0,0 +1,58 @@
+#ifndef FRAME_TRACE_H_
+#define FRAME_TRACE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// In-memory timeline of the frame lifecycle, exported as Chrome Trace Event
+// JSON (opens in Perfetto or chrome://tracing).
+//
+// Each thread records into its own fixed-size ring, so recording is a few
+// stores and one release store of the ring head: no lock, no allocation
+// after the thread's first event. Old events are overwritten once a ring
+// is full. Recording is off by default; while off, every call below is a
+// single relaxed load.
+//
+// Event names must be string literals (only the pointer is stored).
+namespace frame_trace {
+
+extern std::atomic<bool> g_enabled;
+
+inline bool Enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void SetEnabled(bool enabled);
+
+// Duration events; must nest per thread.
+void Begin(const char* name, int64_t arg);
+void End(const char* name);
+
+// Async events for work that starts and finishes on different calls or
+// threads (e.g. a frame entering and leaving the encoder), matched by |id|.
+void AsyncBegin(const char* name, uint64_t id, int64_t arg);
+void AsyncEnd(const char* name, uint64_t id);
+
+// Writes all rings to |path| as Chrome Trace JSON. Returns the number of
+// events written, or -1 and sets |error| on I/O failure.
+int64_t Dump(const std::string& path, std::string* error);
+
+// Emits Begin on construction and End on destruction when tracing is on.
+class Scope {
+ public:
+  Scope(const char* name, int64_t arg) : name_(Enabled() ? name : nullptr) {
+    if (name_) Begin(name_, arg);
+  }
+  ~Scope() {
+    if (name_) End(name_);
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  const char* name_;
+};
+
+}  // namespace frame_trace
+
+#endif  // FRAME_TRACE_H_
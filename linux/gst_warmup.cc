@@ -0,0 +1,94 @@
+#include "gst_warmup.h"
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <string>
+
+#include "record_handler.h"
+
+namespace {
+
+// Factories every camera instantiates, beyond the encoders. Loading them
+// here moves the dlopen of their plugins off the first initialize.
+const char* const kWarmFactories[] = {
+    "v4l2src", "videoconvert", "videoscale", "videoflip", "capsfilter",
+    "tee",     "queue",        "valve",      "appsink",   "jpegenc",
+    "mp4mux",
+};
+
+GMutex g_lock;
+GCond g_cond;
+bool g_started = false;  // Guarded by g_lock.
+std::atomic<bool> g_ready{false};
+// Written before g_ready is released; read after acquiring it.
+gint64 g_init_start_us = 0;
+gint64 g_init_end_us = 0;
+
+void RunInit() {
+  g_init_start_us = g_get_monotonic_time();
+  gst_init(nullptr, nullptr);
+  g_init_end_us = g_get_monotonic_time();
+  g_mutex_lock(&g_lock);
+  g_ready.store(true, std::memory_order_release);
+  g_cond_broadcast(&g_cond);
+  g_mutex_unlock(&g_lock);
+}
+
+void LoadFactory(const char* name) {
+  if (!name || !*name) return;
+  GstElementFactory* factory = gst_element_factory_find(name);
+  if (!factory) return;
+  GstPluginFeature* loaded =
+      gst_plugin_feature_load(GST_PLUGIN_FEATURE(factory));
+  if (loaded) gst_object_unref(loaded);
+  gst_object_unref(factory);
+}
+
+gpointer WarmupMain(gpointer data) {
+  RunInit();
+  for (const char* name : kWarmFactories) LoadFactory(name);
+  // The encoder probes are cached, so recording later reuses these results.
+  LoadFactory(RecordHandler::DetectEncoder().c_str());
+  LoadFactory(RecordHandler::DetectAudioEncoder().c_str());
+  return nullptr;
+}
+
+// Claims the right to run initialization. Returns false if another caller
+// already has.
+bool Claim() {
+  g_mutex_lock(&g_lock);
+  bool first = !g_started;
+  g_started = true;
+  g_mutex_unlock(&g_lock);
+  return first;
+}
+
+}  // namespace
+
+void GstWarmup::Start() {
+  if (!Claim()) return;
+  // Never joined; the thread exits once warm-up is done.
+  g_thread_unref(g_thread_new("camera-gst-init", WarmupMain, nullptr));
+}
+
+void GstWarmup::EnsureInitialized() {
+  if (g_ready.load(std::memory_order_acquire)) return;
+  if (Claim()) {
+    RunInit();
+    return;
+  }
+  g_mutex_lock(&g_lock);
+  while (!g_ready.load(std::memory_order_acquire)) {
+    g_cond_wait(&g_cond, &g_lock);
+  }
+  g_mutex_unlock(&g_lock);
+}
+
+gint64 GstWarmup::init_start_us() {
+  return g_ready.load(std::memory_order_acquire) ? g_init_start_us : 0;
+}
+
+gint64 GstWarmup::init_end_us() {
+  return g_ready.load(std::memory_order_acquire) ? g_init_end_us : 0;
+}
@@ -0,0 +1,30 @@
+#ifndef GST_WARMUP_H_
+#define GST_WARMUP_H_
+
+#include <glib.h>
+
+// Initializes GStreamer off the main thread. On a cold cache gst_init can
+// spend hundreds of milliseconds scanning the plugin registry, which used to
+// delay the app's first frame even when no camera was ever opened. Start()
+// runs it on a background thread instead, then loads the element factories
+// a camera needs (source, conversion, preview, encoders) so the first
+// pipeline does not pay for loading their plugins either.
+//
+// Anything that touches GStreamer must call EnsureInitialized() first; it
+// only blocks when it arrives before gst_init has finished.
+class GstWarmup {
+ public:
+  // Starts initialization and factory warm-up on a background thread.
+  // Returns immediately; later calls do nothing.
+  static void Start();
+
+  // Blocks until gst_init has completed, running it on the calling thread if
+  // Start() was never called. Returns at once after that.
+  static void EnsureInitialized();
+
+  // When gst_init ran (g_get_monotonic_time); 0 until it has finished.
+  static gint64 init_start_us();
+  static gint64 init_end_us();
+};
+
+#endif  // GST_WARMUP_H_
@@ -0,0 +1,212 @@
+#include "latency_tracer.h"
+
+#include <algorithm>
+
+// Arrivals remembered per element. Must cover the deepest queue between a
+// sink-pad stamp and the matching src-pad lookup; the branch and recording
+// queues hold a handful of frames, the recording queue up to ~3 s, so very
+// deep recording backlogs simply go unmeasured.
+static const int kArrivalRing = 128;
+
+struct LatencyTracer::ElementProbe {
+  GstElement* element = nullptr;  // Holds a ref.
+  GstPad* sink_pad = nullptr;     // Holds a ref; null for sources.
+  GstPad* src_pad = nullptr;      // Holds a ref.
+  gulong sink_probe_id = 0;
+  gulong src_probe_id = 0;
+
+  std::string name;
+  std::string factory;
+  std::string kind;
+  Stage stage = Stage::kBranch;
+
+  // Arrival stamps, written on the sink pad's thread and consumed on the src
+  // pad's thread (different threads for a queue).
+  GMutex mutex;
+  GstClockTime arrival_pts[kArrivalRing];
+  gint64 arrival_us[kArrivalRing];
+  int next_arrival = 0;
+
+  // Written only from the src pad's streaming thread.
+  LatencyHistogram latency;
+
+  ElementProbe() {
+    g_mutex_init(&mutex);
+    std::fill(arrival_pts, arrival_pts + kArrivalRing, GST_CLOCK_TIME_NONE);
+  }
+  ~ElementProbe() {
+    if (sink_pad) gst_object_unref(sink_pad);
+    if (src_pad) gst_object_unref(src_pad);
+    if (element) gst_object_unref(element);
+    g_mutex_clear(&mutex);
+  }
+};
+
+void LatencyTracer::FreeProbeRef(gpointer user_data) {
+  delete static_cast<ProbeRef*>(user_data);
+}
+
+GstPadProbeReturn LatencyTracer::OnSinkBuffer(GstPad* pad,
+                                              GstPadProbeInfo* info,
+                                              gpointer user_data) {
+  auto* probe = static_cast<ProbeRef*>(user_data)->get();
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) return GST_PAD_PROBE_OK;
+
+  g_mutex_lock(&probe->mutex);
+  probe->arrival_pts[probe->next_arrival] = GST_BUFFER_PTS(buffer);
+  probe->arrival_us[probe->next_arrival] = g_get_monotonic_time();
+  probe->next_arrival = (probe->next_arrival + 1) % kArrivalRing;
+  g_mutex_unlock(&probe->mutex);
+  return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn LatencyTracer::OnSrcBuffer(GstPad* pad,
+                                             GstPadProbeInfo* info,
+                                             gpointer user_data) {
+  auto* probe = static_cast<ProbeRef*>(user_data)->get();
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) return GST_PAD_PROBE_OK;
+  GstClockTime pts = GST_BUFFER_PTS(buffer);
+
+  if (!probe->sink_pad) {
+    // Source: time from the capture timestamp to the push.
+    GstClock* clock = gst_element_get_clock(probe->element);
+    if (clock) {
+      GstClockTime now = gst_clock_get_time(clock) -
+                         gst_element_get_base_time(probe->element);
+      if (now >= pts) {
+        probe->latency.Record(GST_TIME_AS_USECONDS(now - pts));
+      }
+      gst_object_unref(clock);
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  gint64 arrival_us = -1;
+  g_mutex_lock(&probe->mutex);
+  // Newest first: the match is almost always the latest arrival.
+  for (int i = 1; i <= kArrivalRing; i++) {
+    int slot = (probe->next_arrival - i + kArrivalRing) % kArrivalRing;
+    if (probe->arrival_pts[slot] == pts) {
+      arrival_us = probe->arrival_us[slot];
+      probe->arrival_pts[slot] = GST_CLOCK_TIME_NONE;
+      break;
+    }
+  }
+  g_mutex_unlock(&probe->mutex);
+
+  if (arrival_us >= 0) {
+    probe->latency.Record(g_get_monotonic_time() - arrival_us);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+LatencyTracer::LatencyTracer() {}
+
+LatencyTracer::~LatencyTracer() {
+  for (auto& probe : probes_) {
+    if (probe->sink_probe_id) {
+      gst_pad_remove_probe(probe->sink_pad, probe->sink_probe_id);
+    }
+    if (probe->src_probe_id) {
+      gst_pad_remove_probe(probe->src_pad, probe->src_probe_id);
+    }
+  }
+}
+
+void LatencyTracer::Instrument(GstBin* bin, Stage stage) {
+  // Sorted iteration runs sink to source; reverse it for stream order.
+  std::vector<GstElement*> elements;
+  GstIterator* it = gst_bin_iterate_sorted(bin);
+  GValue item = G_VALUE_INIT;
+  bool done = false;
+  while (!done) {
+    switch (gst_iterator_next(it, &item)) {
+      case GST_ITERATOR_OK:
+        elements.push_back(GST_ELEMENT(g_value_dup_object(&item)));
+        g_value_reset(&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        for (GstElement* e : elements) gst_object_unref(e);
+        elements.clear();
+        gst_iterator_resync(it);
+        break;
+      default:
+        done = true;
+        break;
+    }
+  }
+  g_value_unset(&item);
+  gst_iterator_free(it);
+  std::reverse(elements.begin(), elements.end());
+
+  for (GstElement* element : elements) {
+    bool known = std::any_of(
+        probes_.begin(), probes_.end(),
+        [element](const ProbeRef& p) { return p->element == element; });
+    GstPad* src_pad = nullptr;
+    GstPad* sink_pad = nullptr;
+    if (!known && !GST_IS_BIN(element)) {
+      src_pad = gst_element_get_static_pad(element, "src");
+      sink_pad = gst_element_get_static_pad(element, "sink");
+    }
+    // Needs a single static src pad, and either no inputs (a source) or a
+    // single static sink pad. That leaves out tees, muxers and sinks.
+    bool usable = src_pad && (sink_pad || element->numsinkpads == 0);
+    if (!usable) {
+      if (src_pad) gst_object_unref(src_pad);
+      if (sink_pad) gst_object_unref(sink_pad);
+      gst_object_unref(element);
+      continue;
+    }
+
+    auto probe = std::make_shared<ElementProbe>();
+    probe->element = element;  // Takes the iterator's ref.
+    probe->src_pad = src_pad;
+    probe->sink_pad = sink_pad;
+    gchar* name = gst_element_get_name(element);
+    probe->name = name;
+    g_free(name);
+    GstElementFactory* factory = gst_element_get_factory(element);
+    probe->factory =
+        factory ? GST_OBJECT_NAME(factory) : G_OBJECT_TYPE_NAME(element);
+    probe->kind = !sink_pad                  ? "source"
+                  : probe->factory == "queue" ? "queue"
+                                              : "transform";
+    probe->stage = g_str_has_prefix(probe->name.c_str(), "rec_")
+                       ? Stage::kRecord
+                       : stage;
+
+    if (sink_pad) {
+      probe->sink_probe_id = gst_pad_add_probe(
+          sink_pad, GST_PAD_PROBE_TYPE_BUFFER, OnSinkBuffer,
+          new ProbeRef(probe), FreeProbeRef);
+    }
+    probe->src_probe_id =
+        gst_pad_add_probe(src_pad, GST_PAD_PROBE_TYPE_BUFFER, OnSrcBuffer,
+                          new ProbeRef(probe), FreeProbeRef);
+    probes_.push_back(probe);
+  }
+}
+
+std::vector<LatencyTracer::ElementReport> LatencyTracer::Report() const {
+  std::vector<ElementReport> report;
+  for (const auto& probe : probes_) {
+    report.push_back({probe->name, probe->factory, probe->kind, probe->stage,
+                      probe->latency.Read()});
+  }
+  return report;
+}
+
+const char* LatencyTracer::StageName(Stage stage) {
+  switch (stage) {
+    case Stage::kCapture:
+      return "capture";
+    case Stage::kBranch:
+      return "branch";
+    case Stage::kRecord:
+      return "record";
+  }
+  return "branch";
+}
@@ -0,0 +1,69 @@
+#ifndef LATENCY_TRACER_H_
+#define LATENCY_TRACER_H_
+
+#include <gst/gst.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "camera_stats.h"
+
+// Opt-in per-element latency instrumentation built on pad probes.
+//
+// For every single-input/single-output element it instruments, a buffer
+// probe on the sink pad stamps the arrival time of each PTS and a probe on
+// the src pad looks the PTS up again when the buffer leaves. For a queue
+// that interval is the time spent waiting in the queue; for any other
+// element it is the processing time. For a source the src probe records
+// how long after its capture timestamp the buffer was pushed.
+//
+// Probes cost a mutex and a clock read per buffer per element, so they are
+// only installed while tracing is enabled. Elements whose output cannot be
+// matched to an input by PTS (muxers, tees, sinks) are not instrumented.
+class LatencyTracer {
+ public:
+  enum class Stage { kCapture, kBranch, kRecord };
+
+  struct ElementReport {
+    std::string name;
+    std::string factory;
+    std::string kind;  // "source", "queue" or "transform".
+    Stage stage;
+    LatencyHistogram::Snapshot latency;
+  };
+
+  LatencyTracer();
+  ~LatencyTracer();  // Removes all probes.
+
+  LatencyTracer(const LatencyTracer&) = delete;
+  LatencyTracer& operator=(const LatencyTracer&) = delete;
+
+  // Instruments the direct children of |bin| in stream order. Child bins are
+  // skipped. Elements already instrumented are left alone, so this can be
+  // called again after elements are added (e.g. when recording starts).
+  // Elements named rec_* are reported as kRecord, others as |stage|.
+  void Instrument(GstBin* bin, Stage stage);
+
+  // Per-element results in the order the elements were instrumented.
+  std::vector<ElementReport> Report() const;
+
+  static const char* StageName(Stage stage);
+
+ private:
+  struct ElementProbe;
+  using ProbeRef = std::shared_ptr<ElementProbe>;
+
+  // Each probe's user_data is a heap ProbeRef freed by FreeProbeRef, so a
+  // callback still running on a streaming thread keeps its ElementProbe
+  // alive after the tracer is gone.
+  static GstPadProbeReturn OnSinkBuffer(GstPad* pad, GstPadProbeInfo* info,
+                                        gpointer user_data);
+  static GstPadProbeReturn OnSrcBuffer(GstPad* pad, GstPadProbeInfo* info,
+                                       gpointer user_data);
+  static void FreeProbeRef(gpointer user_data);
+
+  std::vector<ProbeRef> probes_;
+};
+
+#endif  // LATENCY_TRACER_H_
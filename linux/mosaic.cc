@@ -0,0 +1,414 @@
+#include "mosaic.h"
+
+#include <gio/gio.h>
+#include <gst/app/gstappsrc.h>
+#include <gst/video/video.h>
+
+#include <cstring>
+#include <utility>
+
+Mosaic::Mosaic(int mosaic_id,
+               FlTextureRegistrar* texture_registrar,
+               FlMethodChannel* method_channel,
+               const MosaicLayout& layout)
+    : mosaic_id_(mosaic_id),
+      texture_id_(-1),
+      layout_(layout),
+      texture_registrar_(texture_registrar),
+      method_channel_(method_channel),
+      texture_(nullptr),
+      allocator_(std::make_shared<FrameAllocator>()),
+      canvas_(nullptr),
+      canvas_size_(0),
+      canvas_dirty_(false),
+      compositor_thread_(nullptr),
+      compositor_running_(false),
+      record_pipeline_(nullptr),
+      record_src_(nullptr),
+      record_tee_(nullptr),
+      record_bus_watch_id_(0),
+      record_handler_(std::make_unique<RecordHandler>()),
+      recording_(false),
+      record_pts_(0),
+      disposed_(false) {
+  g_mutex_init(&canvas_mutex_);
+  g_mutex_init(&compositor_mutex_);
+  g_cond_init(&compositor_cond_);
+
+  // Opaque black until each tile delivers its first frame.
+  canvas_size_ = (size_t)width() * height() * 4;
+  canvas_ = allocator_->Allocate(canvas_size_);
+  memset(canvas_, 0, canvas_size_);
+  for (size_t i = 3; i < canvas_size_; i += 4) {
+    canvas_[i] = 0xFF;
+  }
+}
+
+Mosaic::~Mosaic() {
+  Dispose();
+  g_cond_clear(&compositor_cond_);
+  g_mutex_clear(&compositor_mutex_);
+  g_mutex_clear(&canvas_mutex_);
+}
+
+int64_t Mosaic::RegisterTexture() {
+  texture_ = camera_texture_new_with_allocator(allocator_);
+  FlTexture* fl_tex = camera_texture_as_fl_texture(texture_);
+  if (!fl_texture_registrar_register_texture(texture_registrar_, fl_tex)) {
+    g_object_unref(texture_);
+    texture_ = nullptr;
+    return -1;
+  }
+  texture_id_ = fl_texture_get_id(fl_tex);
+  return texture_id_;
+}
+
+bool Mosaic::AddTile(int index, std::shared_ptr<CaptureSession> session,
+                     GError** error) {
+  // Scale down in the tile's own thread before anything is copied. The
+  // leaky queue drops stale frames instead of slowing the device's other
+  // consumers. The canvas has square pixels; with the pixel aspect ratio
+  // fixed too, add-borders letterboxes the source inside the cell instead
+  // of stretching it.
+  gchar* branch_str = g_strdup_printf(
+      "queue max-size-buffers=1 leaky=downstream "
+      "! videoscale add-borders=true "
+      "! video/x-raw,format=RGBA,width=%d,height=%d,pixel-aspect-ratio=1/1 "
+      "! appsink name=sink max-buffers=1 drop=true sync=false",
+      layout_.tile_width, layout_.tile_height);
+  GstElement* branch = gst_parse_bin_from_description(branch_str, TRUE, error);
+  g_free(branch_str);
+  if (!branch) return false;
+  gst_object_ref_sink(branch);
+
+  gchar* branch_name =
+      g_strdup_printf("mosaic_%d_tile_%d", mosaic_id_, index);
+  gst_object_set_name(GST_OBJECT(branch), branch_name);
+  g_free(branch_name);
+
+  auto tile = std::make_unique<Tile>();
+  tile->mosaic = this;
+  tile->index = index;
+  tile->session = std::move(session);
+  tile->branch = branch;
+
+  GstElement* appsink = gst_bin_get_by_name(GST_BIN(branch), "sink");
+  GstAppSinkCallbacks callbacks = {};
+  callbacks.new_sample = Mosaic::OnTileSample;
+  gst_app_sink_set_callbacks(GST_APP_SINK(appsink), &callbacks, tile.get(),
+                             nullptr);
+  gst_object_unref(appsink);
+
+  if (!tile->session->AttachBranch(branch, Mosaic::OnTileMessage, tile.get(),
+                                   error)) {
+    gst_object_unref(branch);
+    return false;
+  }
+
+  tiles_.push_back(std::move(tile));
+  return true;
+}
+
+void Mosaic::Start() {
+  g_mutex_lock(&compositor_mutex_);
+  if (compositor_running_) {
+    g_mutex_unlock(&compositor_mutex_);
+    return;
+  }
+  compositor_running_ = true;
+  g_mutex_unlock(&compositor_mutex_);
+
+  compositor_thread_ =
+      g_thread_new("camera-mosaic", Mosaic::CompositorThread, this);
+}
+
+GstFlowReturn Mosaic::OnTileSample(GstAppSink* sink, gpointer user_data) {
+  Tile* tile = static_cast<Tile*>(user_data);
+  Mosaic* self = tile->mosaic;
+
+  GstSample* sample = gst_app_sink_pull_sample(sink);
+  if (!sample) return GST_FLOW_ERROR;
+
+  GstVideoInfo info;
+  if (!gst_video_info_from_caps(&info, gst_sample_get_caps(sample))) {
+    gst_sample_unref(sample);
+    return GST_FLOW_ERROR;
+  }
+
+  GstBuffer* buffer = gst_sample_get_buffer(sample);
+  GstMapInfo map;
+  if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    gst_sample_unref(sample);
+    return GST_FLOW_ERROR;
+  }
+
+  // Caps pin the tile size, but clamp anyway so a renegotiation can never
+  // write outside the cell.
+  int width = MIN(GST_VIDEO_INFO_WIDTH(&info), self->layout_.tile_width);
+  int height = MIN(GST_VIDEO_INFO_HEIGHT(&info), self->layout_.tile_height);
+  int stride = GST_VIDEO_INFO_PLANE_STRIDE(&info, 0);
+
+  int col = tile->index % self->layout_.columns;
+  int row = tile->index / self->layout_.columns;
+  size_t canvas_stride = (size_t)self->width() * 4;
+  uint8_t* dst = self->canvas_ +
+                 (size_t)row * self->layout_.tile_height * canvas_stride +
+                 (size_t)col * self->layout_.tile_width * 4;
+
+  g_mutex_lock(&self->canvas_mutex_);
+  for (int y = 0; y < height; y++) {
+    memcpy(dst + y * canvas_stride, map.data + (size_t)y * stride,
+           (size_t)width * 4);
+  }
+  g_mutex_unlock(&self->canvas_mutex_);
+  self->canvas_dirty_.store(true);
+
+  gst_buffer_unmap(buffer, &map);
+  gst_sample_unref(sample);
+  return GST_FLOW_OK;
+}
+
+void Mosaic::OnTileMessage(GstMessage* msg, gpointer user_data) {
+  Tile* tile = static_cast<Tile*>(user_data);
+  Mosaic* self = tile->mosaic;
+
+  const char* description = nullptr;
+  GError* err = nullptr;
+  if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error(msg, &err, nullptr);
+    description = err->message;
+  } else if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS) {
+    description = "Camera stream ended unexpectedly";
+  }
+
+  // A failing tile freezes its cell; the rest of the wall keeps running.
+  if (description) self->SendError(tile->index, description);
+  if (err) g_error_free(err);
+}
+
+gboolean Mosaic::OnRecordBusMessage(GstBus* bus, GstMessage* msg,
+                                    gpointer user_data) {
+  Mosaic* self = static_cast<Mosaic*>(user_data);
+  if (GST_MESSAGE_TYPE(msg) != GST_MESSAGE_ERROR) return G_SOURCE_CONTINUE;
+
+  GError* err = nullptr;
+  gst_message_parse_error(msg, &err, nullptr);
+  // The file cannot be finalized any more; the texture keeps running.
+  self->recording_.store(false);
+  self->record_handler_->AbortRecording(err->message);
+  self->SendError(-1, err->message);
+  g_error_free(err);
+  return G_SOURCE_CONTINUE;
+}
+
+void Mosaic::SendError(int tile, const char* description) {
+  g_autoptr(FlValue) args = fl_value_new_map();
+  fl_value_set_string_take(args, "mosaicId", fl_value_new_int(mosaic_id_));
+  fl_value_set_string_take(args, "tile", fl_value_new_int(tile));
+  fl_value_set_string_take(args, "description",
+                           fl_value_new_string(description));
+  fl_method_channel_invoke_method(method_channel_, "mosaicError", args,
+                                  nullptr, nullptr, nullptr);
+}
+
+gpointer Mosaic::CompositorThread(gpointer user_data) {
+  Mosaic* self = static_cast<Mosaic*>(user_data);
+  const gint64 interval_us = G_USEC_PER_SEC / MAX(self->layout_.fps, 1);
+  gint64 next = g_get_monotonic_time();
+
+  g_mutex_lock(&self->compositor_mutex_);
+  while (self->compositor_running_) {
+    next += interval_us;
+    // Wake at the refresh rate, or immediately when Dispose signals.
+    while (self->compositor_running_ &&
+           g_cond_wait_until(&self->compositor_cond_,
+                             &self->compositor_mutex_, next)) {
+    }
+    if (!self->compositor_running_) break;
+    g_mutex_unlock(&self->compositor_mutex_);
+
+    // One upload per refresh, and only if some tile changed.
+    if (self->canvas_dirty_.exchange(false)) {
+      g_mutex_lock(&self->canvas_mutex_);
+      camera_texture_update(self->texture_, self->canvas_, self->width(),
+                            self->height());
+      g_mutex_unlock(&self->canvas_mutex_);
+      fl_texture_registrar_mark_texture_frame_available(
+          self->texture_registrar_,
+          camera_texture_as_fl_texture(self->texture_));
+    }
+
+    // The recording runs at a constant rate even when no tile changed.
+    if (self->recording_.load()) {
+      self->PushRecordFrame();
+    }
+
+    g_mutex_lock(&self->compositor_mutex_);
+  }
+  g_mutex_unlock(&self->compositor_mutex_);
+  return nullptr;
+}
+
+bool Mosaic::BuildRecordPipeline(GError** error) {
+  gchar* pipeline_str = g_strdup_printf(
+      "appsrc name=src is-live=true format=time do-timestamp=false "
+      "caps=\"video/x-raw,format=RGBA,width=%d,height=%d,framerate=%d/1\" "
+      "! tee name=t allow-not-linked=true",
+      width(), height(), layout_.fps);
+  record_pipeline_ = gst_parse_launch(pipeline_str, error);
+  g_free(pipeline_str);
+  if (!record_pipeline_) return false;
+
+  record_src_ = gst_bin_get_by_name(GST_BIN(record_pipeline_), "src");
+  record_tee_ = gst_bin_get_by_name(GST_BIN(record_pipeline_), "t");
+  // Release our refs (pipeline holds them).
+  if (record_src_) gst_object_unref(record_src_);
+  if (record_tee_) gst_object_unref(record_tee_);
+  if (!record_src_ || !record_tee_) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to build mosaic recording pipeline");
+    gst_object_unref(record_pipeline_);
+    record_pipeline_ = nullptr;
+    return false;
+  }
+
+  // Encoder, muxer and filesink errors surface here, not on any session.
+  GstBus* bus = gst_pipeline_get_bus(GST_PIPELINE(record_pipeline_));
+  record_bus_watch_id_ = gst_bus_add_watch(bus, Mosaic::OnRecordBusMessage,
+                                           this);
+  gst_object_unref(bus);
+
+  if (!record_handler_->Setup(record_pipeline_, record_tee_, width(),
+                              height(), layout_.fps, layout_.target_bitrate,
+                              0, false, error)) {
+    g_source_remove(record_bus_watch_id_);
+    record_bus_watch_id_ = 0;
+    gst_object_unref(record_pipeline_);
+    record_pipeline_ = nullptr;
+    return false;
+  }
+
+  if (gst_element_set_state(record_pipeline_, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to start mosaic recording pipeline");
+    g_source_remove(record_bus_watch_id_);
+    record_bus_watch_id_ = 0;
+    gst_element_set_state(record_pipeline_, GST_STATE_NULL);
+    gst_object_unref(record_pipeline_);
+    record_pipeline_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void Mosaic::PushRecordFrame() {
+  GstBuffer* buffer = gst_buffer_new_allocate(nullptr, canvas_size_, nullptr);
+  GstMapInfo map;
+  if (!gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+    gst_buffer_unref(buffer);
+    return;
+  }
+  g_mutex_lock(&canvas_mutex_);
+  memcpy(map.data, canvas_, canvas_size_);
+  g_mutex_unlock(&canvas_mutex_);
+  gst_buffer_unmap(buffer, &map);
+
+  GstClockTime duration =
+      gst_util_uint64_scale_int(GST_SECOND, 1, MAX(layout_.fps, 1));
+  GST_BUFFER_PTS(buffer) = record_pts_;
+  GST_BUFFER_DURATION(buffer) = duration;
+  record_pts_ += duration;
+
+  // Takes ownership of |buffer|.
+  gst_app_src_push_buffer(GST_APP_SRC(record_src_), buffer);
+}
+
+void Mosaic::StartRecording(FlMethodCall* method_call) {
+  GError* error = nullptr;
+  if (!record_pipeline_ && !BuildRecordPipeline(&error)) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(
+        method_call, "recording_setup_failed",
+        error ? error->message : "Failed to set up recording", details,
+        nullptr);
+    if (error) g_error_free(error);
+    return;
+  }
+
+  static std::atomic<int64_t> rec_seq{0};
+  gchar* tmp_path = g_strdup_printf(
+      "%s/camera_desktop_mosaic_%d_%" G_GINT64_FORMAT ".%s",
+      g_get_tmp_dir(), mosaic_id_,
+      rec_seq.fetch_add(1, std::memory_order_relaxed),
+      record_handler_->output_extension());
+
+  if (!record_handler_->StartRecording(tmp_path, &error)) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(
+        method_call, "recording_start_failed",
+        error ? error->message : "Failed to start recording", details,
+        nullptr);
+    if (error) g_error_free(error);
+    g_free(tmp_path);
+    return;
+  }
+  g_free(tmp_path);
+
+  recording_.store(true);
+  fl_method_call_respond_success(method_call, fl_value_new_null(), nullptr);
+}
+
+void Mosaic::StopRecording(FlMethodCall* method_call) {
+  recording_.store(false);
+  record_handler_->StopRecording(method_call);
+}
+
+void Mosaic::Dispose() {
+  if (disposed_) return;
+  disposed_ = true;
+
+  // Stop the compositor first so nothing reads the canvas or pushes into
+  // the recording pipeline while it is torn down.
+  if (compositor_thread_) {
+    g_mutex_lock(&compositor_mutex_);
+    compositor_running_ = false;
+    g_cond_signal(&compositor_cond_);
+    g_mutex_unlock(&compositor_mutex_);
+    g_thread_join(compositor_thread_);
+    compositor_thread_ = nullptr;
+  }
+  recording_.store(false);
+
+  // Detaching blocks until each tile's streaming thread has left
+  // OnTileSample, after which the canvas can be freed.
+  for (auto& tile : tiles_) {
+    tile->session->DetachBranch(tile->branch);
+    gst_object_unref(tile->branch);
+    tile->branch = nullptr;
+  }
+  tiles_.clear();
+
+  if (record_pipeline_) {
+    // A stop still waiting for the file is answered before it goes away.
+    record_handler_->AbortRecording("Mosaic was disposed while recording");
+    g_source_remove(record_bus_watch_id_);
+    record_bus_watch_id_ = 0;
+    gst_element_set_state(record_pipeline_, GST_STATE_NULL);
+    gst_object_unref(record_pipeline_);
+    record_pipeline_ = nullptr;
+    record_src_ = nullptr;
+    record_tee_ = nullptr;
+  }
+
+  if (texture_ && texture_registrar_) {
+    fl_texture_registrar_unregister_texture(
+        texture_registrar_, camera_texture_as_fl_texture(texture_));
+    g_object_unref(texture_);
+    texture_ = nullptr;
+  }
+
+  allocator_->Release(canvas_, canvas_size_);
+  canvas_ = nullptr;
+  canvas_size_ = 0;
+}
@@ -0,0 +1,129 @@
+#ifndef MOSAIC_H_
+#define MOSAIC_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "camera_texture.h"
+#include "capture_session.h"
+#include "frame_allocator.h"
+#include "record_handler.h"
+
+struct MosaicLayout {
+  int columns;
+  int rows;
+  int tile_width;
+  int tile_height;
+  int fps;             // Texture refresh (and recording) rate.
+  int target_bitrate;  // Recording bitrate in bps, 0 for encoder default.
+};
+
+// Composes several devices into a single texture laid out as a grid.
+//
+// Each tile attaches a branch to its device's CaptureSession that scales the
+// frame down to the tile size before it reaches the appsink:
+//
+//   [session tee] ! queue leaky ! videoscale ! caps(tile size) ! appsink
+//
+// The appsink copies the (already small) tile into its cell of a shared
+// canvas. A compositor thread uploads the canvas to one CameraTexture at
+// |fps|, so a wall of N cameras costs one texture upload per refresh instead
+// of N. When recording, the same canvas is pushed into an appsrc pipeline
+// ending in a RecordHandler branch.
+class Mosaic {
+ public:
+  Mosaic(int mosaic_id,
+         FlTextureRegistrar* texture_registrar,
+         FlMethodChannel* method_channel,
+         const MosaicLayout& layout);
+  ~Mosaic();
+
+  int mosaic_id() const { return mosaic_id_; }
+  int64_t texture_id() const { return texture_id_; }
+  int width() const { return layout_.columns * layout_.tile_width; }
+  int height() const { return layout_.rows * layout_.tile_height; }
+
+  // Allocates the texture and registers it. Returns the texture_id on
+  // success, -1 on failure.
+  int64_t RegisterTexture();
+
+  // Attaches |session| to grid cell |index| (row-major) and starts the
+  // device if needed. Returns true on success; sets |error| on failure.
+  bool AddTile(int index, std::shared_ptr<CaptureSession> session,
+               GError** error);
+
+  // Starts the compositor thread.
+  void Start();
+
+  // Starts/stops recording the composed canvas. Stop responds to
+  // |method_call| asynchronously once the file is finalized, or with an
+  // error if the recording pipeline fails, times out or is disposed first.
+  void StartRecording(FlMethodCall* method_call);
+  void StopRecording(FlMethodCall* method_call);
+
+  // Stops the compositor, detaches every tile and releases all resources.
+  void Dispose();
+
+ private:
+  struct Tile {
+    Mosaic* mosaic;
+    int index;
+    std::shared_ptr<CaptureSession> session;
+    GstElement* branch;  // Owned (ref held while attached to session).
+  };
+
+  bool BuildRecordPipeline(GError** error);
+  void PushRecordFrame();
+
+  static GstFlowReturn OnTileSample(GstAppSink* sink, gpointer user_data);
+  static void OnTileMessage(GstMessage* msg, gpointer user_data);
+  // Watches the recording pipeline on the main thread.
+  static gboolean OnRecordBusMessage(GstBus* bus, GstMessage* msg,
+                                     gpointer user_data);
+  // Reports |description| as a mosaicError for |tile| (-1: the recording).
+  void SendError(int tile, const char* description);
+  static gpointer CompositorThread(gpointer user_data);
+
+  int mosaic_id_;
+  int64_t texture_id_;
+  MosaicLayout layout_;
+
+  FlTextureRegistrar* texture_registrar_;  // Not owned.
+  FlMethodChannel* method_channel_;        // Not owned.
+  CameraTexture* texture_;                 // Owned (GObject ref).
+  // Serves the canvas and the texture's frames.
+  std::shared_ptr<FrameAllocator> allocator_;
+
+  std::vector<std::unique_ptr<Tile>> tiles_;
+
+  // Tight RGBA canvas (width() * height() * 4). Tiles write their cell from
+  // their own streaming threads; the compositor reads the whole canvas.
+  uint8_t* canvas_;
+  size_t canvas_size_;
+  GMutex canvas_mutex_;
+  std::atomic<bool> canvas_dirty_;
+
+  GThread* compositor_thread_;
+  GMutex compositor_mutex_;
+  GCond compositor_cond_;
+  bool compositor_running_;  // Guarded by compositor_mutex_.
+
+  // Recording: appsrc ! tee, with the RecordHandler branch on the tee.
+  GstElement* record_pipeline_;
+  GstElement* record_src_;  // Owned by record_pipeline_.
+  GstElement* record_tee_;  // Owned by record_pipeline_.
+  guint record_bus_watch_id_;
+  std::unique_ptr<RecordHandler> record_handler_;
+  std::atomic<bool> recording_;
+  GstClockTime record_pts_;  // Only touched by the compositor thread.
+
+  bool disposed_;
+};
+
+#endif  // MOSAIC_H_
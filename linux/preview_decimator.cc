@@ -0,0 +1,27 @@
+#include "preview_decimator.h"
+
+namespace {
+
+const uint64_t kNsPerSecond = 1000000000;
+
+}  // namespace
+
+PreviewDecimator::PreviewDecimator(int capture_fps, int preview_fps)
+    : active_(preview_fps > 0 && capture_fps > preview_fps),
+      interval_ns_(preview_fps > 0 ? kNsPerSecond / preview_fps : 0),
+      half_period_ns_(capture_fps > 0 ? kNsPerSecond / (2 * capture_fps)
+                                      : 0) {}
+
+bool PreviewDecimator::ShouldUpdate(uint64_t pts_ns) {
+  if (!active_) return true;
+  // A slot further out than one interval means the timestamps started
+  // over; so does a first frame.
+  bool on_schedule = scheduled_ && next_ns_ <= pts_ns + interval_ns_;
+  if (on_schedule && pts_ns + half_period_ns_ < next_ns_) return false;
+  // After a gap, schedule from this frame rather than catch up.
+  next_ns_ = on_schedule && pts_ns < next_ns_ + interval_ns_
+                 ? next_ns_ + interval_ns_
+                 : pts_ns + interval_ns_;
+  scheduled_ = true;
+  return true;
+}
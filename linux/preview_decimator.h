@@ -0,0 +1,41 @@
+#ifndef PREVIEW_DECIMATOR_H_
+#define PREVIEW_DECIMATOR_H_
+
+#include <cstdint>
+
+// Picks the frames of a high-frame-rate camera that update its preview.
+//
+// A display shows at most |preview_fps| frames a second, so a camera
+// capturing faster updates its texture on a schedule of that rate; the
+// image stream and recording still get every frame. The schedule is kept in
+// capture time (buffer timestamps), so updates stay evenly spaced at any
+// capture rate: every other frame at 120 fps, two in three at 90. A frame
+// is due once it is within half a capture period of its slot. After a gap
+// the schedule restarts from the next frame instead of catching up, and a
+// timestamp that went backwards (a restarted pipeline) restarts it too.
+//
+// Streaming thread only.
+class PreviewDecimator {
+ public:
+  // Decimates only when |capture_fps| exceeds |preview_fps|.
+  PreviewDecimator(int capture_fps, int preview_fps);
+
+  bool active() const { return active_; }
+
+  // Returns whether the frame captured at |pts_ns| should update the
+  // preview, and if so books the next slot. Ask only for frames that would
+  // otherwise reach the texture. Always true while inactive.
+  bool ShouldUpdate(uint64_t pts_ns);
+
+  // Forgets the schedule; the next frame updates the preview.
+  void Reset() { scheduled_ = false; }
+
+ private:
+  bool active_;
+  uint64_t interval_ns_;     // Between preview updates.
+  uint64_t half_period_ns_;  // Half the capture period.
+  bool scheduled_ = false;
+  uint64_t next_ns_ = 0;  // Slot of the next update, while scheduled_.
+};
+
+#endif  // PREVIEW_DECIMATOR_H_
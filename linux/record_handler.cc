@@ -1,13 +1,21 @@
 #include "record_handler.h"
 
+#include <gst/video/video.h>
+
 #include <cstdio>
 
+#include "frame_trace.h"
+
 // H-5: Maximum recording queue size.
 // Bounds RAM consumed by the recording branch if the encoder falls behind
 // (e.g., during an antivirus scan or CPU spike). Backpressure will propagate
 // upstream rather than silently consuming all available memory.
+// The byte cap is RecordHandler::kDefaultQueueMaxBytes (256 MB), or lower
+// under a memory budget.
 static const guint64 kRecQueueMaxTimeNs = 3 * GST_SECOND;  // 3 s time limit
-static const guint kRecQueueMaxBytes = 256 * 1024 * 1024;  // 256 MB hard cap
+
+constexpr guint RecordHandler::kDefaultQueueMaxBytes;
+constexpr guint RecordHandler::kMinQueueMaxBytes;
 
 // Video encoder candidates in order of preference.
 static const char* kEncoderCandidates[] = {
@@ -48,34 +56,40 @@ RecordHandler::RecordHandler()
       pending_stop_call_(nullptr) {}
 
 RecordHandler::~RecordHandler() {
-  if (pending_stop_call_) {
-    g_object_unref(pending_stop_call_);
-    pending_stop_call_ = nullptr;
-  }
+  // The pipeline (and with it the valves) may already be gone.
+  FailPendingStop("Recording was discarded before it was finalized");
 }
 
-std::string RecordHandler::DetectEncoder() {
-  for (int i = 0; i < kNumEncoderCandidates; i++) {
-    GstElementFactory* factory =
-        gst_element_factory_find(kEncoderCandidates[i]);
+// Returns the first of |candidates| with a registered factory, or "".
+static const char* FindFactory(const char* const* candidates, int count) {
+  for (int i = 0; i < count; i++) {
+    GstElementFactory* factory = gst_element_factory_find(candidates[i]);
     if (factory) {
       gst_object_unref(factory);
-      return kEncoderCandidates[i];
+      return candidates[i];
     }
   }
   return "";
 }
 
+std::string RecordHandler::DetectEncoder() {
+  // The registry does not change while the app runs, so the probe happens
+  // once, normally during GstWarmup on its background thread.
+  static const char* encoder = nullptr;
+  if (g_once_init_enter(&encoder)) {
+    g_once_init_leave(&encoder,
+                      FindFactory(kEncoderCandidates, kNumEncoderCandidates));
+  }
+  return encoder;
+}
+
 std::string RecordHandler::DetectAudioEncoder() {
-  for (int i = 0; i < kNumAudioEncoderCandidates; i++) {
-    GstElementFactory* factory =
-        gst_element_factory_find(kAudioEncoderCandidates[i]);
-    if (factory) {
-      gst_object_unref(factory);
-      return kAudioEncoderCandidates[i];
-    }
+  static const char* encoder = nullptr;
+  if (g_once_init_enter(&encoder)) {
+    g_once_init_leave(&encoder, FindFactory(kAudioEncoderCandidates,
+                                            kNumAudioEncoderCandidates));
   }
-  return "";
+  return encoder;
 }
 
 bool RecordHandler::Setup(GstElement* pipeline, GstElement* tee,
@@ -123,13 +137,14 @@ bool RecordHandler::Setup(GstElement* pipeline, GstElement* tee,
   g_object_set(valve_, "drop", TRUE, nullptr);
 
   // H-5: bound the recording queue so the process cannot OOM if the encoder
-  // stalls. Use time-based limiting (3 s) plus a 256 MB hard cap.
+  // stalls. Use time-based limiting (3 s) plus a byte cap (256 MB unless a
+  // memory budget lowered it).
   // leaky=no means backpressure propagates upstream rather than silently
   // dropping frames, preserving recording integrity.
   g_object_set(queue_,
                "max-size-buffers", (guint)0,
                "max-size-time",    kRecQueueMaxTimeNs,
-               "max-size-bytes",   kRecQueueMaxBytes,
+               "max-size-bytes",   queue_max_bytes_,
                "leaky",            (gint)0,  // GST_QUEUE_NO_LEAK
                nullptr);
 
@@ -163,6 +178,23 @@ bool RecordHandler::Setup(GstElement* pipeline, GstElement* tee,
     return false;
   }
 
+  // Trace each frame's time inside the encoder. Input and output can be on
+  // different calls (the encoder may hold frames), so these are async
+  // events matched by PTS, salted with the encoder so two recordings of
+  // the same device do not collide.
+  GstPad* enc_sink = gst_element_get_static_pad(encoder_, "sink");
+  GstPad* enc_src = gst_element_get_static_pad(encoder_, "src");
+  if (enc_sink && enc_src) {
+    gst_pad_add_probe(enc_sink, GST_PAD_PROBE_TYPE_BUFFER,
+                      RecordHandler::OnEncoderBuffer,
+                      GINT_TO_POINTER(1), nullptr);
+    gst_pad_add_probe(enc_src, GST_PAD_PROBE_TYPE_BUFFER,
+                      RecordHandler::OnEncoderBuffer,
+                      GINT_TO_POINTER(0), nullptr);
+  }
+  if (enc_sink) gst_object_unref(enc_sink);
+  if (enc_src) gst_object_unref(enc_src);
+
   // Link tee to the recording queue.
   GstPad* tee_pad = gst_element_request_pad_simple(tee_, "src_%u");
   GstPad* queue_pad = gst_element_get_static_pad(queue_, "sink");
@@ -316,6 +348,58 @@ bool RecordHandler::StartRecording(const std::string& output_path,
   return true;
 }
 
+GstPadProbeReturn RecordHandler::OnEncoderBuffer(GstPad* pad,
+                                                 GstPadProbeInfo* info,
+                                                 gpointer user_data) {
+  if (!frame_trace::Enabled()) return GST_PAD_PROBE_OK;
+  GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+  if (!buffer || !GST_BUFFER_PTS_IS_VALID(buffer)) return GST_PAD_PROBE_OK;
+
+  GstElement* encoder = GST_PAD_PARENT(pad);
+  guint64 id = GST_BUFFER_PTS(buffer) ^ (guint64)(guintptr)encoder;
+  if (GPOINTER_TO_INT(user_data)) {
+    frame_trace::AsyncBegin("encode", id, 0);
+  } else {
+    frame_trace::AsyncEnd("encode", id);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+bool RecordHandler::GetQueueLevel(guint* buffers, guint64* time_ns) const {
+  if (!is_setup_ || !queue_) return false;
+  // The queue's level properties are read under its own lock.
+  g_object_get(queue_, "current-level-buffers", buffers,
+               "current-level-time", time_ns, nullptr);
+  return true;
+}
+
+void RecordHandler::SetQueueMaxBytes(guint bytes) {
+  if (bytes < kMinQueueMaxBytes) bytes = kMinQueueMaxBytes;
+  if (bytes == queue_max_bytes_) return;
+  queue_max_bytes_ = bytes;
+  if (queue_) g_object_set(queue_, "max-size-bytes", bytes, nullptr);
+}
+
+guint RecordHandler::GetQueueBytes() const {
+  if (!is_setup_ || !queue_) return 0;
+  guint bytes = 0;
+  g_object_get(queue_, "current-level-bytes", &bytes, nullptr);
+  return bytes;
+}
+
+bool RecordHandler::RequestKeyframe() {
+  if (!is_recording_ || !encoder_) return false;
+  // Upstream events enter at the encoder's source pad; the encoder emits a
+  // keyframe with the next frame it encodes.
+  GstPad* src_pad = gst_element_get_static_pad(encoder_, "src");
+  if (!src_pad) return false;
+  gboolean sent = gst_pad_send_event(
+      src_pad, gst_video_event_new_upstream_force_key_unit(
+                   GST_CLOCK_TIME_NONE, TRUE, 0));
+  gst_object_unref(src_pad);
+  return sent;
+}
+
 struct StopRecordingData {
   RecordHandler* handler;
   FlMethodCall* method_call;
@@ -338,6 +422,13 @@ GstPadProbeReturn RecordHandler::OnEosEvent(GstPad* pad,
   g_idle_add(
       [](gpointer user_data) -> gboolean {
         StopRecordingData* data = static_cast<StopRecordingData*>(user_data);
+        RecordHandler* handler = data->handler;
+        // Already answered if the stop timed out or was aborted.
+        if (handler->pending_stop_call_ != data->method_call) {
+          g_object_unref(data->method_call);
+          delete data;
+          return G_SOURCE_REMOVE;
+        }
 
         g_autoptr(FlValue) result = fl_value_new_map();
         fl_value_set_string_take(result, "path",
@@ -351,7 +442,8 @@ GstPadProbeReturn RecordHandler::OnEosEvent(GstPad* pad,
         fl_method_call_respond_success(data->method_call, result, nullptr);
         g_object_unref(data->method_call);
 
-        data->handler->is_recording_ = false;
+        handler->ClearPendingStop();
+        handler->is_recording_ = false;
         delete data;
         return G_SOURCE_REMOVE;
       },
@@ -367,6 +459,13 @@ void RecordHandler::StopRecording(FlMethodCall* method_call) {
                                  "No recording in progress", details, nullptr);
     return;
   }
+  if (pending_stop_call_) {
+    g_autoptr(FlValue) details = fl_value_new_null();
+    fl_method_call_respond_error(method_call, "stop_in_progress",
+                                 "The recording is already being stopped",
+                                 details, nullptr);
+    return;
+  }
 
   // Set up an EOS probe on the filesink's sink pad BEFORE sending EOS so we
   // don't miss the event.
@@ -384,6 +483,10 @@ void RecordHandler::StopRecording(FlMethodCall* method_call) {
     gst_pad_add_probe(filesink_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
                       RecordHandler::OnEosEvent, data, nullptr);
     gst_object_unref(filesink_pad);
+    // An encoder or muxer that fails never lets the EOS through.
+    pending_stop_call_ = FL_METHOD_CALL(g_object_ref(method_call));
+    stop_timeout_id_ =
+        g_timeout_add(kStopTimeoutMs, RecordHandler::OnStopTimeout, this);
   }
 
   // M-5 FIX: Send EOS to the valve's sink pad (not the encoder's sink pad).
@@ -433,3 +536,36 @@ void RecordHandler::StopRecording(FlMethodCall* method_call) {
     is_recording_ = false;
   }
 }
+
+gboolean RecordHandler::OnStopTimeout(gpointer user_data) {
+  RecordHandler* self = static_cast<RecordHandler*>(user_data);
+  self->stop_timeout_id_ = 0;
+  self->AbortRecording("Timed out finalizing the recording");
+  return G_SOURCE_REMOVE;
+}
+
+void RecordHandler::AbortRecording(const char* message) {
+  if (valve_) g_object_set(valve_, "drop", TRUE, nullptr);
+  if (audio_valve_) g_object_set(audio_valve_, "drop", TRUE, nullptr);
+  is_recording_ = false;
+  FailPendingStop(message);
+}
+
+void RecordHandler::FailPendingStop(const char* message) {
+  if (!pending_stop_call_) return;
+  g_autoptr(FlValue) details = fl_value_new_null();
+  fl_method_call_respond_error(pending_stop_call_, "recording_failed",
+                               message, details, nullptr);
+  ClearPendingStop();
+}
+
+void RecordHandler::ClearPendingStop() {
+  if (stop_timeout_id_ > 0) {
+    g_source_remove(stop_timeout_id_);
+    stop_timeout_id_ = 0;
+  }
+  if (pending_stop_call_) {
+    g_object_unref(pending_stop_call_);
+    pending_stop_call_ = nullptr;
+  }
+}
@@ -24,13 +24,15 @@ class RecordHandler {
 
   // Detects the best available H.264 encoder at runtime.
   // Returns the GStreamer element factory name, or empty string if none found.
+  // The result is cached after the first call.
   static std::string DetectEncoder();
 
-  // Detects the best available audio encoder at runtime.
+  // Detects the best available audio encoder at runtime (cached likewise).
   static std::string DetectAudioEncoder();
 
   // Sets up the recording branch and attaches it to the tee element.
-  // |tee| is the pipeline tee element to branch from.
+  // |pipeline| is the bin the recording elements are added to (the camera's
+  // branch of the shared capture session); |tee| is the tee inside it.
   // |width| and |height| are the video dimensions.
   // |fps| is the target frame rate.
   // |enable_audio| adds an audio source and encoder to the recording.
@@ -45,10 +47,37 @@ class RecordHandler {
 
   // Stops recording. Sends EOS through the recording branch and waits
   // for the file to be finalized. |method_call| is responded to
-  // asynchronously when the file is ready (or an error occurs).
+  // asynchronously when the file is ready, or with an error if that takes
+  // longer than kStopTimeoutMs or the recording is aborted meanwhile.
   void StopRecording(FlMethodCall* method_call);
 
+  // Gives up on the recording, e.g. after an error on the pipeline: closes
+  // the valves and answers a pending stop with a "recording_failed" error
+  // carrying |message|. Main thread only, while the pipeline is alive.
+  void AbortRecording(const char* message);
+
+  static constexpr guint kStopTimeoutMs = 10000;
+
   bool is_recording() const { return is_recording_; }
+
+  // Byte cap of the queue ahead of the encoder (H-5). A camera's memory
+  // budget may lower it, down to kMinQueueMaxBytes; a live queue picks the
+  // new cap up right away.
+  static constexpr guint kDefaultQueueMaxBytes = 256 * 1024 * 1024;
+  static constexpr guint kMinQueueMaxBytes = 16 * 1024 * 1024;
+  void SetQueueMaxBytes(guint bytes);
+  guint queue_max_bytes() const { return queue_max_bytes_; }
+
+  // Buffers and time currently waiting in the queue ahead of the encoder.
+  // Returns false (leaving the outputs untouched) if not set up.
+  bool GetQueueLevel(guint* buffers, guint64* time_ns) const;
+  // Bytes currently waiting in that queue; 0 if not set up.
+  guint GetQueueBytes() const;
+  // Asks the encoder to start a new GOP with its next frame, so a change of
+  // scene (a source switch) starts on a keyframe. Returns false when not
+  // recording.
+  bool RequestKeyframe();
+
   bool has_audio() const { return has_audio_; }
   const std::string& encoder_name() const { return encoder_name_; }
   const std::string& audio_encoder_name() const { return audio_encoder_name_; }
@@ -62,6 +91,14 @@ class RecordHandler {
  private:
   static GstPadProbeReturn OnEosEvent(GstPad* pad, GstPadProbeInfo* info,
                                       gpointer user_data);
+  static gboolean OnStopTimeout(gpointer user_data);
+  // Answers a pending stop with a "recording_failed" error.
+  void FailPendingStop(const char* message);
+  // Forgets the pending stop once it has been answered.
+  void ClearPendingStop();
+  // Frame-trace hook on the encoder pads; user_data is 1 on the sink pad.
+  static GstPadProbeReturn OnEncoderBuffer(GstPad* pad, GstPadProbeInfo* info,
+                                           gpointer user_data);
 
   bool SetupAudioBranch(int audio_bitrate, GError** error);
 
@@ -89,8 +126,10 @@ class RecordHandler {
   bool is_setup_;
   bool has_audio_;
   bool using_matroskamux_ = false;  // H-6: true when mp4mux was unavailable
+  guint queue_max_bytes_ = kDefaultQueueMaxBytes;
 
   FlMethodCall* pending_stop_call_;  // Pending stop response.
+  guint stop_timeout_id_ = 0;        // Fails the pending stop.
 };
 
 #endif  // RECORD_HANDLER_H_
@@ -0,0 +1,337 @@
+#include "source_switcher.h"
+
+#include <gio/gio.h>
+#include <gst/app/gstappsrc.h>
+
+#include <atomic>
+#include <utility>
+
+// How long a switch waits for the new device's first frame.
+static const guint kSwitchTimeoutMs = 5000;
+
+struct SourceSwitcher::Feed : std::enable_shared_from_this<Feed> {
+  SourceSwitcher* owner;  // Outlives the feed (owns it).
+  std::shared_ptr<CaptureSession> session;
+  GstElement* bin = nullptr;  // Holds a ref; attached to |session|.
+  // Owned by the switcher, which keeps them until after the feed is gone.
+  GstElement* appsrc = nullptr;
+  GstElement* selector = nullptr;
+  GstPad* bridge_pad = nullptr;
+
+  // Feed streaming thread only.
+  bool caps_set = false;
+  // Set with the first bridged frame, when the selector switches over.
+  std::atomic<bool> selected{false};
+};
+
+// A feed failure, deferred to its own main-loop turn: the bus dispatch that
+// reported it must not see the session it iterates go away.
+struct SourceSwitcher::FeedFailure {
+  std::weak_ptr<Feed> feed;
+  std::string error;
+};
+
+SourceSwitcher::SourceSwitcher(KeyframeCallback request_keyframe,
+                               ErrorCallback on_error)
+    : request_keyframe_(std::move(request_keyframe)),
+      on_error_(std::move(on_error)) {}
+
+SourceSwitcher::~SourceSwitcher() {
+  Reset();
+}
+
+bool SourceSwitcher::Bind(GstElement* branch, GError** error) {
+  Reset();
+  selector_ = gst_bin_get_by_name(GST_BIN(branch), "sel");
+  GstElement* queue = gst_bin_get_by_name(GST_BIN(branch), "branch_queue");
+  if (queue) {
+    GstPad* queue_src = gst_element_get_static_pad(queue, "src");
+    own_pad_ = gst_pad_get_peer(queue_src);
+    gst_object_unref(queue_src);
+    gst_object_unref(queue);
+  }
+  if (!selector_ || !own_pad_) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to find input-selector in camera branch");
+    Reset();
+    return false;
+  }
+  branch_ = branch;
+  return true;
+}
+
+void SourceSwitcher::Reset() {
+  if (pending_done_) Finish(false, "Camera was stopped during the switch");
+  DropFeed();
+  if (bridge_pad_) {
+    gst_object_unref(bridge_pad_);
+    bridge_pad_ = nullptr;
+  }
+  if (appsrc_) {
+    gst_object_unref(appsrc_);
+    appsrc_ = nullptr;
+  }
+  if (own_pad_) {
+    gst_object_unref(own_pad_);
+    own_pad_ = nullptr;
+  }
+  if (selector_) {
+    gst_object_unref(selector_);
+    selector_ = nullptr;
+  }
+  branch_ = nullptr;
+}
+
+std::string SourceSwitcher::feed_device() const {
+  return feed_ ? feed_->session->device_path() : std::string();
+}
+
+bool SourceSwitcher::EnsureAppSrc(GError** error) {
+  if (appsrc_) return true;
+
+  // The bridge input lives in the camera's branch, so it goes away with it.
+  // do-timestamp stamps each frame with this pipeline's running time on
+  // arrival; the leaky queue keeps a stalled branch from backing up into
+  // the feed's device.
+  GstElement* appsrc = gst_element_factory_make("appsrc", "bridge_src");
+  GstElement* queue = gst_element_factory_make("queue", "bridge_queue");
+  if (!appsrc || !queue) {
+    if (appsrc) gst_object_unref(appsrc);
+    if (queue) gst_object_unref(queue);
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to create source bridge elements");
+    return false;
+  }
+  g_object_set(appsrc, "is-live", TRUE, "format", GST_FORMAT_TIME,
+               "do-timestamp", TRUE, nullptr);
+  g_object_set(queue, "leaky", 2 /* downstream */, "max-size-buffers", 2,
+               "max-size-bytes", 0, "max-size-time", (guint64)0, nullptr);
+  gst_bin_add_many(GST_BIN(branch_), appsrc, queue, nullptr);
+
+  GstPad* bridge_pad = gst_element_request_pad_simple(selector_, "sink_%u");
+  GstPad* queue_src = gst_element_get_static_pad(queue, "src");
+  bool linked = bridge_pad && gst_element_link(appsrc, queue) &&
+                gst_pad_link(queue_src, bridge_pad) == GST_PAD_LINK_OK;
+  gst_object_unref(queue_src);
+  if (!linked || !gst_element_sync_state_with_parent(queue) ||
+      !gst_element_sync_state_with_parent(appsrc)) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "Failed to add source bridge to camera branch");
+    gst_element_set_state(appsrc, GST_STATE_NULL);
+    gst_element_set_state(queue, GST_STATE_NULL);
+    gst_bin_remove_many(GST_BIN(branch_), appsrc, queue, nullptr);
+    if (bridge_pad) {
+      gst_element_release_request_pad(selector_, bridge_pad);
+      gst_object_unref(bridge_pad);
+    }
+    return false;
+  }
+  appsrc_ = GST_ELEMENT(gst_object_ref(appsrc));
+  bridge_pad_ = bridge_pad;
+  return true;
+}
+
+void SourceSwitcher::SwitchTo(std::shared_ptr<CaptureSession> session,
+                              DoneCallback done) {
+  if (!selector_) {
+    done(false, "Camera is not running");
+    return;
+  }
+  if (pending_done_) {
+    done(false, "A camera switch is already in progress");
+    return;
+  }
+
+  // Back to the camera's own device, or first off the current feed.
+  if (feed_) {
+    SelectOwnInput();
+    DropFeed();
+    if (request_keyframe_) request_keyframe_();
+  }
+  if (!session) {
+    done(true, std::string());
+    return;
+  }
+
+  GError* error = nullptr;
+  if (!EnsureAppSrc(&error)) {
+    done(false, error->message);
+    g_error_free(error);
+    return;
+  }
+  // The caps the branch already runs with; the feed converts to exactly
+  // these.
+  GstCaps* caps = gst_pad_get_current_caps(own_pad_);
+  if (!caps) {
+    done(false, "Camera has not negotiated a format yet");
+    return;
+  }
+
+  // Element names must be unique within the feed session's pipeline.
+  static int feed_seq = 0;
+  gchar* name = g_strdup_printf("source_switch_%d", ++feed_seq);
+  GstElement* bin = gst_parse_bin_from_description(
+      "queue leaky=downstream max-size-buffers=2 "
+      "! videoconvert ! videoscale ! videorate "
+      "! capsfilter name=feed_caps "
+      "! appsink name=feed_sink max-buffers=2 drop=true sync=false",
+      TRUE, &error);
+  if (!bin) {
+    done(false, error ? error->message : "Failed to build camera feed");
+    if (error) g_error_free(error);
+    gst_caps_unref(caps);
+    g_free(name);
+    return;
+  }
+  gst_object_ref_sink(bin);
+  gst_object_set_name(GST_OBJECT(bin), name);
+  g_free(name);
+
+  GstElement* capsfilter = gst_bin_get_by_name(GST_BIN(bin), "feed_caps");
+  g_object_set(capsfilter, "caps", caps, nullptr);
+  gst_object_unref(capsfilter);
+  gst_caps_unref(caps);
+
+  auto feed = std::make_shared<Feed>();
+  feed->owner = this;
+  feed->session = std::move(session);
+  feed->bin = bin;
+  feed->appsrc = appsrc_;
+  feed->selector = selector_;
+  feed->bridge_pad = bridge_pad_;
+
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(bin), "feed_sink");
+  GstAppSinkCallbacks callbacks = {};
+  callbacks.new_sample = SourceSwitcher::OnFeedSample;
+  gst_app_sink_set_callbacks(GST_APP_SINK(sink), &callbacks, feed.get(),
+                             nullptr);
+  gst_object_unref(sink);
+
+  // Starts the new device if nothing else is streaming it yet.
+  if (!feed->session->AttachBranch(bin, SourceSwitcher::OnFeedMessage,
+                                   feed.get(), &error)) {
+    done(false, error ? error->message : "Failed to open the new camera");
+    if (error) g_error_free(error);
+    gst_object_unref(bin);
+    return;
+  }
+  feed_ = std::move(feed);
+  pending_done_ = std::move(done);
+  switch_timeout_id_ =
+      g_timeout_add(kSwitchTimeoutMs, SourceSwitcher::OnSwitchTimeout, this);
+}
+
+void SourceSwitcher::SelectOwnInput() {
+  if (selector_ && own_pad_) {
+    g_object_set(selector_, "active-pad", own_pad_, nullptr);
+  }
+}
+
+void SourceSwitcher::DropFeed() {
+  if (!feed_) return;
+  std::shared_ptr<Feed> feed = std::move(feed_);
+  // Blocks until the feed's streaming thread has left OnFeedSample. The
+  // session closes its device if the feed was its only branch.
+  feed->session->DetachBranch(feed->bin);
+  gst_object_unref(feed->bin);
+  feed->bin = nullptr;
+}
+
+void SourceSwitcher::Finish(bool success, const std::string& error) {
+  if (switch_timeout_id_ > 0) {
+    g_source_remove(switch_timeout_id_);
+    switch_timeout_id_ = 0;
+  }
+  DoneCallback done = std::move(pending_done_);
+  pending_done_ = nullptr;
+  if (success && request_keyframe_) request_keyframe_();
+  if (done) done(success, error);
+}
+
+void SourceSwitcher::OnFeedFailed(const std::string& error) {
+  bool switching = static_cast<bool>(pending_done_);
+  SelectOwnInput();
+  DropFeed();
+  if (switching) {
+    Finish(false, error);
+    return;
+  }
+  if (request_keyframe_) request_keyframe_();
+  if (on_error_) on_error_(error);
+}
+
+GstFlowReturn SourceSwitcher::OnFeedSample(GstAppSink* sink,
+                                           gpointer user_data) {
+  Feed* feed = static_cast<Feed*>(user_data);
+  GstSample* sample = gst_app_sink_pull_sample(sink);
+  if (!sample) return GST_FLOW_ERROR;
+
+  if (!feed->caps_set) {
+    gst_app_src_set_caps(GST_APP_SRC(feed->appsrc),
+                         gst_sample_get_caps(sample));
+    feed->caps_set = true;
+  }
+  // Shares the frame's memory. The feed's timestamps are on another
+  // pipeline's clock; cleared, appsrc restamps them on arrival.
+  GstBuffer* buffer = gst_buffer_copy(gst_sample_get_buffer(sample));
+  GST_BUFFER_PTS(buffer) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_DTS(buffer) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_DURATION(buffer) = GST_CLOCK_TIME_NONE;
+  gst_sample_unref(sample);
+  gst_app_src_push_buffer(GST_APP_SRC(feed->appsrc), buffer);
+
+  if (!feed->selected.exchange(true)) {
+    // Switch with the first frame in hand, so the branch does not idle
+    // between inputs.
+    g_object_set(feed->selector, "active-pad", feed->bridge_pad, nullptr);
+    g_idle_add_full(
+        G_PRIORITY_DEFAULT_IDLE, SourceSwitcher::OnFeedSelected,
+        new std::weak_ptr<Feed>(feed->shared_from_this()),
+        [](gpointer p) { delete static_cast<std::weak_ptr<Feed>*>(p); });
+  }
+  return GST_FLOW_OK;
+}
+
+void SourceSwitcher::OnFeedMessage(GstMessage* msg, gpointer user_data) {
+  Feed* feed = static_cast<Feed*>(user_data);
+  std::string error;
+  if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+    GError* err = nullptr;
+    gst_message_parse_error(msg, &err, nullptr);
+    error = err ? err->message : "Camera feed failed";
+    if (err) g_error_free(err);
+  } else if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS) {
+    error = "Camera stream ended unexpectedly";
+  } else {
+    return;
+  }
+  g_idle_add_full(
+      G_PRIORITY_DEFAULT,
+      [](gpointer p) -> gboolean {
+        auto* failure = static_cast<FeedFailure*>(p);
+        if (auto feed = failure->feed.lock()) {
+          feed->owner->OnFeedFailed(failure->error);
+        }
+        return G_SOURCE_REMOVE;
+      },
+      new FeedFailure{feed->shared_from_this(), error},
+      [](gpointer p) { delete static_cast<FeedFailure*>(p); });
+}
+
+gboolean SourceSwitcher::OnFeedSelected(gpointer user_data) {
+  auto* weak = static_cast<std::weak_ptr<Feed>*>(user_data);
+  if (auto feed = weak->lock()) {
+    SourceSwitcher* self = feed->owner;
+    if (self->pending_done_) self->Finish(true, std::string());
+  }
+  return G_SOURCE_REMOVE;
+}
+
+gboolean SourceSwitcher::OnSwitchTimeout(gpointer user_data) {
+  SourceSwitcher* self = static_cast<SourceSwitcher*>(user_data);
+  self->switch_timeout_id_ = 0;
+  self->SelectOwnInput();
+  self->DropFeed();
+  self->Finish(false, "Timed out waiting for frames from the new camera");
+  return G_SOURCE_REMOVE;
+}
@@ -0,0 +1,105 @@
+#ifndef SOURCE_SWITCHER_H_
+#define SOURCE_SWITCHER_H_
+
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "capture_session.h"
+
+// Moves a camera onto another device without touching anything downstream
+// of its input, so a recording carries on into the same file
+// (setDescriptionWhileRecording).
+//
+// Every camera branch has an input-selector right behind its input queue.
+// A switch attaches a small feed branch to the new device's CaptureSession
+// and bridges its frames into the camera's pipeline through an appsrc on a
+// second selector pad:
+//
+//   [own session tee] ! queue ! input-selector ! videoscale ! ... ! tee
+//   appsrc ! queue ! -------------/
+//   [new session tee] ! queue ! videoconvert ! videoscale ! videorate
+//       ! <caps of the branch input> ! appsink  -> appsrc
+//
+// The feed converts to exactly the caps the branch already runs with, so
+// nothing downstream renegotiates and the encoder and muxer keep going. The
+// appsrc restamps frames on the camera pipeline's clock. With the first
+// bridged frame the selector switches over and the encoder is asked for a
+// keyframe, so the new scene starts on a clean GOP; the switch costs the
+// frames in flight on the old input.
+//
+// The camera's own device keeps streaming underneath, because the branch
+// (and the recording) lives in its pipeline. Switching back re-selects the
+// original pad and drops the feed.
+//
+// All methods run on the main thread.
+class SourceSwitcher {
+ public:
+  // Outcome of SwitchTo, on the main thread: success, or an error message.
+  using DoneCallback =
+      std::function<void(bool success, const std::string& error)>;
+  // Asks the encoder for a keyframe after every completed switch.
+  using KeyframeCallback = std::function<void()>;
+  // A feed failed after its switch completed. The switcher has already gone
+  // back to the camera's own device.
+  using ErrorCallback = std::function<void(const std::string& error)>;
+
+  SourceSwitcher(KeyframeCallback request_keyframe, ErrorCallback on_error);
+  ~SourceSwitcher();
+
+  SourceSwitcher(const SourceSwitcher&) = delete;
+  SourceSwitcher& operator=(const SourceSwitcher&) = delete;
+
+  // Binds to the input-selector named "sel" in |branch|. Call once the
+  // branch is built.
+  bool Bind(GstElement* branch, GError** error);
+
+  // Starts bridging |session|'s frames into the branch; |done| runs once the
+  // first of them is selected, or on failure (after which the camera stays
+  // on its current input). A null |session| goes back to the camera's own
+  // device right away.
+  void SwitchTo(std::shared_ptr<CaptureSession> session, DoneCallback done);
+
+  // Drops any feed and unbinds, failing a pending switch. Must run before
+  // the branch is detached from its session.
+  void Reset();
+
+  // Device path of the bridged device, or empty on the camera's own input.
+  std::string feed_device() const;
+
+ private:
+  struct Feed;
+  struct FeedFailure;
+
+  bool EnsureAppSrc(GError** error);
+  void SelectOwnInput();
+  void DropFeed();
+  void Finish(bool success, const std::string& error);
+  void OnFeedFailed(const std::string& error);
+
+  // Feed callbacks (user_data = Feed*, or a std::weak_ptr<Feed> for the
+  // deferred ones). OnFeedSample runs on the feed session's streaming
+  // thread; the others on the main thread.
+  static GstFlowReturn OnFeedSample(GstAppSink* sink, gpointer user_data);
+  static void OnFeedMessage(GstMessage* msg, gpointer user_data);
+  static gboolean OnFeedSelected(gpointer user_data);
+  static gboolean OnSwitchTimeout(gpointer user_data);
+
+  KeyframeCallback request_keyframe_;
+  ErrorCallback on_error_;
+
+  GstElement* branch_ = nullptr;      // Not owned.
+  GstElement* selector_ = nullptr;    // Holds a ref.
+  GstPad* own_pad_ = nullptr;         // Selector pad of the own input (ref).
+  GstElement* appsrc_ = nullptr;      // Added on first switch (ref).
+  GstPad* bridge_pad_ = nullptr;      // Selector pad of the appsrc (ref).
+
+  std::shared_ptr<Feed> feed_;
+  DoneCallback pending_done_;
+  guint switch_timeout_id_ = 0;
+};
+
+#endif  // SOURCE_SWITCHER_H_
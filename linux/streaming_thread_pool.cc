@@ -0,0 +1,227 @@
+#include "streaming_thread_pool.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <vector>
+
+// Shared GstTaskPool for every capture pipeline.
+//
+// GStreamer's default pool creates threads on demand through a GThreadPool
+// and lets them float across all CPUs. With many cameras (each with a source,
+// branch, and encoder thread) that means a burst of thread creation on every
+// start and free migration between cores. This pool keeps a configurable set
+// of parked workers for reuse and can pin each worker to a CPU.
+//
+// Each pushed task gets a dedicated worker: either a parked one (reserved by
+// decrementing idle_workers under the lock, so two pushes can never claim
+// the same worker) or a freshly spawned one.
+
+// Parked workers kept by default: enough for one camera's source, branch
+// and encoder threads to restart without spawning.
+static const guint kDefaultWarmThreads = 4;
+
+namespace {
+
+struct Job {
+  GstTaskPoolFunction func;  // nullptr asks the worker to exit.
+  gpointer user_data;
+};
+
+}  // namespace
+
+struct _StreamingThreadPool {
+  GstTaskPool parent_instance;
+
+  GMutex mutex;
+  GAsyncQueue* jobs;      // Job* handed to parked workers.
+  guint idle_workers;     // Parked workers waiting on |jobs|.
+  guint warm_threads;     // Max parked workers to keep.
+  std::vector<int>* cpus;  // Pinning set; empty = unpinned.
+  guint next_cpu;
+  guint worker_seq;
+};
+
+G_DEFINE_TYPE(StreamingThreadPool, streaming_thread_pool,
+              gst_task_pool_get_type())
+
+namespace {
+
+struct WorkerStart {
+  StreamingThreadPool* pool;  // Holds a ref.
+  Job first_job;
+  int cpu;                    // -1 = unpinned.
+};
+
+void PinCurrentThread(int cpu) {
+  if (cpu < 0) return;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    g_warning("Failed to pin streaming thread to CPU %d", cpu);
+  }
+}
+
+gpointer WorkerMain(gpointer data) {
+  auto* start = static_cast<WorkerStart*>(data);
+  StreamingThreadPool* self = start->pool;
+  Job job = start->first_job;
+  PinCurrentThread(start->cpu);
+  delete start;
+
+  while (job.func) {
+    job.func(job.user_data);
+
+    g_mutex_lock(&self->mutex);
+    if (self->idle_workers >= self->warm_threads) {
+      g_mutex_unlock(&self->mutex);
+      break;
+    }
+    self->idle_workers++;
+    g_mutex_unlock(&self->mutex);
+
+    auto* next = static_cast<Job*>(g_async_queue_pop(self->jobs));
+    job = *next;
+    delete next;
+  }
+
+  gst_object_unref(self);
+  return nullptr;
+}
+
+}  // namespace
+
+static void streaming_thread_pool_prepare(GstTaskPool* pool, GError** error) {
+  // Workers are created lazily in push.
+}
+
+static void streaming_thread_pool_cleanup(GstTaskPool* pool) {
+  StreamingThreadPool* self = STREAMING_THREAD_POOL(pool);
+  // Release parked workers; busy ones exit once their task returns and they
+  // find the pool over its warm limit.
+  g_mutex_lock(&self->mutex);
+  guint idle = self->idle_workers;
+  self->idle_workers = 0;
+  self->warm_threads = 0;
+  g_mutex_unlock(&self->mutex);
+  for (guint i = 0; i < idle; i++) {
+    g_async_queue_push(self->jobs, new Job{nullptr, nullptr});
+  }
+}
+
+static gpointer streaming_thread_pool_push(GstTaskPool* pool,
+                                           GstTaskPoolFunction func,
+                                           gpointer user_data,
+                                           GError** error) {
+  StreamingThreadPool* self = STREAMING_THREAD_POOL(pool);
+
+  g_mutex_lock(&self->mutex);
+  if (self->idle_workers > 0) {
+    // Reserve one parked worker for this job.
+    self->idle_workers--;
+    g_mutex_unlock(&self->mutex);
+    g_async_queue_push(self->jobs, new Job{func, user_data});
+    return nullptr;
+  }
+
+  int cpu = -1;
+  if (!self->cpus->empty()) {
+    cpu = (*self->cpus)[self->next_cpu++ % self->cpus->size()];
+  }
+  guint seq = self->worker_seq++;
+  g_mutex_unlock(&self->mutex);
+
+  auto* start = new WorkerStart{
+      STREAMING_THREAD_POOL(gst_object_ref(self)), {func, user_data}, cpu};
+  gchar* name = g_strdup_printf("camstream-%u", seq);
+  GThread* thread = g_thread_try_new(name, WorkerMain, start, error);
+  g_free(name);
+  if (!thread) {
+    gst_object_unref(self);
+    delete start;
+    return nullptr;
+  }
+  g_thread_unref(thread);
+  // Streaming tasks are joined through their own GstTask lock; there is no
+  // per-job handle to wait on.
+  return nullptr;
+}
+
+static void streaming_thread_pool_join(GstTaskPool* pool, gpointer id) {}
+
+static void streaming_thread_pool_finalize(GObject* object) {
+  StreamingThreadPool* self = STREAMING_THREAD_POOL(object);
+  g_async_queue_unref(self->jobs);
+  delete self->cpus;
+  g_mutex_clear(&self->mutex);
+  G_OBJECT_CLASS(streaming_thread_pool_parent_class)->finalize(object);
+}
+
+static void streaming_thread_pool_class_init(StreamingThreadPoolClass* klass) {
+  G_OBJECT_CLASS(klass)->finalize = streaming_thread_pool_finalize;
+  GstTaskPoolClass* pool_class = GST_TASK_POOL_CLASS(klass);
+  pool_class->prepare = streaming_thread_pool_prepare;
+  pool_class->cleanup = streaming_thread_pool_cleanup;
+  pool_class->push = streaming_thread_pool_push;
+  pool_class->join = streaming_thread_pool_join;
+}
+
+static void streaming_thread_pool_init(StreamingThreadPool* self) {
+  g_mutex_init(&self->mutex);
+  self->jobs = g_async_queue_new();
+  self->idle_workers = 0;
+  self->warm_threads = kDefaultWarmThreads;
+  self->cpus = new std::vector<int>();
+  self->next_cpu = 0;
+  self->worker_seq = 0;
+}
+
+StreamingThreadPool* streaming_thread_pool_get_default(void) {
+  static StreamingThreadPool* pool = nullptr;
+  if (g_once_init_enter(&pool)) {
+    StreamingThreadPool* p = STREAMING_THREAD_POOL(
+        g_object_new(STREAMING_THREAD_POOL_TYPE, nullptr));
+    gst_object_ref_sink(p);
+    g_once_init_leave(&pool, p);
+  }
+  return pool;
+}
+
+void streaming_thread_pool_configure(StreamingThreadPool* self,
+                                     guint warm_threads,
+                                     const int* cpus,
+                                     guint n_cpus) {
+  g_return_if_fail(STREAMING_IS_THREAD_POOL(self));
+
+  g_mutex_lock(&self->mutex);
+  self->warm_threads = warm_threads;
+  self->cpus->assign(cpus, cpus + n_cpus);
+  self->next_cpu = 0;
+  // Shrink the parked set right away if the limit went down.
+  guint surplus = self->idle_workers > warm_threads
+                      ? self->idle_workers - warm_threads
+                      : 0;
+  self->idle_workers -= surplus;
+  g_mutex_unlock(&self->mutex);
+
+  for (guint i = 0; i < surplus; i++) {
+    g_async_queue_push(self->jobs, new Job{nullptr, nullptr});
+  }
+}
+
+void streaming_thread_pool_handle_message(StreamingThreadPool* self,
+                                          GstMessage* message) {
+  if (GST_MESSAGE_TYPE(message) != GST_MESSAGE_STREAM_STATUS) return;
+
+  GstStreamStatusType type;
+  GstElement* owner = nullptr;
+  gst_message_parse_stream_status(message, &type, &owner);
+  if (type != GST_STREAM_STATUS_TYPE_CREATE) return;
+
+  const GValue* value = gst_message_get_stream_status_object(message);
+  if (!value || G_VALUE_TYPE(value) != GST_TYPE_TASK) return;
+
+  GstTask* task = GST_TASK(g_value_get_object(value));
+  gst_task_set_pool(task, GST_TASK_POOL(self));
+}
@@ -0,0 +1,39 @@
+#ifndef STREAMING_THREAD_POOL_H_
+#define STREAMING_THREAD_POOL_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define STREAMING_THREAD_POOL_TYPE (streaming_thread_pool_get_type())
+G_DECLARE_FINAL_TYPE(StreamingThreadPool, streaming_thread_pool, STREAMING,
+                     THREAD_POOL, GstTaskPool)
+
+// Returns the process-wide pool shared by every capture pipeline. The
+// returned pointer is owned by the pool; do not unref it.
+StreamingThreadPool* streaming_thread_pool_get_default(void);
+
+// Configures how the pool runs streaming threads.
+//
+// |warm_threads| is the number of finished worker threads kept parked for
+// reuse, so pipelines started after a dispose (or a new camera) pick up an
+// existing thread instead of creating one. Streaming tasks are long-running
+// loops, so the pool always grows to one thread per active task; it never
+// queues a task behind another.
+//
+// |cpus| (|n_cpus| entries) lists the CPUs workers are pinned to, assigned
+// round-robin as workers start. Pass n_cpus == 0 to leave threads unpinned.
+// Only affects workers started after the call.
+void streaming_thread_pool_configure(StreamingThreadPool* self,
+                                     guint warm_threads,
+                                     const int* cpus,
+                                     guint n_cpus);
+
+// Hands the task announced by a GST_STREAM_STATUS_TYPE_CREATE message to
+// |self|. Call from a bus sync handler; other messages are ignored.
+void streaming_thread_pool_handle_message(StreamingThreadPool* self,
+                                          GstMessage* message);
+
+G_END_DECLS
+
+#endif  // STREAMING_THREAD_POOL_H_
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "device_enumerator.h"
+
+namespace camera_desktop {
+namespace test {
+
+namespace {
+
+// Modes of a typical industrial USB camera, sorted as EnumerateResolutions
+// returns them (largest first).
+std::vector<ResolutionInfo> IndustrialModes() {
+  return {{1920, 1080, 30},
+          {1280, 720, 60},
+          {640, 480, 240},
+          {320, 240, 240}};
+}
+
+}  // namespace
+
+TEST(SelectResolutionForFps, LargestWithinPreset) {
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectResolutionForFps(
+      IndustrialModes(), kHigh, 120, &selected));
+  EXPECT_EQ(selected.width, 640);
+  EXPECT_EQ(selected.height, 480);
+  EXPECT_EQ(selected.max_fps, 240);
+
+  ASSERT_TRUE(DeviceEnumerator::SelectResolutionForFps(
+      IndustrialModes(), kMax, 240, &selected));
+  EXPECT_EQ(selected.height, 480);
+}
+
+TEST(SelectResolutionForFps, HonoursPresetCeiling) {
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectResolutionForFps(
+      IndustrialModes(), kLow, 240, &selected));
+  EXPECT_EQ(selected.width, 320);
+  EXPECT_EQ(selected.height, 240);
+}
+
+TEST(SelectResolutionForFps, SmallestAboveCeilingAsFallback) {
+  std::vector<ResolutionInfo> modes = {
+      {1920, 1080, 120}, {1280, 720, 120}, {640, 480, 60}};
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectResolutionForFps(modes, kMedium, 120,
+                                                       &selected));
+  EXPECT_EQ(selected.width, 1280);
+  EXPECT_EQ(selected.height, 720);
+}
+
+TEST(SelectResolutionForFps, FailsWhenNoModeReachesRate) {
+  ResolutionInfo selected = {0, 0, 0};
+  EXPECT_FALSE(DeviceEnumerator::SelectResolutionForFps(
+      IndustrialModes(), kMax, 300, &selected));
+  EXPECT_FALSE(
+      DeviceEnumerator::SelectResolutionForFps({}, kMax, 90, &selected));
+  EXPECT_EQ(selected.width, 0);
+}
+
+TEST(SelectResolutionForFps, ExactRateSuffices) {
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectResolutionForFps(
+      IndustrialModes(), kVeryHigh, 60, &selected));
+  EXPECT_EQ(selected.height, 720);
+}
+
+// The request's own order: a thumbnail opens the device small, then the
+// main view joins at full size. The device grows to the main view's mode.
+TEST(SelectSharedFormat, MainViewAfterThumbnail) {
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectSharedFormat(
+      IndustrialModes(), {320, 240, 30}, {1920, 1080, 30}, &selected));
+  EXPECT_EQ(selected.width, 1920);
+  EXPECT_EQ(selected.height, 1080);
+  EXPECT_EQ(selected.max_fps, 30);
+}
+
+TEST(SelectSharedFormat, ThumbnailAfterMainViewKeepsFormat) {
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectSharedFormat(
+      IndustrialModes(), {1920, 1080, 30}, {320, 240, 15}, &selected));
+  EXPECT_EQ(selected.width, 1920);
+  EXPECT_EQ(selected.height, 1080);
+  EXPECT_EQ(selected.max_fps, 30);
+}
+
+TEST(SelectSharedFormat, SmallestModeCoveringSizeAndRate) {
+  // Neither covers the other: 720p at 60 fps takes the 720p mode.
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectSharedFormat(
+      IndustrialModes(), {320, 240, 60}, {1280, 720, 30}, &selected));
+  EXPECT_EQ(selected.width, 1280);
+  EXPECT_EQ(selected.height, 720);
+  EXPECT_EQ(selected.max_fps, 60);
+  // 480p at 120 fps: the VGA mode, not the larger 720p one.
+  ASSERT_TRUE(DeviceEnumerator::SelectSharedFormat(
+      IndustrialModes(), {320, 240, 120}, {640, 480, 30}, &selected));
+  EXPECT_EQ(selected.width, 640);
+  EXPECT_EQ(selected.max_fps, 120);
+}
+
+TEST(SelectSharedFormat, FailsWhenNoModeCoversBoth) {
+  ResolutionInfo selected = {0, 0, 0};
+  EXPECT_FALSE(DeviceEnumerator::SelectSharedFormat(
+      IndustrialModes(), {1920, 1080, 30}, {640, 480, 240}, &selected));
+  EXPECT_EQ(selected.width, 0);
+}
+
+TEST(SelectSharedFormat, CoveringRequestNeedsNoModes) {
+  ResolutionInfo selected;
+  ASSERT_TRUE(DeviceEnumerator::SelectSharedFormat({}, {640, 480, 15},
+                                                   {1280, 720, 30}, &selected));
+  EXPECT_EQ(selected.width, 1280);
+  EXPECT_EQ(selected.max_fps, 30);
+}
+
+}  // namespace test
+}  // namespace camera_desktop
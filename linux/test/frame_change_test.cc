@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_change.h"
+
+namespace camera_desktop {
+namespace test {
+
+namespace {
+
+// A copy: gtest takes its operands by reference, which would need an
+// out-of-class definition of the constant under C++14.
+const int kMaxDifference = FrameChangeDetector::kMaxDifference;
+
+// |height| rows of |width| opaque RGBA pixels of grey |value|, |stride|
+// bytes apart (tight when 0). Padding bytes hold |padding|.
+std::vector<uint8_t> MakeFrame(int width, int height, uint8_t value,
+                               size_t stride = 0, uint8_t padding = 0) {
+  if (stride == 0) stride = (size_t)width * 4;
+  std::vector<uint8_t> frame(stride * height, padding);
+  for (int y = 0; y < height; y++) {
+    uint8_t* row = frame.data() + y * stride;
+    for (int x = 0; x < width; x++) {
+      row[x * 4 + 0] = value;
+      row[x * 4 + 1] = value;
+      row[x * 4 + 2] = value;
+      row[x * 4 + 3] = 255;
+    }
+  }
+  return frame;
+}
+
+int Difference(FrameChangeDetector* detector,
+               const std::vector<uint8_t>& frame, int width, int height,
+               size_t stride = 0) {
+  return detector->Difference(frame.data(), width, height,
+                              stride ? stride : (size_t)width * 4);
+}
+
+}  // namespace
+
+TEST(FrameChangeDetector, FirstFrameIsAChange) {
+  FrameChangeDetector detector;
+  auto frame = MakeFrame(320, 240, 100);
+  EXPECT_EQ(Difference(&detector, frame, 320, 240), kMaxDifference);
+}
+
+TEST(FrameChangeDetector, ComparesWithCommittedFrame) {
+  FrameChangeDetector detector;
+  auto grey = MakeFrame(320, 240, 100);
+  Difference(&detector, grey, 320, 240);
+  detector.Commit();
+  EXPECT_EQ(Difference(&detector, grey, 320, 240), 0);
+
+  // Alpha is equal, so the mean over the colour channels is the step.
+  auto brighter = MakeFrame(320, 240, 130);
+  EXPECT_EQ(Difference(&detector, brighter, 320, 240), 30);
+}
+
+TEST(FrameChangeDetector, ReferenceStaysUntilCommit) {
+  FrameChangeDetector detector;
+  auto grey = MakeFrame(320, 240, 100);
+  Difference(&detector, grey, 320, 240);
+  detector.Commit();
+
+  // Frames that are compared but not committed leave the reference alone,
+  // so a slow drift adds up instead of passing one small step at a time.
+  for (uint8_t value = 101; value <= 110; value++) {
+    auto frame = MakeFrame(320, 240, value);
+    EXPECT_EQ(Difference(&detector, frame, 320, 240), value - 100);
+  }
+
+  auto drifted = MakeFrame(320, 240, 110);
+  Difference(&detector, drifted, 320, 240);
+  detector.Commit();
+  EXPECT_EQ(Difference(&detector, drifted, 320, 240), 0);
+  EXPECT_EQ(Difference(&detector, grey, 320, 240), 10);
+}
+
+TEST(FrameChangeDetector, CommitWithoutDifferenceKeepsReference) {
+  FrameChangeDetector detector;
+  auto grey = MakeFrame(320, 240, 100);
+  Difference(&detector, grey, 320, 240);
+  detector.Commit();
+  auto bright = MakeFrame(320, 240, 200);
+  Difference(&detector, bright, 320, 240);
+  detector.Commit();
+  // Nothing sampled since the last commit.
+  detector.Commit();
+  EXPECT_EQ(Difference(&detector, bright, 320, 240), 0);
+}
+
+TEST(FrameChangeDetector, UpdateComparesConsecutiveFrames) {
+  FrameChangeDetector detector;
+  auto a = MakeFrame(320, 240, 100);
+  auto b = MakeFrame(320, 240, 104);
+  EXPECT_EQ(detector.Update(a.data(), 320, 240, 320 * 4), kMaxDifference);
+  EXPECT_EQ(detector.Update(b.data(), 320, 240, 320 * 4), 4);
+  EXPECT_EQ(detector.Update(b.data(), 320, 240, 320 * 4), 0);
+}
+
+TEST(FrameChangeDetector, ResetForgetsReference) {
+  FrameChangeDetector detector;
+  auto grey = MakeFrame(320, 240, 100);
+  detector.Update(grey.data(), 320, 240, 320 * 4);
+  detector.Reset();
+  EXPECT_EQ(Difference(&detector, grey, 320, 240), kMaxDifference);
+  detector.Commit();
+  EXPECT_EQ(Difference(&detector, grey, 320, 240), 0);
+}
+
+TEST(FrameChangeDetector, SizeChangeIsAChange) {
+  FrameChangeDetector detector;
+  auto small = MakeFrame(320, 240, 100);
+  auto large = MakeFrame(640, 480, 100);
+  detector.Update(small.data(), 320, 240, 320 * 4);
+  EXPECT_EQ(Difference(&detector, large, 640, 480), kMaxDifference);
+  // Until committed, the reference keeps its own size.
+  EXPECT_EQ(Difference(&detector, small, 320, 240), 0);
+  Difference(&detector, large, 640, 480);
+  detector.Commit();
+  EXPECT_EQ(Difference(&detector, large, 640, 480), 0);
+}
+
+TEST(FrameChangeDetector, IgnoresRowPadding) {
+  FrameChangeDetector detector;
+  const size_t stride = 320 * 4 + 64;
+  auto padded = MakeFrame(320, 240, 100, stride, 0);
+  auto repadded = MakeFrame(320, 240, 100, stride, 255);
+  Difference(&detector, padded, 320, 240, stride);
+  detector.Commit();
+  EXPECT_EQ(Difference(&detector, repadded, 320, 240, stride), 0);
+}
+
+TEST(FrameChangeDetector, TooSmallFrameIsAChange) {
+  FrameChangeDetector detector;
+  auto tiny = MakeFrame(2, 2, 100);
+  EXPECT_EQ(Difference(&detector, tiny, 2, 2), kMaxDifference);
+  detector.Commit();
+  EXPECT_EQ(Difference(&detector, tiny, 2, 2), kMaxDifference);
+}
+
+}  // namespace test
+}  // namespace camera_desktop
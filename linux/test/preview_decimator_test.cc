@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "frame_change.h"
+#include "preview_decimator.h"
+
+namespace camera_desktop {
+namespace test {
+
+namespace {
+
+const uint64_t kSecondNs = 1000000000;
+
+// Timestamp of frame |index| at |fps|, starting at |start_ns|.
+uint64_t FramePts(int fps, int index, uint64_t start_ns = 0) {
+  return start_ns + index * kSecondNs / fps;
+}
+
+// Feeds |seconds| of frames at |fps| and returns the updates per second.
+double UpdateRate(PreviewDecimator* decimator, int fps, int seconds,
+                  uint64_t start_ns = 0) {
+  int updates = 0;
+  for (int i = 0; i < fps * seconds; i++) {
+    if (decimator->ShouldUpdate(FramePts(fps, i, start_ns))) updates++;
+  }
+  return static_cast<double>(updates) / seconds;
+}
+
+// Which of the first |count| frames at |fps| update the preview.
+std::vector<bool> Pattern(PreviewDecimator* decimator, int fps, int count) {
+  std::vector<bool> pattern;
+  for (int i = 0; i < count; i++) {
+    pattern.push_back(decimator->ShouldUpdate(FramePts(fps, i)));
+  }
+  return pattern;
+}
+
+}  // namespace
+
+TEST(PreviewDecimator, InactiveAtDisplayRate) {
+  for (int fps : {15, 30, 60}) {
+    PreviewDecimator decimator(fps, 60);
+    EXPECT_FALSE(decimator.active()) << fps;
+    EXPECT_DOUBLE_EQ(UpdateRate(&decimator, fps, 2), fps) << fps;
+  }
+}
+
+TEST(PreviewDecimator, HoldsDisplayRate) {
+  for (int fps : {61, 75, 90, 120, 144, 240}) {
+    PreviewDecimator decimator(fps, 60);
+    EXPECT_TRUE(decimator.active()) << fps;
+    EXPECT_NEAR(UpdateRate(&decimator, fps, 10), 60.0, 0.1) << fps;
+  }
+}
+
+TEST(PreviewDecimator, EveryOtherFrameAt120) {
+  PreviewDecimator decimator(120, 60);
+  std::vector<bool> expected;
+  for (int i = 0; i < 12; i++) expected.push_back(i % 2 == 0);
+  EXPECT_EQ(Pattern(&decimator, 120, 12), expected);
+}
+
+TEST(PreviewDecimator, EveryFourthFrameAt240) {
+  PreviewDecimator decimator(240, 60);
+  std::vector<bool> expected;
+  for (int i = 0; i < 16; i++) expected.push_back(i % 4 == 0);
+  EXPECT_EQ(Pattern(&decimator, 240, 16), expected);
+}
+
+TEST(PreviewDecimator, TwoInThreeAt90) {
+  PreviewDecimator decimator(90, 60);
+  std::vector<bool> pattern = Pattern(&decimator, 90, 90);
+  // Evenly spread: never two frames left out in a row, and two updates
+  // in every three frames.
+  for (size_t i = 0; i + 2 < pattern.size(); i += 3) {
+    int updates = pattern[i] + pattern[i + 1] + pattern[i + 2];
+    EXPECT_EQ(updates, 2) << "frames " << i << "-" << i + 2;
+  }
+  for (size_t i = 0; i + 1 < pattern.size(); i++) {
+    EXPECT_TRUE(pattern[i] || pattern[i + 1]) << "frames " << i << "-"
+                                              << i + 1;
+  }
+}
+
+TEST(PreviewDecimator, RestartsWithTimestamps) {
+  PreviewDecimator decimator(240, 60);
+  UpdateRate(&decimator, 240, 10, 3600 * kSecondNs);
+  // A restarted pipeline starts its running time over: the first frame
+  // updates, and the rate holds from there.
+  EXPECT_TRUE(decimator.ShouldUpdate(0));
+  EXPECT_FALSE(decimator.ShouldUpdate(FramePts(240, 1)));
+  EXPECT_NEAR(UpdateRate(&decimator, 240, 5, FramePts(240, 2)), 60.0, 0.2);
+}
+
+TEST(PreviewDecimator, DoesNotCatchUpAfterGap) {
+  PreviewDecimator decimator(120, 60);
+  EXPECT_TRUE(decimator.ShouldUpdate(0));
+  // Nothing for a second (say, frames withheld upstream), then the usual
+  // cadence: the first frame back updates, the next is left out again.
+  uint64_t resume_ns = kSecondNs;
+  EXPECT_TRUE(decimator.ShouldUpdate(resume_ns));
+  EXPECT_FALSE(decimator.ShouldUpdate(resume_ns + FramePts(120, 1)));
+  EXPECT_TRUE(decimator.ShouldUpdate(resume_ns + FramePts(120, 2)));
+}
+
+TEST(PreviewDecimator, ResetUpdatesNextFrame) {
+  PreviewDecimator decimator(240, 60);
+  EXPECT_TRUE(decimator.ShouldUpdate(FramePts(240, 0)));
+  EXPECT_FALSE(decimator.ShouldUpdate(FramePts(240, 1)));
+  decimator.Reset();
+  EXPECT_TRUE(decimator.ShouldUpdate(FramePts(240, 2)));
+  EXPECT_FALSE(decimator.ShouldUpdate(FramePts(240, 3)));
+}
+
+// The order Camera::OnNewSample runs them in, with static-frame skipping
+// on: the detector compares, the decimator picks, and only a frame that
+// reaches the texture becomes the reference.
+TEST(PreviewDecimator, DecimatedChangeReachesPreview) {
+  const int kWidth = 64;
+  const int kHeight = 48;
+  const size_t kStride = kWidth * 4;
+  // A moving scene for six frames, then a still one from frame 6, which
+  // falls between preview slots.
+  std::vector<std::vector<uint8_t>> frames;
+  for (int i = 0; i < 24; i++) {
+    frames.emplace_back(kStride * kHeight, i < 6 ? 20 * i : 200);
+  }
+  FrameChangeDetector detector;
+  PreviewDecimator decimator(240, 60);
+  int shown = -1;  // Grey level on the texture.
+
+  for (int i = 0; i < 24; i++) {
+    const uint8_t* frame = frames[i].data();
+    bool changed = detector.Difference(frame, kWidth, kHeight, kStride) > 0;
+    bool update = changed && decimator.ShouldUpdate(FramePts(240, i));
+    if (i == 6) {
+      EXPECT_FALSE(update);
+    }
+    if (update) {
+      detector.Commit();
+      shown = frame[0];
+    }
+  }
+  // Had the decimated frame become the reference, the still frames after
+  // it would all count as unchanged and the preview would stay on frame 4.
+  EXPECT_EQ(shown, 200);
+  EXPECT_EQ(detector.Difference(frames.back().data(), kWidth, kHeight,
+                                kStride),
+            0);
+}
+
+}  // namespace test
+}  // namespace camera_desktop
@@ -0,0 +1,144 @@
+#include "thread_scheduling.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+// Nice value used when SCHED_FIFO is refused: the highest boost an
+// unprivileged user is commonly granted via RLIMIT_NICE on desktop distros.
+static const int kFifoFallbackNice = -10;
+
+namespace {
+
+// Nice values outside [-20, 19] are clamped by setpriority; clamp first
+// so the value reported is the one applied.
+int ClampNice(int nice) { return std::max(-20, std::min(19, nice)); }
+
+// |nice| must already be clamped.
+bool SetNice(pid_t tid, int nice, std::string* error) {
+  if (setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) != 0) {
+    if (error) {
+      *error += "nice " + std::to_string(nice) + ": " + strerror(errno) + "; ";
+    }
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+pid_t CurrentThreadId() {
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+std::string ApplyThreadSchedule(pid_t tid, const ThreadSchedule& schedule,
+                                std::string* error) {
+  std::string applied;
+
+  switch (schedule.policy) {
+    case ThreadSchedule::Policy::kDefault:
+      applied = "default";
+      break;
+
+    case ThreadSchedule::Policy::kNice: {
+      // Drop out of a real-time class first; nice only applies to
+      // SCHED_OTHER threads.
+      struct sched_param param = {};
+      sched_setscheduler(tid, SCHED_OTHER, &param);
+      int nice = ClampNice(schedule.priority);
+      if (SetNice(tid, nice, error)) {
+        applied = "nice:" + std::to_string(nice);
+      } else {
+        applied = "default";
+      }
+      break;
+    }
+
+    case ThreadSchedule::Policy::kFifo: {
+      struct sched_param param = {};
+      param.sched_priority = std::max(
+          sched_get_priority_min(SCHED_FIFO),
+          std::min(sched_get_priority_max(SCHED_FIFO), schedule.priority));
+      if (sched_setscheduler(tid, SCHED_FIFO, &param) == 0) {
+        applied = "fifo:" + std::to_string(param.sched_priority);
+        break;
+      }
+      // Saved before the fallback's setpriority can overwrite it.
+      int fifo_errno = errno;
+      std::string fallback_error;
+      if (fifo_errno == EPERM &&
+          SetNice(tid, kFifoFallbackNice, &fallback_error)) {
+        applied = "nice:" + std::to_string(kFifoFallbackNice) +
+                  " (fifo denied)";
+        break;
+      }
+      if (error) {
+        *error += std::string("fifo: ") + strerror(fifo_errno) + "; " +
+                  fallback_error;
+      }
+      applied = "default";
+      break;
+    }
+  }
+
+  if (!schedule.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : schedule.cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(tid, sizeof(set), &set) == 0) {
+      applied += " cpus:";
+      for (size_t i = 0; i < schedule.cpus.size(); i++) {
+        if (i > 0) applied += ",";
+        applied += std::to_string(schedule.cpus[i]);
+      }
+    } else if (error) {
+      *error += std::string("affinity: ") + strerror(errno) + "; ";
+    }
+  }
+
+  return applied;
+}
+
+SavedThreadSchedule SaveThreadSchedule(pid_t tid) {
+  SavedThreadSchedule saved;
+  saved.policy = sched_getscheduler(tid);
+  if (saved.policy < 0) saved.policy = SCHED_OTHER;
+  struct sched_param param = {};
+  if (sched_getparam(tid, &param) == 0) {
+    saved.rt_priority = param.sched_priority;
+  }
+  errno = 0;
+  saved.nice = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+  if (errno != 0) saved.nice = 0;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(tid, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) saved.cpus.push_back(cpu);
+    }
+  }
+  return saved;
+}
+
+void RestoreThreadSchedule(pid_t tid, const SavedThreadSchedule& saved) {
+  struct sched_param param = {};
+  param.sched_priority = saved.rt_priority;
+  sched_setscheduler(tid, saved.policy, &param);
+  // Going back to a lower nice value can be refused for unprivileged users
+  // after a positive nice was applied; the thread then stays deprioritized
+  // until it exits.
+  setpriority(PRIO_PROCESS, static_cast<id_t>(tid), saved.nice);
+  if (!saved.cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : saved.cpus) CPU_SET(cpu, &set);
+    sched_setaffinity(tid, sizeof(set), &set);
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef THREAD_SCHEDULING_H_
+#define THREAD_SCHEDULING_H_
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+// Scheduling applied to one class of streaming thread.
+struct ThreadSchedule {
+  enum class Policy {
+    kDefault,  // Leave the thread as created (SCHED_OTHER, nice 0).
+    kNice,     // SCHED_OTHER with |priority| as the nice value (-20..19).
+    kFifo,     // SCHED_FIFO with |priority| (1..99). Needs CAP_SYS_NICE or
+               // an RLIMIT_RTPRIO grant; falls back to nice -10 without.
+  };
+
+  Policy policy = Policy::kDefault;
+  int priority = 0;
+  std::vector<int> cpus;  // Affinity set; empty = inherit.
+
+  bool is_default() const {
+    return policy == Policy::kDefault && cpus.empty();
+  }
+};
+
+// The streaming threads a camera owns, by the work they do:
+//   capture - the source thread (v4l2src + shared videoconvert).
+//   convert - the camera branch thread (scale, mirror, texture copy).
+//   encode  - the recording queue thread (convert, encoder, muxer).
+enum class ThreadRole { kCapture, kConvert, kEncode };
+
+struct CameraThreadSchedule {
+  ThreadSchedule capture;
+  ThreadSchedule convert;
+  ThreadSchedule encode;
+
+  const ThreadSchedule& ForRole(ThreadRole role) const {
+    switch (role) {
+      case ThreadRole::kCapture:
+        return capture;
+      case ThreadRole::kConvert:
+        return convert;
+      case ThreadRole::kEncode:
+        return encode;
+    }
+    return capture;
+  }
+};
+
+// Returns the kernel thread id of the calling thread.
+pid_t CurrentThreadId();
+
+// Applies |schedule| to thread |tid| (any thread in this process).
+// Returns a short description of what took effect (e.g. "fifo:50",
+// "nice:-10 (fifo denied)") and fills |error| for parts that failed
+// outright. A default schedule is a no-op and returns "default".
+std::string ApplyThreadSchedule(pid_t tid, const ThreadSchedule& schedule,
+                                std::string* error);
+
+// Scheduling state captured from a thread before a streaming task changes
+// it. Pooled threads outlive their task and must not keep a camera's
+// priority, so the state is put back when the task leaves the thread or its
+// camera goes away.
+struct SavedThreadSchedule {
+  int policy = 0;
+  int rt_priority = 0;
+  int nice = 0;
+  std::vector<int> cpus;
+};
+
+SavedThreadSchedule SaveThreadSchedule(pid_t tid);
+void RestoreThreadSchedule(pid_t tid, const SavedThreadSchedule& saved);
+
+#endif  // THREAD_SCHEDULING_H_
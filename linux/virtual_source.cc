@@ -0,0 +1,141 @@
+#include "virtual_source.h"
+
+#include <glib.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "capture_session.h"
+
+static const char kTestScheme[] = "test://";
+static const char kFileScheme[] = "file://";
+
+namespace {
+
+// Splits the query string of |uri| (after '?') into |params|, unescaping
+// values. |uri| is cut back to the part before the '?'.
+void SplitQuery(std::string* uri,
+                std::vector<std::pair<std::string, std::string>>* params) {
+  size_t q = uri->find('?');
+  if (q == std::string::npos) return;
+  gchar** pairs = g_strsplit(uri->c_str() + q + 1, "&", -1);
+  for (gchar** p = pairs; *p; p++) {
+    if (**p == '\0') continue;
+    gchar** kv = g_strsplit(*p, "=", 2);
+    gchar* value = kv[1] ? g_uri_unescape_string(kv[1], nullptr) : nullptr;
+    params->emplace_back(kv[0], value ? value : "");
+    g_free(value);
+    g_strfreev(kv);
+  }
+  g_strfreev(pairs);
+  uri->resize(q);
+}
+
+bool ParseInt(const std::string& text, int min, int max, int* out) {
+  char* end = nullptr;
+  long v = strtol(text.c_str(), &end, 10);
+  if (text.empty() || *end != '\0' || v < min || v > max) return false;
+  *out = static_cast<int>(v);
+  return true;
+}
+
+// Pattern names go into a pipeline description, so only plain identifiers
+// are accepted (videotestsrc's nicks, e.g. "smpte", "ball", "snow").
+bool IsPatternName(const std::string& name) {
+  if (name.empty()) return false;
+  for (char c : name) {
+    if (!g_ascii_isalnum(c) && c != '-') return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool IsVirtualSourceUri(const std::string& uri) {
+  return g_str_has_prefix(uri.c_str(), kTestScheme) ||
+         g_str_has_prefix(uri.c_str(), kFileScheme);
+}
+
+bool ParseVirtualSourceUri(const std::string& uri, VirtualSource* source,
+                           std::string* error) {
+  std::string base = uri;
+  std::vector<std::pair<std::string, std::string>> params;
+  SplitQuery(&base, &params);
+
+  if (g_str_has_prefix(base.c_str(), kTestScheme)) {
+    std::string pattern = "smpte";
+    for (const auto& param : params) {
+      bool ok = true;
+      if (param.first == "w") {
+        ok = ParseInt(param.second, 16, 7680, &source->width);
+      } else if (param.first == "h") {
+        ok = ParseInt(param.second, 16, 4320, &source->height);
+      } else if (param.first == "fps") {
+        ok = ParseInt(param.second, 1, kMaxCaptureFps, &source->fps);
+      } else if (param.first == "pattern") {
+        ok = IsPatternName(param.second);
+        pattern = param.second;
+      } else {
+        *error = "Unknown test source parameter: " + param.first;
+        return false;
+      }
+      if (!ok) {
+        *error = "Invalid value for " + param.first + ": " + param.second;
+        return false;
+      }
+    }
+    // is-live makes the source produce frames at the negotiated rate, like
+    // a device, instead of as fast as downstream accepts them.
+    source->description = "videotestsrc is-live=true pattern=" + pattern;
+    source->loop = false;
+    return true;
+  }
+
+  if (g_str_has_prefix(base.c_str(), kFileScheme)) {
+    source->loop = true;
+    for (const auto& param : params) {
+      if (param.first == "loop") {
+        source->loop = param.second != "false" && param.second != "0";
+      } else {
+        *error = "Unknown file source parameter: " + param.first;
+        return false;
+      }
+    }
+
+    GError* uri_error = nullptr;
+    gchar* path = g_filename_from_uri(base.c_str(), nullptr, &uri_error);
+    if (!path) {
+      *error = uri_error ? uri_error->message : "Invalid file URI";
+      if (uri_error) g_error_free(uri_error);
+      return false;
+    }
+    if (!g_file_test(path, G_FILE_TEST_IS_REGULAR)) {
+      *error = std::string("File not found: ") + path;
+      g_free(path);
+      return false;
+    }
+    // The path is quoted in a pipeline description; refuse characters that
+    // would end the quoted string.
+    if (strpbrk(path, "\"\\")) {
+      *error = "Unsupported characters in file path";
+      g_free(path);
+      return false;
+    }
+
+    // videoscale/videorate adapt the file to the session caps; clocksync
+    // releases frames at their timestamps, as a camera would deliver them.
+    gchar* description = g_strdup_printf(
+        "filesrc location=\"%s\" ! decodebin ! videoscale ! videorate "
+        "! clocksync",
+        path);
+    source->description = description;
+    g_free(description);
+    g_free(path);
+    return true;
+  }
+
+  *error = "Unsupported source URI: " + uri;
+  return false;
+}
@@ -0,0 +1,33 @@
+#ifndef VIRTUAL_SOURCE_H_
+#define VIRTUAL_SOURCE_H_
+
+#include <string>
+
+// A frame source that stands in for a V4L2 device, selected by URI:
+//
+//   test://pattern?w=1280&h=720&fps=30&pattern=ball
+//       Live videotestsrc. Every parameter is optional; the size falls back
+//       to the resolution preset and the frame rate to the requested fps.
+//       The rate is limited to kMaxCaptureFps, like a device's.
+//   file:///path/to/clip.mkv?loop=false
+//       Decoded media file, paced to real time and looping unless loop=false.
+//
+// Only the source changes; conversion, the tee and every camera branch are
+// the same as for a device.
+struct VirtualSource {
+  std::string description;  // Source elements for CameraConfig::source.
+  int width = 0;            // 0 = not specified by the URI.
+  int height = 0;
+  int fps = 0;
+  bool loop = false;
+};
+
+// True if |uri| names a virtual source rather than a device path.
+bool IsVirtualSourceUri(const std::string& uri);
+
+// Parses |uri| into |source|. Returns false and fills |error| for an unknown
+// scheme, a bad parameter or a file that does not exist.
+bool ParseVirtualSourceUri(const std::string& uri, VirtualSource* source,
+                           std::string* error);
+
+#endif  // VIRTUAL_SOURCE_H_
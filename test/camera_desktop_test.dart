@@ -33,13 +33,69 @@ void main() {
               case 'create':
                 return {'cameraId': 1, 'textureId': 42};
               case 'initialize':
-                return {'previewWidth': 1280.0, 'previewHeight': 720.0};
+                return {
+                  'previewWidth': 1280.0,
+                  'previewHeight': 720.0,
+                  'startup': {
+                    'gstInitUs': 41000,
+                    'enumerateUs': 2500,
+                    'parseUs': 1800,
+                    'stateChangeUs': 95000,
+                    'firstFrameUs': 180000,
+                    'initializeTotalUs': 181200,
+                    'sessionReused': false,
+                  },
+                };
               case 'takePicture':
                 return '/tmp/test.jpg';
               case 'startVideoRecording':
                 return null;
               case 'stopVideoRecording':
                 return {'path': '/tmp/test_video.mp4', 'framesDropped': 0};
+              case 'createMosaic':
+                return {
+                  'mosaicId': 3,
+                  'textureId': 43,
+                  'width': 640,
+                  'height': 240,
+                };
+              case 'getCameraStats':
+                return {
+                  'cameraId': 1,
+                  'framesCaptured': 120,
+                  'framesPreviewUpdated': 118,
+                  'framesAppsinkDropped': 2,
+                  'framesStreamed': 0,
+                  'framesStreamSkipped': 0,
+                  'captureFps': 30.0,
+                  'previewFps': 29.5,
+                  'copyTime': {
+                    'count': 118,
+                    'meanUs': 410.0,
+                    'p50Us': 511,
+                    'p99Us': 1023,
+                    'maxUs': 900,
+                    'log2Buckets': [0, 0, 0, 0, 0, 0, 0, 0, 100, 18],
+                  },
+                  'frameMemoryBytes': 3686400,
+                  'frameBufferAllocations': 3,
+                  'frameBufferReuses': 118,
+                  'framesPreviewDecimated': 0,
+                };
+              case 'getMemoryUsage':
+                return {
+                  'cameraId': 1,
+                  'texture': 66355200,
+                  'imageStream': 0,
+                  'inFlight': 0,
+                  'recycled': 0,
+                  'recordingQueue': 4096,
+                  'recordingQueueLimit': 16777216,
+                  'total': 66359296,
+                  'budget': 80000000,
+                  'degradations': ['recordingQueue', 'doubleBuffer'],
+                };
+              case 'prepare':
               case 'startImageStream':
               case 'stopImageStream':
               case 'dispose':
@@ -83,6 +139,23 @@ void main() {
       expect(log.last.method, 'create');
     });
 
+    test('prepareCamera sends the same arguments as create', () async {
+      const description = CameraDescription(
+        name: 'Test Camera (/dev/video0)',
+        lensDirection: CameraLensDirection.external,
+        sensorOrientation: 0,
+      );
+      const settings = MediaSettings(
+        resolutionPreset: ResolutionPreset.high,
+        fps: 30,
+      );
+      await plugin.prepareCamera(description, settings);
+      final prepare = log.last;
+      await plugin.createCameraWithSettings(description, settings);
+      expect(prepare.method, 'prepare');
+      expect(prepare.arguments, log.last.arguments);
+    });
+
     test('initializeCamera fires CameraInitializedEvent', () async {
       // Create first so textureId mapping exists.
       const description = CameraDescription(
@@ -181,6 +254,43 @@ void main() {
       expect(file.path, '/tmp/test_video.mp4');
     });
 
+    test('setDescriptionWhileRecording switches the recording camera',
+        () async {
+      const description = CameraDescription(
+        name: 'Test Camera (/dev/video0)',
+        lensDirection: CameraLensDirection.external,
+        sensorOrientation: 0,
+      );
+      const other = CameraDescription(
+        name: 'Other Camera (/dev/video2)',
+        lensDirection: CameraLensDirection.external,
+        sensorOrientation: 0,
+      );
+      final cameraId = await plugin.createCameraWithSettings(
+        description,
+        const MediaSettings(resolutionPreset: ResolutionPreset.high),
+      );
+      await plugin.initializeCamera(cameraId);
+      expect(
+        () => plugin.setDescriptionWhileRecording(other),
+        throwsA(isA<CameraException>()),
+      );
+
+      await plugin.startVideoRecording(cameraId);
+      await plugin.setDescriptionWhileRecording(other);
+      expect(log.last.method, 'setDescriptionWhileRecording');
+      expect(log.last.arguments, {
+        'cameraId': cameraId,
+        'cameraName': 'Other Camera (/dev/video2)',
+      });
+
+      await plugin.stopVideoRecording(cameraId);
+      expect(
+        () => plugin.setDescriptionWhileRecording(description),
+        throwsA(isA<CameraException>()),
+      );
+    });
+
     test('supportsImageStreaming returns true', () {
       expect(plugin.supportsImageStreaming(), isTrue);
     });
@@ -281,5 +391,194 @@ void main() {
       await Future<void>.delayed(Duration.zero);
       expect(log.last.method, 'stopImageStream');
     });
+
+    test('createMosaic returns texture and composed size', () async {
+      const cameras = [
+        CameraDescription(
+          name: 'Test Camera (/dev/video0)',
+          lensDirection: CameraLensDirection.external,
+          sensorOrientation: 0,
+        ),
+        CameraDescription(
+          name: 'Test Camera (/dev/video2)',
+          lensDirection: CameraLensDirection.external,
+          sensorOrientation: 0,
+        ),
+      ];
+      final mosaic = await plugin.createMosaic(cameras, columns: 2);
+      expect(mosaic.mosaicId, 3);
+      expect(mosaic.textureId, 43);
+      expect(mosaic.width, 640);
+      expect(mosaic.height, 240);
+      final args = log.last.arguments as Map<Object?, Object?>;
+      expect(log.last.method, 'createMosaic');
+      expect(args['cameraNames'], hasLength(2));
+      expect(args['columns'], 2);
+    });
+
+    test('getCameraStats parses counters and histograms', () async {
+      final stats = await plugin.getCameraStats(1);
+      expect(log.last.method, 'getCameraStats');
+      expect(stats.framesCaptured, 120);
+      expect(stats.framesAppsinkDropped, 2);
+      expect(stats.previewFps, 29.5);
+      expect(stats.copyTime.p99Us, 1023);
+      expect(stats.copyTime.log2Buckets, hasLength(10));
+      expect(stats.captureToTextureLatency.count, 0);
+      expect(stats.encoderQueueDepth, isNull);
+      expect(stats.frameMemoryBytes, 3686400);
+      expect(stats.frameMemoryHugePageBytes, 0);
+      expect(stats.frameBufferReuses, 118);
+      expect(stats.framesPreviewDecimated, 0);
+    });
+
+    test('configureIdleBufferRelease sends the timeout', () async {
+      await plugin.configureIdleBufferRelease(
+        idleTimeout: const Duration(seconds: 5),
+      );
+      expect(log.last.method, 'configureIdleBufferRelease');
+      expect(log.last.arguments, {'idleTimeoutMs': 5000});
+
+      await plugin.configureIdleBufferRelease(idleTimeout: null);
+      expect(log.last.arguments, {'idleTimeoutMs': 0});
+    });
+
+    test('setMemoryBudget and getMemoryUsage', () async {
+      await plugin.setMemoryBudget(1, 80000000);
+      expect(log.last.method, 'setMemoryBudget');
+      expect(log.last.arguments, {'cameraId': 1, 'budgetBytes': 80000000});
+
+      final usage = await plugin.getMemoryUsage(1);
+      expect(log.last.method, 'getMemoryUsage');
+      expect(usage.textureBytes, 66355200);
+      expect(usage.recordingQueueLimitBytes, 16777216);
+      expect(usage.budgetBytes, 80000000);
+      expect(usage.degradations, ['recordingQueue', 'doubleBuffer']);
+
+      await plugin.setMemoryBudget(1, null);
+      expect(log.last.arguments, {'cameraId': 1, 'budgetBytes': 0});
+    });
+
+    test('setReconnectPolicy sends the policy and relays progress', () async {
+      const description = CameraDescription(
+        name: 'Test Camera (/dev/video0)',
+        lensDirection: CameraLensDirection.external,
+        sensorOrientation: 0,
+      );
+      final cameraId = await plugin.createCameraWithSettings(
+        description,
+        const MediaSettings(resolutionPreset: ResolutionPreset.high),
+      );
+      await plugin.setReconnectPolicy(
+        cameraId,
+        const ReconnectPolicy(maxDelay: Duration(seconds: 2), maxAttempts: 0),
+      );
+      expect(log.last.method, 'setReconnectPolicy');
+      expect(log.last.arguments, {
+        'cameraId': cameraId,
+        'enabled': true,
+        'initialDelayMs': 100,
+        'maxDelayMs': 2000,
+        'maxAttempts': 0,
+      });
+
+      final events = plugin.onCameraReconnect(cameraId).take(2).toList();
+      for (final args in [
+        {'cameraId': cameraId, 'state': 'lost', 'attempts': 0},
+        {
+          'cameraId': cameraId,
+          'state': 'recovered',
+          'attempts': 3,
+          'downtimeUs': 1450000,
+        },
+      ]) {
+        await TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+            .handlePlatformMessage(
+              channel.name,
+              channel.codec.encodeMethodCall(
+                MethodCall('cameraReconnect', args),
+              ),
+              (_) {},
+            );
+      }
+      final received = await events;
+      expect(received.first.state, CameraReconnectState.lost);
+      expect(received.first.downtime, isNull);
+      expect(received.last.state, CameraReconnectState.recovered);
+      expect(received.last.attempts, 3);
+      expect(received.last.downtime, const Duration(milliseconds: 1450));
+    });
+
+    test('initializeCamera keeps the startup breakdown', () async {
+      expect(plugin.getStartupTimings(1), isNull);
+      await plugin.initializeCamera(1);
+      final startup = plugin.getStartupTimings(1)!;
+      expect(startup.gstInitUs, 41000);
+      expect(startup.stateChangeUs, 95000);
+      expect(startup.textureUploadUs, isNull);
+      expect(startup.sessionReused, isFalse);
+      await plugin.dispose(1);
+      expect(plugin.getStartupTimings(1), isNull);
+    });
+
+    test('setStandby sends the flag and maps errors', () async {
+      await plugin.setStandby(1, true);
+      expect(log.last.method, 'setStandby');
+      expect(log.last.arguments, {'cameraId': 1, 'standby': true});
+
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(channel, (MethodCall call) async {
+            throw PlatformException(
+              code: 'standby_failed',
+              message: 'Cannot enter standby while recording',
+            );
+          });
+      expect(
+        () => plugin.setStandby(1, true),
+        throwsA(isA<CameraException>()),
+      );
+    });
+
+    test('setAdaptiveFrameRate and setAppVisibility send their settings',
+        () async {
+      await plugin.setAdaptiveFrameRate(
+        1,
+        const AdaptiveFrameRate(idleFps: 2, staticDelay: Duration(seconds: 3)),
+      );
+      expect(log.last.method, 'setAdaptiveFrameRate');
+      expect(log.last.arguments, {
+        'cameraId': 1,
+        'enabled': true,
+        'idleFps': 2,
+        'staticThreshold': 2,
+        'staticDelayMs': 3000,
+      });
+
+      await plugin.setAppVisibility(hidden: true);
+      expect(log.last.method, 'setAppVisibility');
+      expect(log.last.arguments, {'hidden': true});
+    });
+
+    test('setStaticFrameSkipping sends the threshold', () async {
+      await plugin.setStaticFrameSkipping(1, threshold: 4);
+      expect(log.last.method, 'setStaticFrameSkipping');
+      expect(log.last.arguments, {
+        'cameraId': 1,
+        'enabled': true,
+        'threshold': 4,
+      });
+    });
+
+    test('configureCameraPool sends the limit and idle timeout', () async {
+      await plugin.configureCameraPool(
+        maxEntries: 2,
+        idleTimeout: const Duration(seconds: 5),
+      );
+      expect(log.last.method, 'configureCameraPool');
+      expect(log.last.arguments, {'maxEntries': 2, 'idleTimeoutMs': 5000});
+
+      await plugin.configureCameraPool();
+      expect(log.last.arguments, {'maxEntries': 0, 'idleTimeoutMs': 30000});
+    });
   });
 }